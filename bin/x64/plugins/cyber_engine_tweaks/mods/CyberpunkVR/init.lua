@@ -7,12 +7,25 @@ local CyberpunkVR = {
         enabled = true,
         ipd = 64.0, -- mm
         worldScale = 1.0,
-        uiDistance = 2.0, -- meters (future use)
+        uiDistance = 2.0, -- meters
+        refreshRate = 0.0, -- Hz (0 = match the game's frame rate)
         decoupledAiming = true,
         aimSmoothing = 0.5, -- 0 = none, 0.95 = max
+        dynamicOutputScale = false,
+        uiLayer = false,
+        uiLayerClear = false,
+        everyFrameSubmit = false,
+        spaceWarp = false,
+        lensMatched = false,
+        lensMatchedAngle = 30.0, -- degrees, inset half-angle
+        depthSubmission = false,
+        depthNear = 0.0, -- meters (0 = not set, no depth is submitted)
+        depthFar = 0.0, -- meters
+        depthReversed = true,
         debugMode = false
     },
     isOverlayOpen = false,
+    inMenu = false,
     initialized = false
 }
 
@@ -38,12 +51,38 @@ function CyberpunkVR:SyncFromNative()
     local worldScale = SafeCall("CyberpunkVR_GetWorldScale")
     local decoupledAiming = SafeCall("CyberpunkVR_GetDecoupledAiming")
     local aimSmoothing = SafeCall("CyberpunkVR_GetAimSmoothing")
+    local uiDistance = SafeCall("CyberpunkVR_GetUIDistance")
+    local refreshRate = SafeCall("CyberpunkVR_GetRefreshRate")
+    local dynamicOutputScale = SafeCall("CyberpunkVR_GetDynamicOutputScale")
+    local uiLayer = SafeCall("CyberpunkVR_GetUILayer")
+    local uiLayerClear = SafeCall("CyberpunkVR_GetUILayerClear")
+    local everyFrameSubmit = SafeCall("CyberpunkVR_GetEveryFrameSubmit")
+    local spaceWarp = SafeCall("CyberpunkVR_GetSpaceWarp")
+    local lensMatched = SafeCall("CyberpunkVR_GetLensMatched")
+    local lensMatchedAngle = SafeCall("CyberpunkVR_GetLensMatchedAngle")
+    local depthSubmission = SafeCall("CyberpunkVR_GetDepthSubmission")
+    local depthNear = SafeCall("CyberpunkVR_GetDepthNear")
+    local depthFar = SafeCall("CyberpunkVR_GetDepthFar")
+    local depthReversed = SafeCall("CyberpunkVR_GetDepthReversed")
 
     if enabled ~= nil then self.settings.enabled = enabled end
     if ipd ~= nil then self.settings.ipd = ipd end
     if worldScale ~= nil then self.settings.worldScale = worldScale end
     if decoupledAiming ~= nil then self.settings.decoupledAiming = decoupledAiming end
     if aimSmoothing ~= nil then self.settings.aimSmoothing = aimSmoothing end
+    if uiDistance ~= nil then self.settings.uiDistance = uiDistance end
+    if refreshRate ~= nil then self.settings.refreshRate = refreshRate end
+    if dynamicOutputScale ~= nil then self.settings.dynamicOutputScale = dynamicOutputScale end
+    if uiLayer ~= nil then self.settings.uiLayer = uiLayer end
+    if uiLayerClear ~= nil then self.settings.uiLayerClear = uiLayerClear end
+    if everyFrameSubmit ~= nil then self.settings.everyFrameSubmit = everyFrameSubmit end
+    if spaceWarp ~= nil then self.settings.spaceWarp = spaceWarp end
+    if lensMatched ~= nil then self.settings.lensMatched = lensMatched end
+    if lensMatchedAngle ~= nil then self.settings.lensMatchedAngle = lensMatchedAngle end
+    if depthSubmission ~= nil then self.settings.depthSubmission = depthSubmission end
+    if depthNear ~= nil then self.settings.depthNear = depthNear end
+    if depthFar ~= nil then self.settings.depthFar = depthFar end
+    if depthReversed ~= nil then self.settings.depthReversed = depthReversed end
 
     self.initialized = true
     print("[CyberpunkVR] Settings synced from native: IPD=" .. self.settings.ipd .. "mm, Scale=" .. self.settings.worldScale .. ", DecoupledAim=" .. tostring(self.settings.decoupledAiming))
@@ -56,6 +95,17 @@ function CyberpunkVR:ApplySettings()
     SafeCall("CyberpunkVR_SetWorldScale", self.settings.worldScale)
     SafeCall("CyberpunkVR_SetDecoupledAiming", self.settings.decoupledAiming)
     SafeCall("CyberpunkVR_SetAimSmoothing", self.settings.aimSmoothing)
+    SafeCall("CyberpunkVR_SetUIDistance", self.settings.uiDistance)
+    SafeCall("CyberpunkVR_SetRefreshRate", self.settings.refreshRate)
+    SafeCall("CyberpunkVR_SetDynamicOutputScale", self.settings.dynamicOutputScale)
+    SafeCall("CyberpunkVR_SetUILayer", self.settings.uiLayer)
+    SafeCall("CyberpunkVR_SetUILayerClear", self.settings.uiLayerClear)
+    SafeCall("CyberpunkVR_SetEveryFrameSubmit", self.settings.everyFrameSubmit)
+    SafeCall("CyberpunkVR_SetSpaceWarp", self.settings.spaceWarp)
+    SafeCall("CyberpunkVR_SetLensMatched", self.settings.lensMatched)
+    SafeCall("CyberpunkVR_SetLensMatchedAngle", self.settings.lensMatchedAngle)
+    SafeCall("CyberpunkVR_SetDepthSubmission", self.settings.depthSubmission)
+    SafeCall("CyberpunkVR_SetDepthRange", self.settings.depthNear, self.settings.depthFar, self.settings.depthReversed)
 
     if self.settings.debugMode then
         print("[CyberpunkVR] Settings applied to native")
@@ -71,6 +121,23 @@ function CyberpunkVR:OnInitialize()
     end)
 end
 
+-- Menus are shown on a world-locked cylinder, the HUD follows the head
+function CyberpunkVR:OnUpdate()
+    if not self.initialized then
+        return
+    end
+
+    local success, inMenu = pcall(function()
+        local handler = Game.GetSystemRequestsHandler()
+        return handler:IsGamePaused() or handler:IsPreGame()
+    end)
+
+    if success and inMenu ~= self.inMenu then
+        self.inMenu = inMenu
+        SafeCall("CyberpunkVR_SetMenuMode", inMenu)
+    end
+end
+
 function CyberpunkVR:OnOverlayOpen()
     self.isOverlayOpen = true
 
@@ -131,12 +198,118 @@ function CyberpunkVR:OnDraw()
             SafeCall("CyberpunkVR_SetWorldScale", 1.0)
         end
 
-        -- UI Settings (placeholders for future implementation)
+        -- Display refresh rate: "Auto" follows the game's frame rate
+        local rateCount = SafeCall("CyberpunkVR_GetRefreshRateCount") or 0
+        if rateCount > 0 then
+            local rates = { 0.0 }
+            local rateNames = { "Auto" }
+            local rateIndex = 0
+            for i = 0, rateCount - 1 do
+                local rate = SafeCall("CyberpunkVR_GetRefreshRateAt", i) or 0.0
+                table.insert(rates, rate)
+                table.insert(rateNames, string.format("%.0f Hz", rate))
+                if math.abs(rate - self.settings.refreshRate) < 0.5 then
+                    rateIndex = i + 1
+                end
+            end
+
+            local newIndex, rateChanged = ImGui.Combo("Refresh Rate", rateIndex, rateNames, #rateNames)
+            if rateChanged then
+                self.settings.refreshRate = rates[newIndex + 1]
+                SafeCall("CyberpunkVR_SetRefreshRate", self.settings.refreshRate)
+            end
+            ImGui.SameLine()
+            local displayRate = SafeCall("CyberpunkVR_GetDisplayRefreshRate") or 0.0
+            ImGui.TextColored(0.5, 0.5, 0.5, 1.0, string.format("(now %.0f Hz)", displayRate))
+        end
+
+        local dynamicOutputScale, dynamicOutputScaleChanged = ImGui.Checkbox("Dynamic Output Scale", self.settings.dynamicOutputScale)
+        if dynamicOutputScaleChanged then
+            self.settings.dynamicOutputScale = dynamicOutputScale
+            SafeCall("CyberpunkVR_SetDynamicOutputScale", dynamicOutputScale)
+        end
+        ImGui.SameLine()
+        ImGui.TextColored(0.5, 0.5, 0.5, 1.0, "(Shrink eye images under GPU load)")
+
+        local everyFrameSubmit, everyFrameSubmitChanged = ImGui.Checkbox("Submit Every Frame", self.settings.everyFrameSubmit)
+        if everyFrameSubmitChanged then
+            self.settings.everyFrameSubmit = everyFrameSubmit
+            SafeCall("CyberpunkVR_SetEveryFrameSubmit", everyFrameSubmit)
+        end
+        ImGui.SameLine()
+        ImGui.TextColored(0.5, 0.5, 0.5, 1.0, "(Needs restart)")
+
+        local spaceWarp, spaceWarpChanged = ImGui.Checkbox("Space Warp", self.settings.spaceWarp)
+        if spaceWarpChanged then
+            self.settings.spaceWarp = spaceWarp
+            SafeCall("CyberpunkVR_SetSpaceWarp", spaceWarp)
+        end
+        ImGui.SameLine()
+        ImGui.TextColored(0.5, 0.5, 0.5, 1.0, "(Needs depth; needs restart)")
+
+        local lensMatched, lensMatchedChanged = ImGui.Checkbox("Lens-Matched Layers", self.settings.lensMatched)
+        if lensMatchedChanged then
+            self.settings.lensMatched = lensMatched
+            SafeCall("CyberpunkVR_SetLensMatched", lensMatched)
+        end
+        ImGui.SameLine()
+        ImGui.TextColored(0.5, 0.5, 0.5, 1.0, "(Needs restart)")
+
+        local lensMatchedAngle, lensMatchedAngleChanged = ImGui.SliderFloat("Full-Detail Inset (deg)", self.settings.lensMatchedAngle, 10.0, 50.0, "%.0f")
+        if lensMatchedAngleChanged then
+            self.settings.lensMatchedAngle = lensMatchedAngle
+            SafeCall("CyberpunkVR_SetLensMatchedAngle", lensMatchedAngle)
+        end
+
+        local depthSubmission, depthSubmissionChanged = ImGui.Checkbox("Submit Depth", self.settings.depthSubmission)
+        if depthSubmissionChanged then
+            self.settings.depthSubmission = depthSubmission
+            SafeCall("CyberpunkVR_SetDepthSubmission", depthSubmission)
+        end
+        ImGui.SameLine()
+        ImGui.TextColored(0.5, 0.5, 0.5, 1.0, "(Needs clip planes; needs restart)")
+
+        -- The camera's clip planes: depth is only submitted once both are set
+        local depthNear, depthNearChanged = ImGui.SliderFloat("Depth Near Plane (m)", self.settings.depthNear, 0.0, 1.0, "%.3f")
+        local depthFar, depthFarChanged = ImGui.SliderFloat("Depth Far Plane (m)", self.settings.depthFar, 0.0, 20000.0, "%.0f")
+        local depthReversed, depthReversedChanged = ImGui.Checkbox("Reversed Depth", self.settings.depthReversed)
+        if depthNearChanged or depthFarChanged or depthReversedChanged then
+            self.settings.depthNear = depthNear
+            self.settings.depthFar = depthFar
+            self.settings.depthReversed = depthReversed
+            SafeCall("CyberpunkVR_SetDepthRange", depthNear, depthFar, depthReversed)
+        end
+
+        -- Settings marked "needs restart" are read when the VR session is created
+        if ImGui.Button("Restart VR") then
+            SafeCall("CyberpunkVR_Restart")
+        end
+
+        -- UI Settings
         ImGui.Separator()
-        ImGui.Text("User Interface (Coming Soon)")
-        ImGui.BeginDisabled()
-        self.settings.uiDistance = ImGui.SliderFloat("UI Distance (m)", self.settings.uiDistance, 0.5, 5.0, "%.1f")
-        ImGui.EndDisabled()
+        ImGui.Text("User Interface")
+
+        local uiDistance, uiDistanceChanged = ImGui.SliderFloat("UI Distance (m)", self.settings.uiDistance, 0.5, 5.0, "%.1f")
+        if uiDistanceChanged then
+            self.settings.uiDistance = uiDistance
+            SafeCall("CyberpunkVR_SetUIDistance", uiDistance)
+        end
+
+        local uiLayer, uiLayerChanged = ImGui.Checkbox("UI Layer", self.settings.uiLayer)
+        if uiLayerChanged then
+            self.settings.uiLayer = uiLayer
+            SafeCall("CyberpunkVR_SetUILayer", uiLayer)
+        end
+        ImGui.SameLine()
+        ImGui.TextColored(0.5, 0.5, 0.5, 1.0, "(HUD and menus as their own layer)")
+
+        local uiLayerClear, uiLayerClearChanged = ImGui.Checkbox("Remove UI From Game Image", self.settings.uiLayerClear)
+        if uiLayerClearChanged then
+            self.settings.uiLayerClear = uiLayerClear
+            SafeCall("CyberpunkVR_SetUILayerClear", uiLayerClear)
+        end
+        ImGui.SameLine()
+        ImGui.TextColored(0.5, 0.5, 0.5, 1.0, "(Also hides it on the monitor)")
 
         -- Input Settings
         ImGui.Separator()
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Eye image resample stage
+// Maps the relevant region of the game's back buffer into an eye swapchain image
+// in one pass: aspect-correct crop, bilinear resample and format conversion.
+// The HLSL kernel and the CPU reference below implement the same math, so the
+// reference can be used to verify the GPU output on any platform; it is itself
+// checked against hand-computed values in tests/EyeResampleTest.cpp.
+namespace EyeResample
+{
+    // Flags consumed by the kernel
+    namespace Flags
+    {
+        constexpr uint32_t None = 0;
+        constexpr uint32_t EncodeSrgb = 1 << 0;  // Source is linear (e.g. FP16 scRGB), encode to sRGB
+    }
+
+    // Root constants layout (8 x 32-bit values, register b0)
+    struct Params
+    {
+        float srcOffsetU = 0.0f;    // Top-left of the crop region (normalized UV)
+        float srcOffsetV = 0.0f;
+        float srcScaleU = 1.0f;     // Size of the crop region (normalized UV)
+        float srcScaleV = 1.0f;
+        uint32_t dstWidth = 0;
+        uint32_t dstHeight = 0;
+        uint32_t flags = Flags::None;
+        uint32_t dispatchOffset = 0;   // First texel of this dispatch, x | y << 16 (see PackDispatchOffset)
+    };
+    static_assert(sizeof(Params) == 8 * sizeof(uint32_t), "Params must match the root constant count");
+
+    constexpr uint32_t ROOT_CONSTANT_COUNT = sizeof(Params) / sizeof(uint32_t);
+    constexpr uint32_t THREAD_GROUP_SIZE = 8;
+
+    // Crop the centre of the source so it has the destination's aspect ratio
+    inline Params ComputeParams(uint32_t srcWidth, uint32_t srcHeight,
+                                uint32_t dstWidth, uint32_t dstHeight,
+                                uint32_t flags = Flags::None)
+    {
+        Params params;
+        params.dstWidth = dstWidth;
+        params.dstHeight = dstHeight;
+        params.flags = flags;
+
+        if (srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0)
+        {
+            return params;
+        }
+
+        float srcAspect = static_cast<float>(srcWidth) / static_cast<float>(srcHeight);
+        float dstAspect = static_cast<float>(dstWidth) / static_cast<float>(dstHeight);
+
+        if (srcAspect > dstAspect)
+        {
+            // Source is wider: crop left and right
+            params.srcScaleU = dstAspect / srcAspect;
+            params.srcOffsetU = (1.0f - params.srcScaleU) * 0.5f;
+        }
+        else if (srcAspect < dstAspect)
+        {
+            // Source is taller: crop top and bottom
+            params.srcScaleV = srcAspect / dstAspect;
+            params.srcOffsetV = (1.0f - params.srcScaleV) * 0.5f;
+        }
+
+        return params;
+    }
+
+    inline uint32_t GetDispatchCount(uint32_t size)
+    {
+        return (size + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE;
+    }
+
+    // Lets one recorded pass cover only part of the image (e.g. the lens-visible
+    // rectangles) with several dispatches; the mapping of a texel does not change
+    inline uint32_t PackDispatchOffset(uint32_t x, uint32_t y)
+    {
+        return (x & 0xFFFFu) | (y << 16);
+    }
+
+    // sRGB OETF, identical to LinearToSrgb() in the HLSL below
+    inline float LinearToSrgb(float value)
+    {
+        value = std::clamp(value, 0.0f, 1.0f);
+        if (value <= 0.0031308f)
+            return value * 12.92f;
+        return 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    // CPU reference for one output pixel
+    // src is RGBA float, row-major, srcWidth * srcHeight texels
+    // Matches SampleLevel() with a linear/clamp sampler; GPUs filter with reduced
+    // fractional precision, so compare against it with a small tolerance (~1/255)
+    inline void ReferencePixel(const float* src, uint32_t srcWidth, uint32_t srcHeight,
+                               const Params& params, uint32_t x, uint32_t y, float outRGBA[4])
+    {
+        float u = params.srcOffsetU + (static_cast<float>(x) + 0.5f) / static_cast<float>(params.dstWidth) * params.srcScaleU;
+        float v = params.srcOffsetV + (static_cast<float>(y) + 0.5f) / static_cast<float>(params.dstHeight) * params.srcScaleV;
+
+        // Texel space, texel centres at integer + 0.5
+        float tx = u * static_cast<float>(srcWidth) - 0.5f;
+        float ty = v * static_cast<float>(srcHeight) - 0.5f;
+
+        float fx = std::floor(tx);
+        float fy = std::floor(ty);
+        float wx = tx - fx;
+        float wy = ty - fy;
+
+        auto clampX = [&](float value) { return static_cast<uint32_t>(std::clamp(value, 0.0f, static_cast<float>(srcWidth - 1))); };
+        auto clampY = [&](float value) { return static_cast<uint32_t>(std::clamp(value, 0.0f, static_cast<float>(srcHeight - 1))); };
+
+        uint32_t x0 = clampX(fx), x1 = clampX(fx + 1.0f);
+        uint32_t y0 = clampY(fy), y1 = clampY(fy + 1.0f);
+
+        for (int c = 0; c < 4; c++)
+        {
+            float c00 = src[(y0 * srcWidth + x0) * 4 + c];
+            float c10 = src[(y0 * srcWidth + x1) * 4 + c];
+            float c01 = src[(y1 * srcWidth + x0) * 4 + c];
+            float c11 = src[(y1 * srcWidth + x1) * 4 + c];
+
+            float top = c00 + (c10 - c00) * wx;
+            float bottom = c01 + (c11 - c01) * wx;
+            outRGBA[c] = top + (bottom - top) * wy;
+        }
+
+        if (params.flags & Flags::EncodeSrgb)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                outRGBA[c] = LinearToSrgb(outRGBA[c]);
+            }
+        }
+    }
+
+    // CPU reference for the whole kernel
+    // dst is RGBA float, row-major, params.dstWidth * params.dstHeight texels
+    inline void Reference(const float* src, uint32_t srcWidth, uint32_t srcHeight,
+                          const Params& params, float* dst)
+    {
+        for (uint32_t y = 0; y < params.dstHeight; y++)
+        {
+            for (uint32_t x = 0; x < params.dstWidth; x++)
+            {
+                ReferencePixel(src, srcWidth, srcHeight, params, x, y, &dst[(y * params.dstWidth + x) * 4]);
+            }
+        }
+    }
+
+    // Compute shader (cs_5_0), compiled once at startup
+    constexpr const char* SHADER_SOURCE = R"(
+Texture2D<float4> g_source : register(t0);
+RWTexture2DArray<float4> g_dest : register(u0);  // Single-slice view of the eye image
+SamplerState g_linearClamp : register(s0);
+
+cbuffer Params : register(b0)
+{
+    float2 g_srcOffset;
+    float2 g_srcScale;
+    uint2 g_dstSize;
+    uint g_flags;
+    uint g_dispatchOffset;
+};
+
+float3 LinearToSrgb(float3 value)
+{
+    value = saturate(value);
+    float3 low = value * 12.92;
+    float3 high = 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+    return (value <= 0.0031308) ? low : high;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 dispatchId : SV_DispatchThreadID)
+{
+    uint2 id = dispatchId.xy + uint2(g_dispatchOffset & 0xFFFF, g_dispatchOffset >> 16);
+    if (id.x >= g_dstSize.x || id.y >= g_dstSize.y)
+        return;
+
+    float2 uv = g_srcOffset + (float2(id.xy) + 0.5) / float2(g_dstSize) * g_srcScale;
+    float4 color = g_source.SampleLevel(g_linearClamp, uv, 0);
+
+    if (g_flags & 1)
+        color.rgb = LinearToSrgb(color.rgb);
+
+    g_dest[uint3(id.xy, 0)] = color;
+}
+)";
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ThreadSafe.hpp"
+
+#include <d3d12.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// GPU time of spans of work on one command queue
+// Begin queues a timestamp ahead of the span's work, End one behind it plus a
+// signal on the timer's own fence. The result is queue-span time: idle gaps and
+// waits on other queues inside the span are counted too, so it is how long the
+// queue took, not how long the GPU was busy. Span n uses slot n % SLOTS and
+// signals n + 1; a slot is only written again once it has been read back.
+// Every method may be called from any thread. Begin and End run queue
+// submissions of their own, so IsOpen is checked before anything else: a hook
+// that sees the timer's own submission finds the span already open.
+class GpuTimer
+{
+public:
+    static constexpr uint32_t SLOTS = 8;
+
+    // Returns false if the timer cannot be used
+    bool Create(ID3D12Device* device);
+    void Destroy();
+
+    // The queue the spans run on; drains the previous one first
+    void SetQueue(ID3D12CommandQueue* queue, uint32_t timeoutMs);
+    bool IsTimed(ID3D12CommandQueue* queue) const { return queue && queue == m_queueRaw.load(); }
+    bool IsOpen() const { return m_open.load(); }
+
+    // No-ops while a span is open / closed, without a queue, or while every slot awaits its read
+    void Begin();
+    void End();
+
+    // Average span time of the spans finished since the last call
+    // Returns false if none finished
+    bool Read(double& averageSeconds);
+
+    // Waits until nothing of the timer's is left on the queue; an open span is closed
+    // Returns false on timeout
+    bool Drain(uint32_t timeoutMs);
+
+private:
+    struct SlotLists {
+        ComPtr<ID3D12GraphicsCommandList> start;
+        ComPtr<ID3D12GraphicsCommandList> end;     // Also resolves the slot
+    };
+
+    bool DrainLocked(uint32_t timeoutMs);
+
+    std::mutex m_mutex;
+    ComPtr<ID3D12QueryHeap> m_heap;                 // [start, end] per slot
+    ComPtr<ID3D12Resource> m_readback;
+    ComPtr<ID3D12Fence> m_fence;                    // Signalled by m_queue only
+    ComPtr<ID3D12CommandAllocator> m_allocator;
+    SlotLists m_lists[SLOTS];
+    ComPtr<ID3D12CommandQueue> m_queue;
+    std::atomic<ID3D12CommandQueue*> m_queueRaw{nullptr};  // Checked without the lock
+    UINT64 m_frequency = 0;
+    std::atomic<bool> m_open{false};                // A start is queued, its end is not
+    UINT64 m_spans = 0;                             // Spans ended so far
+    UINT64 m_read = 0;                              // Spans read back so far
+};
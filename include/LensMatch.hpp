@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "EyeResample.hpp"
+#include "VisibilityMask.hpp"
+
+// Lens-matched two-band eye images
+// A rectilinear eye image spends sec^2(angle) times more pixels per degree at
+// angle off the optical axis than at its centre, and the lens squeezes the
+// periphery further. Instead of one uniform image, each eye is submitted as
+//   - a full-FOV projection layer at reduced density, and
+//   - a full-density inset projection layer around the optical axis on top.
+// Both are plain OpenXR projection layers, so any runtime composes them; core
+// OpenXR has no way to submit one image with a custom distortion mapping, and
+// expanding a packed image back to full size would cost more than it saves.
+// The outer density is derived from the inset angle so that, at the inset edge,
+// the outer band still has the angular resolution of the image centre.
+namespace LensMatch
+{
+    using FovTangents = VisibilityMask::FovTangents;
+
+    constexpr float DEFAULT_INSET_HALF_ANGLE_DEGREES = 30.0f;
+
+    // Inset angles outside this range either save nothing or cover nothing
+    constexpr float MIN_INSET_HALF_ANGLE_DEGREES = 10.0f;
+    constexpr float MAX_INSET_HALF_ANGLE_DEGREES = 50.0f;
+
+    inline float DegreesToRadians(float degrees) { return degrees * 3.14159265f / 180.0f; }
+
+    // Per-axis scale of the outer band relative to the recommended size:
+    // cos^2(inset angle) keeps its angular density at or above the centre's
+    // everywhere outside the inset; factor (<= 1) trades detail for bandwidth
+    inline float PeripheryScale(float insetHalfAngleRadians, float factor = 1.0f)
+    {
+        float c = std::cos(insetHalfAngleRadians);
+        return std::clamp(c * c * factor, 0.1f, 1.0f);
+    }
+
+    // Inset FOV: every side of the eye FOV limited to the inset angle
+    inline FovTangents ComputeInset(const FovTangents& fov, float insetHalfAngleRadians)
+    {
+        float t = std::tan(insetHalfAngleRadians);
+
+        FovTangents inset;
+        inset.left = std::max(fov.left, -t);
+        inset.right = std::min(fov.right, t);
+        inset.up = std::min(fov.up, t);
+        inset.down = std::max(fov.down, -t);
+        return inset;
+    }
+
+    // Inset region inside the eye image, normalized (v down)
+    struct UvRect
+    {
+        float u0 = 0.0f;
+        float v0 = 0.0f;
+        float u1 = 1.0f;
+        float v1 = 1.0f;
+    };
+
+    inline UvRect InsetUv(const FovTangents& fov, const FovTangents& inset)
+    {
+        UvRect uv;
+        uv.u0 = (inset.left - fov.left) / (fov.right - fov.left);
+        uv.u1 = (inset.right - fov.left) / (fov.right - fov.left);
+        uv.v0 = (fov.up - inset.up) / (fov.up - fov.down);
+        uv.v1 = (fov.up - inset.down) / (fov.up - fov.down);
+        return uv;
+    }
+
+    // Inset image size at the full recommended density, kept even
+    inline void InsetSize(uint32_t recommendedWidth, uint32_t recommendedHeight, const UvRect& uv,
+                          uint32_t& outWidth, uint32_t& outHeight)
+    {
+        outWidth = std::max(static_cast<uint32_t>(std::lround(recommendedWidth * (uv.u1 - uv.u0))) & ~1u, 2u);
+        outHeight = std::max(static_cast<uint32_t>(std::lround(recommendedHeight * (uv.v1 - uv.v0))) & ~1u, 2u);
+    }
+
+    // Resample parameters for the inset: the same source crop as the eye image,
+    // narrowed to the inset region
+    inline EyeResample::Params InsetParams(const EyeResample::Params& eye, const UvRect& uv,
+                                           uint32_t insetWidth, uint32_t insetHeight)
+    {
+        EyeResample::Params params = eye;
+        params.srcOffsetU = eye.srcOffsetU + uv.u0 * eye.srcScaleU;
+        params.srcOffsetV = eye.srcOffsetV + uv.v0 * eye.srcScaleV;
+        params.srcScaleU = (uv.u1 - uv.u0) * eye.srcScaleU;
+        params.srcScaleV = (uv.v1 - uv.v0) * eye.srcScaleV;
+        params.dstWidth = insetWidth;
+        params.dstHeight = insetHeight;
+        params.dispatchOffset = 0;
+        return params;
+    }
+
+    // Pixels written per eye relative to one uniform image at the recommended size
+    inline float PixelFraction(float peripheryScale, const UvRect& uv)
+    {
+        return peripheryScale * peripheryScale + (uv.u1 - uv.u0) * (uv.v1 - uv.v0);
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Motion vector conversion stage for application space warp
+// The game's TAA motion vectors are a texture-space (UV) offset per pixel;
+// XR_FB_space_warp wants the NDC-space motion from the previous frame to the
+// current one (current minus previous). The conversion is a per-axis scale
+// (UV -> NDC flips Y and doubles the range) plus a length clamp that drops the
+// huge vectors TAA writes on camera cuts. The HLSL kernel and the CPU reference
+// below implement the same math; tests/MotionVectorsTest.cpp checks the
+// reference against hand-computed motion.
+namespace MotionVectors
+{
+    // Direction of the game's vectors in texture space
+    enum class Convention : uint32_t
+    {
+        ToPrevious,     // previousUV - currentUV (usual TAA layout)
+        ToCurrent,      // currentUV - previousUV
+    };
+
+    // Root constants layout (8 x 32-bit values, register b0)
+    struct Params
+    {
+        float scaleX = 0.0f;        // Game vector -> NDC motion, per axis
+        float scaleY = 0.0f;
+        float maxLength = 0.0f;     // Longer NDC motion is treated as invalid (0 = no limit)
+        uint32_t padding0 = 0;
+        uint32_t dstWidth = 0;
+        uint32_t dstHeight = 0;
+        uint32_t padding1 = 0;
+        uint32_t padding2 = 0;
+    };
+    static_assert(sizeof(Params) == 8 * sizeof(uint32_t), "Params must match the root constant count");
+
+    constexpr uint32_t ROOT_CONSTANT_COUNT = sizeof(Params) / sizeof(uint32_t);
+    constexpr uint32_t THREAD_GROUP_SIZE = 8;
+
+    // Motion longer than this (in NDC, where the view spans 2) is a cut, not motion
+    constexpr float DEFAULT_MAX_LENGTH = 1.0f;
+
+    inline Params ComputeParams(Convention convention, uint32_t dstWidth, uint32_t dstHeight,
+                                float maxLength = DEFAULT_MAX_LENGTH)
+    {
+        // NDC.x = 2u - 1, NDC.y = 1 - 2v, so a UV delta maps to (2du, -2dv)
+        float sign = (convention == Convention::ToCurrent) ? 1.0f : -1.0f;
+
+        Params params;
+        params.scaleX = 2.0f * sign;
+        params.scaleY = -2.0f * sign;
+        params.maxLength = maxLength;
+        params.dstWidth = dstWidth;
+        params.dstHeight = dstHeight;
+        return params;
+    }
+
+    inline uint32_t GetDispatchCount(uint32_t size)
+    {
+        return (size + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE;
+    }
+
+    // Nearest source texel for a destination texel; identical to the kernel.
+    // Motion is not filtered: blending across an object edge invents motion
+    inline uint32_t SourceTexel(uint32_t dst, uint32_t dstSize, uint32_t srcSize)
+    {
+        uint32_t texel = static_cast<uint32_t>((static_cast<float>(dst) + 0.5f) * static_cast<float>(srcSize) /
+                                               static_cast<float>(dstSize));
+        return std::min(texel, srcSize - 1);
+    }
+
+    // CPU reference for one output pixel
+    // src is RG float, row-major, srcWidth * srcHeight texels; out is RGBA
+    inline void ReferencePixel(const float* src, uint32_t srcWidth, uint32_t srcHeight,
+                               const Params& params, uint32_t x, uint32_t y, float outRGBA[4])
+    {
+        uint32_t sx = SourceTexel(x, params.dstWidth, srcWidth);
+        uint32_t sy = SourceTexel(y, params.dstHeight, srcHeight);
+        const float* texel = &src[(sy * srcWidth + sx) * 2];
+
+        float mx = texel[0] * params.scaleX;
+        float my = texel[1] * params.scaleY;
+
+        if (params.maxLength > 0.0f && mx * mx + my * my > params.maxLength * params.maxLength)
+        {
+            mx = 0.0f;
+            my = 0.0f;
+        }
+
+        // Depth motion is not known; the runtime treats z = 0 as no depth change
+        outRGBA[0] = mx;
+        outRGBA[1] = my;
+        outRGBA[2] = 0.0f;
+        outRGBA[3] = 0.0f;
+    }
+
+    // CPU reference for the whole kernel
+    // dst is RGBA float, row-major, params.dstWidth * params.dstHeight texels
+    inline void Reference(const float* src, uint32_t srcWidth, uint32_t srcHeight,
+                          const Params& params, float* dst)
+    {
+        for (uint32_t y = 0; y < params.dstHeight; y++)
+        {
+            for (uint32_t x = 0; x < params.dstWidth; x++)
+            {
+                ReferencePixel(src, srcWidth, srcHeight, params, x, y, &dst[(y * params.dstWidth + x) * 4]);
+            }
+        }
+    }
+
+    // Compute shader (cs_5_0), compiled once at startup
+    constexpr const char* SHADER_SOURCE = R"(
+Texture2D<float2> g_source : register(t0);
+RWTexture2DArray<float4> g_dest : register(u0);  // Single-slice view of the motion image
+
+cbuffer Params : register(b0)
+{
+    float2 g_scale;
+    float g_maxLength;
+    uint g_padding0;
+    uint2 g_dstSize;
+    uint2 g_padding1;
+};
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= g_dstSize.x || id.y >= g_dstSize.y)
+        return;
+
+    uint2 srcSize;
+    g_source.GetDimensions(srcSize.x, srcSize.y);
+    uint2 texel = min(uint2((float2(id.xy) + 0.5) * float2(srcSize) / float2(g_dstSize)), srcSize - 1);
+
+    float2 motion = g_source.Load(int3(texel, 0)) * g_scale;
+    if (g_maxLength > 0.0 && dot(motion, motion) > g_maxLength * g_maxLength)
+        motion = 0.0;
+
+    g_dest[uint3(id.xy, 0)] = float4(motion, 0.0, 0.0);
+}
+)";
+}
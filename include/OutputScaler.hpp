@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Dynamic scale of the submitted eye images
+// Only the region the game's frame is copied / resampled into and handed to the
+// compositor changes size: the game keeps rendering at its own resolution, so
+// this trades the resample and compositor work, not the game's. Fed one cost
+// sample per submitted frame pair - the GPU time of the plugin's own eye
+// copies / resamples, which the scale does change - together with the budget
+// that work may take. Smooths the cost, then steps a per-axis scale factor down
+// when the budget is at risk and up when there is spare headroom, never above
+// the recommended size or the source's resolution. Steps are quantized and
+// followed by a cooldown so the eye images (and the cached submission work
+// recorded against their size) do not change every frame.
+class OutputScaler
+{
+public:
+    struct Settings
+    {
+        float minScale = 0.6f;              // Per-axis scale relative to the recommended size
+        float maxScale = 1.0f;              // Above 1 the images outgrow the recommended size
+        float step = 0.05f;                 // Quantization of every change
+        float decreaseThreshold = 0.92f;    // Step down above this fraction of the budget
+        float increaseThreshold = 0.75f;    // Step up below this fraction of the budget
+        float smoothing = 0.1f;             // Weight of a new sample in the moving average
+        uint32_t cooldownFrames = 30;       // Frame pairs to hold after a change
+    };
+
+    void Configure(const Settings& settings)
+    {
+        m_settings = settings;
+        m_settings.maxScale = std::clamp(m_settings.maxScale, m_settings.minScale, 1.0f);
+        m_ceiling = 0.0f;
+        m_sourceLimit = 0.0f;
+        Reset(std::clamp(1.0f, m_settings.minScale, m_settings.maxScale));
+    }
+
+    void Reset(float scale)
+    {
+        m_scale = scale;
+        m_averageCost = 0.0;
+        m_cooldown = m_settings.cooldownFrames;
+    }
+
+    // Returns true when the scale changed
+    bool Update(double frameCostSeconds, double budgetSeconds)
+    {
+        if (frameCostSeconds <= 0.0 || budgetSeconds <= 0.0)
+        {
+            return false;
+        }
+
+        m_averageCost = (m_averageCost <= 0.0)
+            ? frameCostSeconds
+            : m_averageCost + (frameCostSeconds - m_averageCost) * m_settings.smoothing;
+
+        if (m_cooldown > 0)
+        {
+            m_cooldown--;
+            return false;
+        }
+
+        double load = m_averageCost / budgetSeconds;
+        float target = m_scale;
+
+        if (load > m_settings.decreaseThreshold)
+        {
+            // Pixel cost scales with the square of the per-axis scale
+            target = m_scale * static_cast<float>(std::sqrt(m_settings.decreaseThreshold / load));
+            target = std::min(target, m_scale - m_settings.step);
+        }
+        else if (load < m_settings.increaseThreshold)
+        {
+            // Grow one step at a time; overshooting costs a dropped frame
+            target = m_scale + m_settings.step;
+        }
+
+        target = Quantize(std::clamp(target, m_settings.minScale, GetMaxScale()));
+        if (std::fabs(target - m_scale) < m_settings.step * 0.5f)
+        {
+            return false;
+        }
+
+        m_scale = target;
+        m_cooldown = m_settings.cooldownFrames;
+        return true;
+    }
+
+    // Upper bound imposed from outside (e.g. runtime performance warnings);
+    // 0 lifts it. Returns true when the current scale had to drop
+    bool SetCeiling(float ceiling)
+    {
+        m_ceiling = ceiling;
+        return ApplyMaxScale();
+    }
+
+    // Source resolution relative to the recommended size: sampling above it
+    // adds pixels and no detail. 0 lifts it. Returns true when the current
+    // scale had to drop
+    bool SetSourceLimit(float sourceLimit)
+    {
+        m_sourceLimit = sourceLimit;
+        return ApplyMaxScale();
+    }
+
+    float GetMaxScale() const
+    {
+        float maxScale = m_settings.maxScale;
+        if (m_ceiling > 0.0f)
+        {
+            maxScale = std::min(maxScale, m_ceiling);
+        }
+        if (m_sourceLimit > 0.0f)
+        {
+            maxScale = std::min(maxScale, m_sourceLimit);
+        }
+        return std::max(maxScale, m_settings.minScale);
+    }
+
+    float GetScale() const { return m_scale; }
+    double GetAverageCost() const { return m_averageCost; }
+
+    // Scaled size of one axis, kept even and within [1, allocated]
+    static uint32_t ScaleExtent(uint32_t recommended, float scale, uint32_t allocated)
+    {
+        uint32_t size = static_cast<uint32_t>(std::lround(static_cast<double>(recommended) * scale));
+        size &= ~1u;
+        return std::clamp<uint32_t>(size, 1u, std::max(allocated, 1u));
+    }
+
+private:
+    bool ApplyMaxScale()
+    {
+        float limit = GetMaxScale();
+        if (m_scale <= limit)
+        {
+            return false;
+        }
+
+        // Round down so the limit is actually respected
+        float target = (m_settings.step > 0.0f)
+            ? std::floor(limit / m_settings.step + 1e-3f) * m_settings.step
+            : limit;
+        m_scale = std::max(target, m_settings.minScale);
+        m_cooldown = m_settings.cooldownFrames;
+        return true;
+    }
+
+    float Quantize(float scale) const
+    {
+        if (m_settings.step <= 0.0f)
+        {
+            return scale;
+        }
+        float steps = std::round(scale / m_settings.step);
+        return std::clamp(steps * m_settings.step, m_settings.minScale, GetMaxScale());
+    }
+
+    Settings m_settings;
+    float m_scale = 1.0f;
+    float m_ceiling = 0.0f;
+    float m_sourceLimit = 0.0f;
+    double m_averageCost = 0.0;
+    uint32_t m_cooldown = 0;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+// Performance level hints for the OpenXR runtime (XR_EXT_performance_settings)
+// One controller per domain (CPU, GPU). Fed the domain's load once per frame
+// pair as a fraction of the frame budget, it asks for a higher level after the
+// load has stayed high for a while and for a lower one only after it has stayed
+// low for much longer, with a cooldown after every change, so clocks do not
+// flap. Runtime warnings cap the level: boosting a throttled device only makes
+// it throttle harder.
+namespace PerfLevels
+{
+    // Same values as XrPerfSettingsLevelEXT
+    enum class Level : uint32_t
+    {
+        PowerSavings = 0,
+        SustainedLow = 25,
+        SustainedHigh = 50,
+        Boost = 75,
+    };
+
+    // Same values as XrPerfSettingsNotificationLevelEXT
+    enum class Notification : uint32_t
+    {
+        Normal = 0,
+        Warning = 25,
+        Impaired = 75,
+    };
+
+    inline const char* ToString(Level level)
+    {
+        switch (level)
+        {
+        case Level::PowerSavings: return "power savings";
+        case Level::SustainedLow: return "sustained low";
+        case Level::SustainedHigh: return "sustained high";
+        case Level::Boost: return "boost";
+        }
+        return "unknown";
+    }
+
+    class Controller
+    {
+    public:
+        struct Settings
+        {
+            float raiseThreshold = 0.9f;    // Load (fraction of budget) that asks for more
+            float lowerThreshold = 0.6f;    // Load that allows less
+            uint32_t raiseFrames = 15;      // Frame pairs above raiseThreshold before stepping up
+            uint32_t lowerFrames = 300;     // Frame pairs below lowerThreshold before stepping down
+            uint32_t cooldownFrames = 90;   // Frame pairs to hold after a change
+            Level minLevel = Level::SustainedLow;
+            Level maxLevel = Level::Boost;
+        };
+
+        void Configure(const Settings& settings, Level initial = Level::SustainedHigh)
+        {
+            m_settings = settings;
+            m_level = std::clamp(initial, m_settings.minLevel, m_settings.maxLevel);
+            m_notification = Notification::Normal;
+            m_highCount = 0;
+            m_lowCount = 0;
+            m_cooldown = m_settings.cooldownFrames;
+        }
+
+        // Returns true when the requested level changed
+        bool Update(double load)
+        {
+            if (load <= 0.0)
+            {
+                return false;
+            }
+
+            m_highCount = (load > m_settings.raiseThreshold) ? m_highCount + 1 : 0;
+            m_lowCount = (load < m_settings.lowerThreshold) ? m_lowCount + 1 : 0;
+
+            if (m_cooldown > 0)
+            {
+                m_cooldown--;
+                return false;
+            }
+
+            Level target = m_level;
+            if (m_highCount >= m_settings.raiseFrames)
+            {
+                target = Step(m_level, 1);
+            }
+            else if (m_lowCount >= m_settings.lowerFrames)
+            {
+                target = Step(m_level, -1);
+            }
+
+            target = std::min(target, GetCeiling());
+            return target != m_level && SetLevel(target);
+        }
+
+        // Runtime notification for this domain (worst of its sub-domains)
+        // Returns true when the requested level had to drop
+        bool Notify(Notification notification)
+        {
+            m_notification = notification;
+            return m_level > GetCeiling() && SetLevel(GetCeiling());
+        }
+
+        Level GetLevel() const { return m_level; }
+        Notification GetNotification() const { return m_notification; }
+
+    private:
+        Level GetCeiling() const
+        {
+            switch (m_notification)
+            {
+            case Notification::Impaired: return std::max(m_settings.minLevel, Level::SustainedLow);
+            case Notification::Warning: return std::min(m_settings.maxLevel, Level::SustainedHigh);
+            default: return m_settings.maxLevel;
+            }
+        }
+
+        Level Step(Level level, int direction) const
+        {
+            static constexpr Level ORDER[] = { Level::PowerSavings, Level::SustainedLow, Level::SustainedHigh, Level::Boost };
+            int index = 0;
+            while (index < 3 && ORDER[index] != level)
+            {
+                index++;
+            }
+            index = std::clamp(index + direction, 0, 3);
+            return std::clamp(ORDER[index], m_settings.minLevel, m_settings.maxLevel);
+        }
+
+        bool SetLevel(Level level)
+        {
+            m_level = level;
+            m_highCount = 0;
+            m_lowCount = 0;
+            m_cooldown = m_settings.cooldownFrames;
+            return true;
+        }
+
+        Settings m_settings;
+        Level m_level = Level::SustainedHigh;
+        Notification m_notification = Notification::Normal;
+        uint32_t m_highCount = 0;
+        uint32_t m_lowCount = 0;
+        uint32_t m_cooldown = 0;
+    };
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Display refresh rate selection (XR_FB_display_refresh_rate)
+// The compositor shows every submitted frame for a whole number of refreshes
+// at best: a frame rate that does not divide the refresh rate leaves some
+// frames on screen longer than others (judder), and every refresh without a
+// new frame is a reprojected one. Fed the present interval, the selector
+// smooths the game's frame rate and picks the supported refresh rate with the
+// lowest combined cost. A new rate has to win for a few seconds before it is
+// requested, and switches are spaced out: each one blanks or flickers the
+// display on most headsets.
+namespace RefreshRate
+{
+    // An uneven cadence is far more visible than reprojection itself
+    constexpr float JUDDER_WEIGHT = 1.0f;
+    constexpr float REPROJECTION_WEIGHT = 0.25f;
+
+    // Cost of showing contentRate frames per second at refreshRate
+    inline float Score(float contentRate, float refreshRate)
+    {
+        if (contentRate <= 0.0f || refreshRate <= 0.0f)
+        {
+            return 0.0f;
+        }
+
+        // Refreshes per content frame; below 1 the game outruns the display and
+        // the cadence is set by the dropped frames instead
+        float ratio = refreshRate / contentRate;
+        float cadence = (ratio >= 1.0f) ? ratio : 1.0f / ratio;
+        float judder = std::fabs(cadence - std::round(cadence));
+        float reprojected = std::max(1.0f - contentRate / refreshRate, 0.0f);
+        return JUDDER_WEIGHT * judder + REPROJECTION_WEIGHT * reprojected;
+    }
+
+    class Selector
+    {
+    public:
+        struct Settings
+        {
+            float smoothing = 0.02f;            // Weight of a new interval in the moving average
+            double startupSeconds = 10.0;       // Let the frame rate settle before the first switch
+            double holdSeconds = 3.0;           // A better rate must win this long
+            double minSwitchSeconds = 30.0;     // Between two requests
+            float minImprovement = 0.05f;       // Score margin over the current rate
+            double maxIntervalSeconds = 0.5;    // Longer gaps are loading hitches, not frame rate
+        };
+
+        void Configure(const Settings& settings, const std::vector<float>& rates)
+        {
+            m_settings = settings;
+            m_rates = rates;
+            m_averageInterval = 0.0;
+            m_elapsed = 0.0;
+            m_sinceSwitch = settings.minSwitchSeconds;
+            m_candidate = 0.0f;
+            m_candidateTime = 0.0;
+        }
+
+        // Called every present; presentsPerFrame is how many presents make one
+        // submitted OpenXR frame (2 with alternate eyes ending a frame per pair)
+        // Returns the rate to request, or 0 to keep the current one
+        float Update(double presentIntervalSeconds, uint32_t presentsPerFrame, float currentRate)
+        {
+            if (presentIntervalSeconds <= 0.0 || presentIntervalSeconds > m_settings.maxIntervalSeconds)
+            {
+                m_candidateTime = 0.0;
+                return 0.0f;
+            }
+
+            m_averageInterval = (m_averageInterval <= 0.0)
+                ? presentIntervalSeconds
+                : m_averageInterval + (presentIntervalSeconds - m_averageInterval) * m_settings.smoothing;
+            m_elapsed += presentIntervalSeconds;
+            m_sinceSwitch += presentIntervalSeconds;
+
+            if (m_rates.empty() || currentRate <= 0.0f || m_elapsed < m_settings.startupSeconds)
+            {
+                return 0.0f;
+            }
+
+            float contentRate = GetContentRate(presentsPerFrame);
+            float best = SelectBest(contentRate);
+            if (best == currentRate ||
+                Score(contentRate, currentRate) - Score(contentRate, best) < m_settings.minImprovement)
+            {
+                m_candidate = 0.0f;
+                m_candidateTime = 0.0;
+                return 0.0f;
+            }
+
+            if (best != m_candidate)
+            {
+                m_candidate = best;
+                m_candidateTime = 0.0;
+            }
+            m_candidateTime += presentIntervalSeconds;
+
+            if (m_candidateTime < m_settings.holdSeconds || m_sinceSwitch < m_settings.minSwitchSeconds)
+            {
+                return 0.0f;
+            }
+
+            m_sinceSwitch = 0.0;
+            m_candidate = 0.0f;
+            m_candidateTime = 0.0;
+            return best;
+        }
+
+        float SelectBest(float contentRate) const
+        {
+            float best = 0.0f;
+            float bestScore = 0.0f;
+            for (float rate : m_rates)
+            {
+                // Ties go to the higher rate: lower persistence, fresher reprojection
+                float score = Score(contentRate, rate);
+                if (best == 0.0f || score < bestScore - 1e-4f || (score <= bestScore + 1e-4f && rate > best))
+                {
+                    best = rate;
+                    bestScore = score;
+                }
+            }
+            return best;
+        }
+
+        float GetContentRate(uint32_t presentsPerFrame) const
+        {
+            if (m_averageInterval <= 0.0)
+            {
+                return 0.0f;
+            }
+            return static_cast<float>(1.0 / (m_averageInterval * std::max(presentsPerFrame, 1u)));
+        }
+
+    private:
+        Settings m_settings;
+        std::vector<float> m_rates;
+        double m_averageInterval = 0.0;
+        double m_elapsed = 0.0;
+        double m_sinceSwitch = 0.0;
+        float m_candidate = 0.0f;
+        double m_candidateTime = 0.0;
+    };
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Resource state tracking for recorded command lists
+// Each tracked (resource, subresource) pair has a home state: the state it is in
+// when the list starts executing and must be back in when the list ends, which
+// is what lets a list be recorded once and replayed every frame. The tracker
+// turns state requests into the minimal set of transitions:
+//   - a request for the current state emits nothing,
+//   - a resource whose home is COMMON (PRESENT) is promoted implicitly on first
+//     use to a copy or shader-read state, and read-only promotions decay back to
+//     COMMON when the list completes, so neither side needs a barrier,
+//   - BeginTransition emits the BEGIN_ONLY half of a split barrier; the END_ONLY
+//     half follows when the state is needed, letting the GPU run the transition
+//     alongside the work recorded in between.
+// Barriers are only collected here; Flush hands them to the caller, which
+// records them on the real command list in one batch.
+namespace ResourceStates
+{
+    // Same values as D3D12_RESOURCE_STATES
+    namespace State
+    {
+        constexpr uint32_t Common = 0;
+        constexpr uint32_t Present = 0;
+        constexpr uint32_t RenderTarget = 0x4;
+        constexpr uint32_t UnorderedAccess = 0x8;
+        constexpr uint32_t DepthWrite = 0x10;
+        constexpr uint32_t NonPixelShaderResource = 0x40;
+        constexpr uint32_t PixelShaderResource = 0x80;
+        constexpr uint32_t CopyDest = 0x400;
+        constexpr uint32_t CopySource = 0x800;
+    }
+
+    // Same value as D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES
+    constexpr uint32_t ALL_SUBRESOURCES = 0xffffffff;
+
+    // Same meaning as D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY / END_ONLY
+    enum class Split : uint8_t
+    {
+        None,
+        Begin,
+        End,
+    };
+
+    struct Barrier
+    {
+        const void* resource = nullptr;
+        uint32_t subresource = ALL_SUBRESOURCES;
+        uint32_t before = State::Common;
+        uint32_t after = State::Common;
+        Split split = Split::None;
+    };
+
+    // States a non-simultaneous-access texture can be implicitly promoted to
+    // from COMMON on a direct queue
+    inline bool IsPromotable(uint32_t state)
+    {
+        constexpr uint32_t PROMOTABLE = State::NonPixelShaderResource | State::PixelShaderResource |
+                                        State::CopyDest | State::CopySource;
+        return state != State::Common && (state & ~PROMOTABLE) == 0;
+    }
+
+    // Promotions to these decay back to COMMON when the list completes
+    inline bool IsReadOnly(uint32_t state)
+    {
+        constexpr uint32_t READ_ONLY = State::NonPixelShaderResource | State::PixelShaderResource | State::CopySource;
+        return state != State::Common && (state & ~READ_ONLY) == 0;
+    }
+
+    class Tracker
+    {
+    public:
+        // promotable: the resource is a buffer or texture that may use implicit
+        // promotion, i.e. anything except a simultaneous-access texture that is
+        // also written on another queue
+        void Track(const void* resource, uint32_t subresource, uint32_t homeState, bool promotable = false)
+        {
+            Entry entry;
+            entry.resource = resource;
+            entry.subresource = subresource;
+            entry.home = homeState;
+            entry.current = homeState;
+            entry.promotable = promotable && homeState == State::Common;
+            m_entries.push_back(entry);
+        }
+
+        // Returns false for an untracked resource
+        bool Transition(const void* resource, uint32_t subresource, uint32_t state)
+        {
+            Entry* entry = Find(resource, subresource);
+            if (!entry)
+            {
+                return false;
+            }
+
+            EndSplit(*entry);
+            Request(*entry, state);
+            return true;
+        }
+
+        // Start moving a resource to a state it is needed in later
+        bool BeginTransition(const void* resource, uint32_t subresource, uint32_t state)
+        {
+            Entry* entry = Find(resource, subresource);
+            if (!entry)
+            {
+                return false;
+            }
+
+            EndSplit(*entry);
+            if (entry->current == state || CanPromote(*entry, state))
+            {
+                Request(*entry, state);
+                return true;
+            }
+
+            Push(*entry, entry->current, state, Split::Begin);
+            entry->splitTarget = state;
+            entry->splitOpen = true;
+            return true;
+        }
+
+        // Start moving a resource back home once the list is done with it
+        bool BeginRestore(const void* resource, uint32_t subresource)
+        {
+            Entry* entry = Find(resource, subresource);
+            if (!entry)
+            {
+                return false;
+            }
+
+            // A split still in flight has to land first; it may also end the promotion
+            EndSplit(*entry);
+            if (Decays(*entry))
+            {
+                return true;
+            }
+            return BeginTransition(resource, subresource, entry->home);
+        }
+
+        // Every tracked resource back in its home state; call before closing the list
+        void Restore()
+        {
+            for (Entry& entry : m_entries)
+            {
+                EndSplit(entry);
+                if (Decays(entry))
+                {
+                    m_skipped++;
+                }
+                else if (entry.current != entry.home)
+                {
+                    Push(entry, entry.current, entry.home, Split::None);
+                }
+                entry.current = entry.home;
+                entry.promoted = false;
+            }
+        }
+
+        // emit(const Barrier* barriers, size_t count), only called when there is something to record
+        template<typename Emit>
+        void Flush(Emit&& emit)
+        {
+            if (m_barriers.empty())
+            {
+                return;
+            }
+
+            emit(m_barriers.data(), m_barriers.size());
+            m_emitted += static_cast<uint32_t>(m_barriers.size());
+            m_barriers.clear();
+        }
+
+        uint32_t GetState(const void* resource, uint32_t subresource) const
+        {
+            for (const Entry& entry : m_entries)
+            {
+                if (entry.resource == resource && entry.subresource == subresource)
+                {
+                    return entry.current;
+                }
+            }
+            return State::Common;
+        }
+
+        // Barriers handed out by Flush, and transitions that needed no barrier
+        uint32_t GetEmittedCount() const { return m_emitted; }
+        uint32_t GetSkippedCount() const { return m_skipped; }
+
+    private:
+        struct Entry
+        {
+            const void* resource = nullptr;
+            uint32_t subresource = ALL_SUBRESOURCES;
+            uint32_t home = State::Common;
+            uint32_t current = State::Common;
+            uint32_t splitTarget = State::Common;
+            bool splitOpen = false;
+            bool promotable = false;
+            bool promoted = false;      // Current state was reached implicitly
+        };
+
+        Entry* Find(const void* resource, uint32_t subresource)
+        {
+            for (Entry& entry : m_entries)
+            {
+                if (entry.resource == resource && entry.subresource == subresource)
+                {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        // From COMMON, or from one implicitly promoted read state to more of them
+        bool CanPromote(const Entry& entry, uint32_t state) const
+        {
+            if (!entry.promotable || !IsPromotable(state))
+            {
+                return false;
+            }
+            return entry.current == State::Common ||
+                   (entry.promoted && IsReadOnly(entry.current) && IsReadOnly(state));
+        }
+
+        bool Decays(const Entry& entry) const
+        {
+            return entry.promoted && IsReadOnly(entry.current) && entry.home == State::Common;
+        }
+
+        void Request(Entry& entry, uint32_t state)
+        {
+            if (entry.current == state)
+            {
+                m_skipped++;
+                return;
+            }
+
+            if (CanPromote(entry, state))
+            {
+                entry.current = entry.promoted ? (entry.current | state) : state;
+                entry.promoted = true;
+                m_skipped++;
+                return;
+            }
+
+            Push(entry, entry.current, state, Split::None);
+            entry.current = state;
+            entry.promoted = false;
+        }
+
+        void EndSplit(Entry& entry)
+        {
+            if (!entry.splitOpen)
+            {
+                return;
+            }
+
+            Push(entry, entry.current, entry.splitTarget, Split::End);
+            entry.current = entry.splitTarget;
+            entry.promoted = false;
+            entry.splitOpen = false;
+        }
+
+        void Push(const Entry& entry, uint32_t before, uint32_t after, Split split)
+        {
+            Barrier barrier;
+            barrier.resource = entry.resource;
+            barrier.subresource = entry.subresource;
+            barrier.before = before;
+            barrier.after = after;
+            barrier.split = split;
+            m_barriers.push_back(barrier);
+        }
+
+        std::vector<Entry> m_entries;
+        std::vector<Barrier> m_barriers;
+        uint32_t m_emitted = 0;
+        uint32_t m_skipped = 0;
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <mutex>
 #include <wrl/client.h>  // For Microsoft::WRL::ComPtr
 
@@ -20,6 +22,144 @@ namespace ThreadSafe
     // Recursive mutex for nested locks
     using RecursiveMutex = std::recursive_mutex;
     using RecursiveLock = std::lock_guard<std::recursive_mutex>;
+
+    // Lock-free latest-value slot (triple buffer)
+    // One writer publishes, one reader picks up the most recent value; neither
+    // side ever waits for the other, and the reader never sees a torn value.
+    template<typename T>
+    class LatestValue
+    {
+    public:
+        // Writer thread only
+        void Publish(const T& value)
+        {
+            m_buffers[m_writeIndex] = value;
+            uint32_t previous = m_shared.exchange(m_writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+            m_writeIndex = previous & INDEX_MASK;
+        }
+
+        // Reader thread only
+        // Returns false until the first value has been published
+        bool Read(T& outValue)
+        {
+            if (m_shared.load(std::memory_order_relaxed) & FRESH_BIT)
+            {
+                uint32_t previous = m_shared.exchange(m_readIndex, std::memory_order_acq_rel);
+                m_readIndex = previous & INDEX_MASK;
+                m_hasValue = true;
+            }
+
+            if (!m_hasValue)
+            {
+                return false;
+            }
+
+            outValue = m_buffers[m_readIndex];
+            return true;
+        }
+
+    private:
+        static constexpr uint32_t INDEX_MASK = 0x3;
+        static constexpr uint32_t FRESH_BIT = 0x4;
+
+        T m_buffers[3] = {};
+        std::atomic<uint32_t> m_shared{1};   // Buffer in the middle, plus "fresh" flag
+        uint32_t m_writeIndex = 0;
+        uint32_t m_readIndex = 2;
+        bool m_hasValue = false;
+    };
+
+    // Fixed-size history keyed by frame index (frame % N)
+    // One writer, any number of readers. Each entry is guarded by a sequence tag,
+    // so a reader either gets the value written for exactly that frame or fails;
+    // nothing is allocated after construction.
+    template<typename T, size_t N>
+    class FrameHistory
+    {
+    public:
+        void Write(uint64_t frameIndex, const T& value)
+        {
+            Entry& entry = m_entries[frameIndex % N];
+            entry.tag.store(INVALID_TAG, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            entry.value = value;
+            entry.tag.store(frameIndex, std::memory_order_release);
+        }
+
+        bool Read(uint64_t frameIndex, T& outValue) const
+        {
+            const Entry& entry = m_entries[frameIndex % N];
+            if (entry.tag.load(std::memory_order_acquire) != frameIndex)
+            {
+                return false;
+            }
+
+            outValue = entry.value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // Overwritten while copying
+            return entry.tag.load(std::memory_order_relaxed) == frameIndex;
+        }
+
+    private:
+        static constexpr uint64_t INVALID_TAG = ~0ull;
+
+        struct Entry
+        {
+            std::atomic<uint64_t> tag{INVALID_TAG};
+            T value = {};
+        };
+
+        Entry m_entries[N];
+    };
+
+    // Fixed-size single-producer single-consumer ring
+    // The producer fills a slot in place and publishes it; the consumer reads it
+    // in place and frees it. Slots never move, so an entry may point into
+    // itself. Neither side ever waits: a full ring refuses the push.
+    template<typename T, size_t N>
+    class SpscQueue
+    {
+    public:
+        // Producer thread only: slot to fill, or nullptr when the ring is full
+        T* BeginPush()
+        {
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            if (head - m_tail.load(std::memory_order_acquire) >= N)
+            {
+                return nullptr;
+            }
+            return &m_slots[head % N];
+        }
+
+        // Producer thread only: publish the slot returned by BeginPush
+        void CommitPush()
+        {
+            m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // Consumer thread only: oldest entry, or nullptr when empty
+        T* Front()
+        {
+            uint64_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_head.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            return &m_slots[tail % N];
+        }
+
+        // Consumer thread only: free the entry returned by Front
+        void Pop()
+        {
+            m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+    private:
+        T m_slots[N] = {};
+        alignas(64) std::atomic<uint64_t> m_head{0};   // Next slot to publish
+        alignas(64) std::atomic<uint64_t> m_tail{0};   // Next slot to consume
+    };
 }
 
 // COM smart pointer alias
@@ -47,6 +187,87 @@ namespace VRConfig
     // GPU wait timeout in milliseconds (0 = infinite)
     inline std::atomic<DWORD> g_gpuWaitTimeout{5000};
 
+    // Render both eyes into one arraySize = 2 swapchain (read at session creation)
+    inline std::atomic<bool> g_singleSwapchain{true};
+
+    // End an OpenXR frame on every game frame instead of every eye pair
+    // (needs one swapchain per eye, so enable it before the session is created)
+    inline std::atomic<bool> g_everyFrameSubmit{false};
+
+    // Set from CET: rebuild the OpenXR instance and session so settings read
+    // at their creation take effect; taken by the frame pacing thread
+    inline std::atomic<bool> g_restartRequest{false};
+
+    // Submit the game's depth buffer with XR_KHR_composition_layer_depth
+    // (read at instance creation). Off by default: wrong clip planes make the
+    // runtime reproject at the wrong distances
+    inline std::atomic<bool> g_depthSubmission{false};
+
+    // Camera clip planes in meters, set from CET; with reversed-Z the far plane
+    // maps to depth 0. Depth is not submitted until both are set (see IsDepthRangeSet)
+    inline std::atomic<float> g_depthNear{0.0f};
+    inline std::atomic<float> g_depthFar{0.0f};
+    inline std::atomic<bool> g_depthReversed{true};
+
+    // Presents between a camera update and the Present of that frame
+    // (0 = the frame being simulated is the next one presented)
+    inline std::atomic<uint32_t> g_renderLatency{0};
+
+    // Dynamic scale of the submitted eye images (per axis, relative to the
+    // recommended size, at most 1); the game's render resolution is not touched.
+    // The budget is the share of the display period the plugin's eye copies /
+    // resamples of a frame pair may take on the GPU
+    inline std::atomic<bool> g_dynamicOutputScale{false};
+    inline std::atomic<float> g_minOutputScale{0.6f};
+    inline std::atomic<float> g_maxOutputScale{1.0f};
+    inline std::atomic<float> g_outputScaleBudget{0.1f};
+
+    // Feed the game's motion vectors and depth to XR_FB_space_warp
+    // (read at instance creation; needs depth submission). Off by default: with
+    // alternate eyes the game's vectors also carry the parallax between eyes
+    inline std::atomic<bool> g_spaceWarp{false};
+
+    // Game motion vectors point from the current to the previous position
+    // (the usual TAA layout); clear if space warp extrapolates backwards
+    inline std::atomic<bool> g_motionVectorsToPrevious{true};
+
+    // Submit the game's UI target as its own layer (quad for the HUD, cylinder for menus).
+    // Off by default: the target is guessed from the game's clears. The UI is
+    // only taken out of the game's frame (and so out of the eye images and the
+    // mirror) when clearing the game's target is allowed too
+    inline std::atomic<bool> g_uiLayer{false};
+    inline std::atomic<bool> g_uiLayerClear{false};
+    inline std::atomic<float> g_uiDistance{2.0f};           // Meters from the head
+    inline std::atomic<float> g_uiUpdateRate{30.0f};        // Max content checks per second
+    inline std::atomic<bool> g_menuMode{false};             // A menu is open (set from CET)
+
+    // Skip the eye image regions hidden by the lenses (XR_KHR_visibility_mask,
+    // read at instance creation)
+    inline std::atomic<bool> g_visibilityMask{true};
+
+    // Submit each eye as a reduced-density full-FOV layer plus a full-density
+    // inset around the optical axis (read at session creation)
+    inline std::atomic<bool> g_lensMatched{false};
+    inline std::atomic<float> g_lensMatchedAngle{30.0f};            // Inset half-angle in degrees
+    inline std::atomic<float> g_lensMatchedPeripheryFactor{0.7f};   // Below 1 trades outer detail for bandwidth
+
+    // Tell the runtime whether CPU or GPU limits the frame (XR_EXT_performance_settings,
+    // read at instance creation)
+    inline std::atomic<bool> g_perfHints{true};
+
+    // Run plain eye copies on a COPY queue instead of the DIRECT queue (read at
+    // session creation)
+    inline std::atomic<bool> g_copyQueue{true};
+
+    // Match the headset refresh rate to the game frame rate (XR_FB_display_refresh_rate,
+    // read at instance creation)
+    constexpr uint32_t MAX_REFRESH_RATES = 8;
+    inline std::atomic<bool> g_refreshRateSelection{true};
+    inline std::atomic<float> g_refreshRateRequest{0.0f};       // Fixed rate in Hz (0 = automatic)
+    inline std::atomic<float> g_displayRefreshRate{0.0f};       // Current rate (written by the VR system)
+    inline std::atomic<float> g_refreshRates[MAX_REFRESH_RATES] = {};
+    inline std::atomic<uint32_t> g_refreshRateCount{0};
+
     // Setters (thread-safe)
     inline void SetIPD(float ipdMeters) { g_ipd.store(ipdMeters); }
     inline void SetWorldScale(float scale) { g_worldScale.store(scale); }
@@ -54,6 +275,49 @@ namespace VRConfig
     inline void SetDecoupledAiming(bool enabled) { g_decoupledAiming.store(enabled); }
     inline void SetAimSmoothing(float factor) { g_aimSmoothing.store(factor); }
     inline void SetGPUWaitTimeout(DWORD ms) { g_gpuWaitTimeout.store(ms); }
+    inline void SetSingleSwapchain(bool enabled) { g_singleSwapchain.store(enabled); }
+    inline void SetEveryFrameSubmit(bool enabled) { g_everyFrameSubmit.store(enabled); }
+    inline void RequestRestart() { g_restartRequest.store(true); }
+    inline void SetRenderLatency(uint32_t frames) { g_renderLatency.store(frames); }
+    inline void SetDepthSubmission(bool enabled) { g_depthSubmission.store(enabled); }
+    inline void SetDepthRange(float nearZ, float farZ, bool reversed)
+    {
+        g_depthNear.store(nearZ);
+        g_depthFar.store(farZ);
+        g_depthReversed.store(reversed);
+    }
+    inline void SetDynamicOutputScale(bool enabled) { g_dynamicOutputScale.store(enabled); }
+    inline void SetOutputScaleRange(float minScale, float maxScale)
+    {
+        g_minOutputScale.store(minScale);
+        g_maxOutputScale.store(maxScale);
+    }
+    inline void SetOutputScaleBudget(float share) { g_outputScaleBudget.store(share); }
+    inline void SetSpaceWarp(bool enabled) { g_spaceWarp.store(enabled); }
+    inline void SetMotionVectorsToPrevious(bool toPrevious) { g_motionVectorsToPrevious.store(toPrevious); }
+    inline void SetUILayer(bool enabled) { g_uiLayer.store(enabled); }
+    inline void SetUILayerClear(bool enabled) { g_uiLayerClear.store(enabled); }
+    inline void SetUIDistance(float meters) { g_uiDistance.store(meters); }
+    inline void SetUIUpdateRate(float hz) { g_uiUpdateRate.store(hz); }
+    inline void SetMenuMode(bool inMenu) { g_menuMode.store(inMenu); }
+    inline void SetVisibilityMask(bool enabled) { g_visibilityMask.store(enabled); }
+    inline void SetLensMatched(bool enabled) { g_lensMatched.store(enabled); }
+    inline void SetLensMatchedAngle(float degrees) { g_lensMatchedAngle.store(degrees); }
+    inline void SetLensMatchedPeripheryFactor(float factor) { g_lensMatchedPeripheryFactor.store(factor); }
+    inline void SetPerfHints(bool enabled) { g_perfHints.store(enabled); }
+    inline void SetCopyQueue(bool enabled) { g_copyQueue.store(enabled); }
+    inline void SetRefreshRateSelection(bool enabled) { g_refreshRateSelection.store(enabled); }
+    inline void SetRefreshRateRequest(float hz) { g_refreshRateRequest.store(hz); }
+    inline void SetDisplayRefreshRate(float hz) { g_displayRefreshRate.store(hz); }
+    inline void SetRefreshRates(const float* rates, uint32_t count)
+    {
+        count = (count < MAX_REFRESH_RATES) ? count : MAX_REFRESH_RATES;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            g_refreshRates[i].store(rates[i]);
+        }
+        g_refreshRateCount.store(count);
+    }
 
     // Getters (thread-safe)
     inline float GetIPD() { return g_ipd.load(); }
@@ -62,4 +326,42 @@ namespace VRConfig
     inline bool IsDecoupledAiming() { return g_decoupledAiming.load(); }
     inline float GetAimSmoothing() { return g_aimSmoothing.load(); }
     inline DWORD GetGPUWaitTimeout() { return g_gpuWaitTimeout.load(); }
+    inline bool IsSingleSwapchain() { return g_singleSwapchain.load(); }
+    inline bool IsEveryFrameSubmit() { return g_everyFrameSubmit.load(); }
+    inline bool TakeRestartRequest() { return g_restartRequest.exchange(false); }
+    inline uint32_t GetRenderLatency() { return g_renderLatency.load(); }
+    inline bool IsDepthSubmission() { return g_depthSubmission.load(); }
+    inline float GetDepthNear() { return g_depthNear.load(); }
+    inline float GetDepthFar() { return g_depthFar.load(); }
+    inline bool IsDepthReversed() { return g_depthReversed.load(); }
+    inline bool IsDepthRangeSet()
+    {
+        float nearZ = g_depthNear.load();
+        return nearZ > 0.0f && g_depthFar.load() > nearZ;
+    }
+    inline bool IsDynamicOutputScale() { return g_dynamicOutputScale.load(); }
+    inline float GetMinOutputScale() { return g_minOutputScale.load(); }
+    inline float GetMaxOutputScale() { return g_maxOutputScale.load(); }
+    inline float GetOutputScaleBudget() { return g_outputScaleBudget.load(); }
+    inline bool IsSpaceWarp() { return g_spaceWarp.load(); }
+    inline bool AreMotionVectorsToPrevious() { return g_motionVectorsToPrevious.load(); }
+    inline bool IsUILayer() { return g_uiLayer.load(); }
+    inline bool IsUILayerClear() { return g_uiLayerClear.load(); }
+    inline float GetUIDistance() { return g_uiDistance.load(); }
+    inline float GetUIUpdateRate() { return g_uiUpdateRate.load(); }
+    inline bool IsMenuMode() { return g_menuMode.load(); }
+    inline bool IsVisibilityMask() { return g_visibilityMask.load(); }
+    inline bool IsLensMatched() { return g_lensMatched.load(); }
+    inline float GetLensMatchedAngle() { return g_lensMatchedAngle.load(); }
+    inline float GetLensMatchedPeripheryFactor() { return g_lensMatchedPeripheryFactor.load(); }
+    inline bool IsPerfHints() { return g_perfHints.load(); }
+    inline bool IsCopyQueue() { return g_copyQueue.load(); }
+    inline bool IsRefreshRateSelection() { return g_refreshRateSelection.load(); }
+    inline float GetRefreshRateRequest() { return g_refreshRateRequest.load(); }
+    inline float GetDisplayRefreshRate() { return g_displayRefreshRate.load(); }
+    inline uint32_t GetRefreshRateCount() { return g_refreshRateCount.load(); }
+    inline float GetRefreshRate(uint32_t index)
+    {
+        return (index < g_refreshRateCount.load()) ? g_refreshRates[index].load() : 0.0f;
+    }
 }
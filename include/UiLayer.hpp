@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// HUD / menu layer helpers
+// The game's UI target is submitted as its own quad (HUD, head-locked) or
+// cylinder (menus, world-locked) layer, and taken out of the game's frame so
+// it is not baked into the eye images as well. The layer image is sized for text at the headset's pixel
+// density and only refreshed when the UI content changes: a content hash is
+// computed on the GPU and compared with the one of the last submitted image.
+namespace UiLayer
+{
+    // Angular size of the layer, horizontally
+    constexpr float HUD_ANGLE_DEGREES = 50.0f;
+    constexpr float MENU_ANGLE_DEGREES = 90.0f;
+
+    // Layer image width bounds; no point exceeding the source detail
+    constexpr uint32_t MIN_WIDTH = 256;
+    constexpr uint32_t MAX_WIDTH = 4096;
+
+    constexpr float DegreesToRadians(float degrees) { return degrees * 3.14159265f / 180.0f; }
+
+    // Width (in texels) that matches the display density across angleRadians,
+    // limited to the source width and kept even
+    inline uint32_t ComputeLayerWidth(float pixelsPerRadian, float angleRadians, uint32_t sourceWidth)
+    {
+        float ideal = pixelsPerRadian * angleRadians;
+        uint32_t width = static_cast<uint32_t>(std::lround(std::max(ideal, 0.0f)));
+        width = std::min({ width, sourceWidth, MAX_WIDTH });
+        width = std::max(width, std::min(MIN_WIDTH, sourceWidth));
+        return std::max(width & ~1u, 2u);
+    }
+
+    inline uint32_t ComputeLayerHeight(uint32_t width, uint32_t sourceWidth, uint32_t sourceHeight)
+    {
+        if (sourceWidth == 0)
+        {
+            return width;
+        }
+        uint64_t height = (static_cast<uint64_t>(width) * sourceHeight + sourceWidth / 2) / sourceWidth;
+        return std::max(static_cast<uint32_t>(height) & ~1u, 2u);
+    }
+
+    // Width in meters of a flat quad spanning angleRadians at distance
+    inline float QuadWidth(float distance, float angleRadians)
+    {
+        return 2.0f * distance * std::tan(angleRadians * 0.5f);
+    }
+
+    // Rotation about +Y (OpenXR up) that faces the same heading as q, so a
+    // world-locked menu stays upright whatever the head pitch and roll were
+    inline void YawOnly(float qx, float qy, float qz, float qw, float outQuat[4])
+    {
+        // Forward is -Z; only its horizontal part matters
+        float forwardX = -2.0f * (qx * qz + qw * qy);
+        float forwardZ = -(1.0f - 2.0f * (qx * qx + qy * qy));
+        float yaw = std::atan2(-forwardX, -forwardZ);
+
+        outQuat[0] = 0.0f;
+        outQuat[1] = std::sin(yaw * 0.5f);
+        outQuat[2] = 0.0f;
+        outQuat[3] = std::cos(yaw * 0.5f);
+    }
+
+    // Hash kernel root constants (8 x 32-bit values, register b0)
+    struct HashParams
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t padding[6] = {};
+    };
+    static_assert(sizeof(HashParams) == 8 * sizeof(uint32_t), "HashParams must match the root constant count");
+
+    constexpr uint32_t ROOT_CONSTANT_COUNT = sizeof(HashParams) / sizeof(uint32_t);
+    constexpr uint32_t THREAD_GROUP_SIZE = 8;
+
+    inline uint32_t GetDispatchCount(uint32_t size)
+    {
+        return (size + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE;
+    }
+
+    // Murmur3 finalizer, identical to Mix() in the HLSL below
+    inline uint32_t Mix(uint32_t h)
+    {
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    inline uint32_t PackTexel(const float rgba[4])
+    {
+        uint32_t packed = 0;
+        for (int c = 0; c < 4; c++)
+        {
+            uint32_t value = static_cast<uint32_t>(std::clamp(rgba[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+            packed |= value << (8 * c);
+        }
+        return packed;
+    }
+
+    // The hash is a wrapping sum and an xor of per-texel hashes, so the GPU can
+    // combine texels in any order. The kernel accumulates into a counter that is
+    // never cleared: the hash of one pass is the difference between two reads
+    inline void TexelHash(uint32_t packed, uint32_t x, uint32_t y, uint32_t width, uint32_t& sum, uint32_t& bits)
+    {
+        uint32_t h = Mix(packed ^ Mix(y * width + x + 0x9E3779B9u));
+        sum = h;
+        bits = Mix(h + 0x85EBCA6Bu);
+    }
+
+    // CPU reference for the whole kernel
+    // src is RGBA float, row-major, width * height texels
+    inline void HashReference(const float* src, uint32_t width, uint32_t height, uint32_t outHash[2])
+    {
+        outHash[0] = 0;
+        outHash[1] = 0;
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                uint32_t sum, bits;
+                TexelHash(PackTexel(&src[(y * width + x) * 4]), x, y, width, sum, bits);
+                outHash[0] += sum;
+                outHash[1] ^= bits;
+            }
+        }
+    }
+
+    // Content hash of one pass, from two reads of the accumulating counter
+    inline void HashDelta(const uint32_t before[2], const uint32_t after[2], uint32_t outHash[2])
+    {
+        outHash[0] = after[0] - before[0];
+        outHash[1] = after[1] ^ before[1];
+    }
+
+    // Compute shader (cs_5_0), compiled once at startup
+    // Accumulates into texels (0,0) and (1,0) of an R32_UINT counter texture
+    constexpr const char* HASH_SHADER_SOURCE = R"(
+Texture2D<float4> g_source : register(t0);
+RWTexture2DArray<uint> g_hash : register(u0);
+
+cbuffer Params : register(b0)
+{
+    uint2 g_size;
+    uint2 g_padding0;
+    uint4 g_padding1;
+};
+
+groupshared uint g_sum[64];
+groupshared uint g_bits[64];
+
+uint Mix(uint h)
+{
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+    return h;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 id : SV_DispatchThreadID, uint index : SV_GroupIndex)
+{
+    uint sum = 0;
+    uint bits = 0;
+    if (id.x < g_size.x && id.y < g_size.y)
+    {
+        uint4 c = uint4(saturate(g_source.Load(int3(id.xy, 0))) * 255.0 + 0.5);
+        uint packed = c.r | (c.g << 8) | (c.b << 16) | (c.a << 24);
+        uint h = Mix(packed ^ Mix(id.y * g_size.x + id.x + 0x9E3779B9));
+        sum = h;
+        bits = Mix(h + 0x85EBCA6B);
+    }
+
+    g_sum[index] = sum;
+    g_bits[index] = bits;
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint stride = 32; stride > 0; stride >>= 1)
+    {
+        if (index < stride)
+        {
+            g_sum[index] += g_sum[index + stride];
+            g_bits[index] ^= g_bits[index + stride];
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (index == 0)
+    {
+        InterlockedAdd(g_hash[uint3(0, 0, 0)], g_sum[0]);
+        InterlockedXor(g_hash[uint3(1, 0, 0)], g_bits[0]);
+    }
+}
+)";
+}
@@ -4,6 +4,7 @@
 
 // Forward declarations only! No includes of D3D12 or OpenXR here.
 struct ID3D12CommandQueue;
+struct ID3D12GraphicsCommandList;
 struct ID3D12Resource;
 
 // Hand pose for motion controller aiming
@@ -25,6 +26,39 @@ struct VRHandPose
     bool valid = false;
 };
 
+// Head pose sampled once per game frame
+// Every camera update within one game frame sees the same snapshot
+struct VRFramePose
+{
+    // Present index of the frame being simulated (present count at sampling
+    // plus VRConfig::GetRenderLatency()); also decides its eye
+    uint64_t frameIndex = 0;
+    bool isLeftEye = true;
+
+    // Position (game coordinate space, meters)
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+
+    // Orientation (quaternion)
+    float qx = 0.0f, qy = 0.0f, qz = 0.0f, qw = 1.0f;
+
+    bool valid = false;
+};
+
+// Lens visibility mask of one eye (XR_KHR_visibility_mask)
+// Triangles covering the part of the eye image visible through the lens, as
+// xy pairs on the z = -1 plane of the eye's view: apply the eye's projection
+// to get NDC. Pointers are only valid during the callback
+struct VRVisibilityMask
+{
+    uint32_t eyeIndex = 0;
+    const float* vertices = nullptr;    // vertexCount xy pairs
+    uint32_t vertexCount = 0;
+    const uint32_t* indices = nullptr;  // indexCount / 3 triangles
+    uint32_t indexCount = 0;
+};
+
+using VRVisibilityMaskCallback = void (*)(const VRVisibilityMask& mask, void* userData);
+
 // VR Controller state (matches XInput gamepad layout for easy mapping)
 struct VRControllerState
 {
@@ -77,15 +111,70 @@ public:
     ~VRSystem();
 
     // Initialize OpenXR Loader and connect to headset
-    bool Initialize(ID3D12CommandQueue* gameCommandQueue);
-
-    // Per-frame update: Get head pose
-    // Returns true if head pose is valid
-    bool Update(float& outX, float& outY, float& outZ, float& outQX, float& outQY, float& outQZ, float& outQW);
+    // backBufferFormat: DXGI_FORMAT of the game's back buffers (0 if not known yet),
+    // used to pick a swapchain format the back buffer can be copied into directly
+    bool Initialize(ID3D12CommandQueue* gameCommandQueue, uint32_t backBufferFormat = 0);
+
+    // Initialize on a worker thread and return at once, so neither plugin load
+    // (instance, nullptr queue) nor the game's Present (session, swapchains)
+    // waits for the runtime. A call made while an earlier one is still running
+    // joins it on the new worker first; poll IsReady()
+    void InitializeAsync(ID3D12CommandQueue* gameCommandQueue, uint32_t backBufferFormat = 0);
+
+    // True once the session and swapchains exist and frames can be submitted
+    bool IsReady() const;
+
+    // Get the head pose for the current game frame
+    // The first call in a game frame samples the latest views published by the
+    // frame pacing thread; later calls in the same frame return the same snapshot.
+    // Never blocks; call it from a single thread (the game's camera update)
+    // Returns true if the pose is valid
+    bool GetFramePose(VRFramePose& outPose);
+
+    // Submit the game's UI target for the HUD / menu layer; call before SubmitFrame
+    // uiTarget: the UI render target, or nullptr to hide the layer
+    // The layer shows what CaptureUi took out of this frame. The content is
+    // checked at most VRConfig::GetUIUpdateRate() times per second and the
+    // layer image is only rewritten when it changed
+    void SubmitUI(ID3D12Resource* uiTarget);
+
+    // Capture the UI for the layer, and take it out of the game's frame when
+    // VRConfig::IsUILayerClear allows it, so it is only seen in the layer
+    // Call on the game's command list right after the barrier that moves the
+    // UI target from RENDER_TARGET to the shader-read state uiState (a
+    // D3D12_RESOURCE_STATES): records a copy of the target, clears it if
+    // allowed, then hands it back in uiState. Any recording thread; returns false and records
+    // nothing while the layer cannot show the UI
+    bool CaptureUi(ID3D12GraphicsCommandList* commandList, ID3D12Resource* uiTarget, uint32_t uiState);
+
+    // The queue the game's swapchain presents on, from the swapchain creation
+    // hooks (any thread). Its submissions are the ones timed for OnQueueSubmit,
+    // and the UI capture is ordered with the UI layer's reads on it
+    void SetPresentQueue(ID3D12CommandQueue* queue);
+
+    // Game command queue submission, from the ExecuteCommandLists hook before
+    // the lists are queued (any thread). The first one on the present queue
+    // after a Present starts the frame's GPU time, which drives the GPU
+    // performance level
+    void OnQueueSubmit(ID3D12CommandQueue* queue);
 
     // Submit frame to headset (AER)
-    // isLeftEye: true for frame N, false for frame N+1
-    void SubmitFrame(ID3D12Resource* gameTexture, bool isLeftEye);
+    // backBufferIndex: index of gameTexture in the game's DXGI swapchain
+    // depthTexture: the game's scene depth buffer, if identified (optional)
+    // motionVectors: the game's TAA motion vector target, if identified (optional)
+    // Even presents are the left eye, odd presents the right eye
+    void SubmitFrame(ID3D12Resource* gameTexture, uint32_t backBufferIndex, ID3D12Resource* depthTexture = nullptr,
+                     ID3D12Resource* motionVectors = nullptr);
+
+    // Receive each eye's visibility mask, e.g. to stencil out hidden pixels in
+    // the game's own rendering. Called from SubmitFrame (render thread) once the
+    // masks are known and again whenever the runtime changes them; pass nullptr
+    // to unregister
+    void SetVisibilityMaskCallback(VRVisibilityMaskCallback callback, void* userData = nullptr);
+
+    // Drop cached per-back-buffer GPU work
+    // Must be called before the game's swapchain buffers are resized or recreated
+    void InvalidateBackBuffers();
 
     // Get VR controller state for input mapping
     // Returns true if controllers are available
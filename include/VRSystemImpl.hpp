@@ -0,0 +1,1038 @@
+#pragma once
+
+// VRSystem internals, shared by the VRSystem*.cpp translation units
+// Everything else goes through VRSystem.hpp
+
+#include "VRSystem.hpp"
+#include "ThreadSafe.hpp"
+#include "Utils.hpp"
+#include "EyeResample.hpp"
+#include "OutputScaler.hpp"
+#include "VisibilityMask.hpp"
+#include "LensMatch.hpp"
+#include "PerfLevels.hpp"
+#include "RefreshRate.hpp"
+#include "ResourceStates.hpp"
+#include "GpuTimer.hpp"
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+
+// Windows / DirectX / OpenXR Headers
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <d3d12.h>
+#include <d3dcompiler.h>
+#include <dxgi1_4.h>
+
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+
+#include <algorithm>
+
+// DXGI format helpers for the eye submission path
+namespace FormatUtils
+{
+    // Formats in the same family can be copied with CopyTextureRegion
+    // FP16 float and UNORM16 share a typeless format, but a raw copy between them
+    // reinterprets the bits, so float is kept apart and goes through the resample pass
+    inline DXGI_FORMAT GetTypelessFormat(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return DXGI_FORMAT_R8G8B8A8_TYPELESS;
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8A8_TYPELESS;
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8X8_TYPELESS;
+        case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            return DXGI_FORMAT_R10G10B10A2_TYPELESS;
+        case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+        case DXGI_FORMAT_R16G16B16A16_UNORM:
+            return DXGI_FORMAT_R16G16B16A16_TYPELESS;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+        default:
+            return format;
+        }
+    }
+
+    inline bool IsCopyCompatible(DXGI_FORMAT a, DXGI_FORMAT b)
+    {
+        return GetTypelessFormat(a) == GetTypelessFormat(b);
+    }
+
+    // Back buffers in these formats hold linear values and need sRGB encoding
+    inline bool IsLinearFormat(DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_R16G16B16A16_FLOAT;
+    }
+
+    inline bool IsSrgbFormat(DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+               format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+               format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+    }
+
+    // sRGB view of an 8-bit UNORM format, or DXGI_FORMAT_UNKNOWN if there is none
+    inline DXGI_FORMAT GetSrgbFormat(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    // UAVs cannot use sRGB formats; the resample kernel writes the raw bytes instead
+    inline DXGI_FORMAT GetUavFormat(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8A8_UNORM;
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            return DXGI_FORMAT_B8G8R8X8_UNORM;
+        default:
+            return format;
+        }
+    }
+
+    // Typed view of a typeless render target
+    inline DXGI_FORMAT GetSrvFormat(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+            return DXGI_FORMAT_R8G8B8A8_UNORM;
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+            return DXGI_FORMAT_B8G8R8A8_UNORM;
+        case DXGI_FORMAT_R16G16_TYPELESS:
+            return DXGI_FORMAT_R16G16_FLOAT;
+        default:
+            return format;
+        }
+    }
+
+    // Formats the resample kernel can write when no copy-compatible format is offered
+    inline bool IsResampleTarget(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+// Fence waits
+// Every blocking wait borrows an auto-reset event from a pool, so threads never
+// share one and no wait pays for CreateEvent. A wait checks the fence first,
+// optionally spins for a short budget (waits that end within a fraction of a
+// millisecond cost less than a trip through the scheduler), and only then
+// blocks. Several fence values can be waited on in one call. An event only
+// returns to the pool once its fence value is reached, and a wake-up only counts
+// when the fence values confirm it.
+namespace FenceWait
+{
+    enum class Result
+    {
+        Complete,
+        Timeout,
+        Failed
+    };
+
+    struct Target
+    {
+        ID3D12Fence* fence = nullptr;
+        UINT64 value = 0;
+    };
+
+    class EventPool
+    {
+    public:
+        ~EventPool()
+        {
+            for (HANDLE event : m_all)
+            {
+                CloseHandle(event);
+            }
+        }
+
+        // nullptr if no event could be created
+        HANDLE Acquire()
+        {
+            ThreadSafe::Lock lock(m_mutex);
+            if (!m_free.empty())
+            {
+                HANDLE event = m_free.back();
+                m_free.pop_back();
+                return event;
+            }
+
+            HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+            if (event)
+            {
+                m_all.push_back(event);
+            }
+            return event;
+        }
+
+        // Only for an event whose fence value has been reached: the completion
+        // signal has then fired, and anything it left set is cleared here
+        void Release(HANDLE event)
+        {
+            ResetEvent(event);
+            ThreadSafe::Lock lock(m_mutex);
+            m_free.push_back(event);
+        }
+
+        // For an event whose completion is still pending (timeout, any-wait): the
+        // fence may set it at any later point, so it is never handed out again
+        void Discard(HANDLE event)
+        {
+            (void)event;    // Stays in m_all and is closed with the pool
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<HANDLE> m_free;
+        std::vector<HANDLE> m_all;
+    };
+
+    inline bool IsComplete(const Target& target)
+    {
+        return target.fence->GetCompletedValue() >= target.value;
+    }
+
+    // waitAll: every target must complete; otherwise the first one is enough
+    inline Result Wait(EventPool& pool, const Target* targets, size_t count, bool waitAll,
+                       DWORD timeoutMs, std::chrono::nanoseconds spin = std::chrono::nanoseconds(0))
+    {
+        constexpr size_t MAX_TARGETS = 4;
+        if (count == 0 || count > MAX_TARGETS)
+        {
+            return (count == 0) ? Result::Complete : Result::Failed;
+        }
+
+        auto done = [&]()
+        {
+            size_t completed = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                completed += IsComplete(targets[i]) ? 1 : 0;
+            }
+            return waitAll ? (completed == count) : (completed > 0);
+        };
+
+        if (done())
+        {
+            return Result::Complete;
+        }
+
+        if (spin.count() > 0)
+        {
+            auto spinEnd = std::chrono::steady_clock::now() + spin;
+            while (std::chrono::steady_clock::now() < spinEnd)
+            {
+                YieldProcessor();
+                if (done())
+                {
+                    return Result::Complete;
+                }
+            }
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;)
+        {
+            HANDLE events[MAX_TARGETS] = {};
+            const Target* armedTargets[MAX_TARGETS] = {};
+            DWORD eventCount = 0;
+            bool armed = true;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (IsComplete(targets[i]))
+                {
+                    continue;
+                }
+
+                HANDLE event = pool.Acquire();
+                if (!event)
+                {
+                    armed = false;
+                    break;
+                }
+                events[eventCount] = event;
+                armedTargets[eventCount++] = &targets[i];
+                if (FAILED(targets[i].fence->SetEventOnCompletion(targets[i].value, event)))
+                {
+                    armed = false;
+                    break;
+                }
+            }
+
+            DWORD wait = WAIT_FAILED;
+            DWORD remainingMs = timeoutMs;
+            if (armed && eventCount > 0 && !done())
+            {
+                if (timeoutMs != INFINITE)
+                {
+                    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline - std::chrono::steady_clock::now()).count();
+                    remainingMs = static_cast<DWORD>(std::max<long long>(remaining, 0));
+                }
+                wait = WaitForMultipleObjects(eventCount, events, waitAll ? TRUE : FALSE, remainingMs);
+            }
+
+            // A pending completion would set the event under a later, unrelated waiter
+            for (DWORD i = 0; i < eventCount; i++)
+            {
+                if (IsComplete(*armedTargets[i]))
+                {
+                    pool.Release(events[i]);
+                }
+                else
+                {
+                    pool.Discard(events[i]);
+                }
+            }
+
+            // Completion is decided by the fence values, never by an event alone
+            if (done())
+            {
+                return Result::Complete;
+            }
+            if (!armed || wait == WAIT_FAILED || wait >= WAIT_OBJECT_0 + eventCount)
+            {
+                return (wait == WAIT_TIMEOUT) ? Result::Timeout : Result::Failed;
+            }
+            if (timeoutMs != INFINITE && remainingMs == 0)
+            {
+                return Result::Timeout;
+            }
+            // Woken by an event left set by an earlier wait: arm again
+        }
+    }
+
+    inline Result Wait(EventPool& pool, const Target& target, DWORD timeoutMs,
+                       std::chrono::nanoseconds spin = std::chrono::nanoseconds(0))
+    {
+        return Wait(pool, &target, 1, true, timeoutMs, spin);
+    }
+}
+
+// OpenXR session states
+enum class SessionState
+{
+    Unknown,
+    Idle,
+    Ready,
+    Synchronized,
+    Visible,
+    Focused,
+    Stopping,
+    LossPending,
+    Exiting
+};
+
+// What the headset currently does with our frames; every per-frame path asks
+// this one state instead of combining session state and shouldRender itself
+enum class Activity
+{
+    Stopped,    // No running session: nothing but event polling
+    Hidden,     // Frame loop only (headset off, shouldRender false): empty frames, throttled
+    Visible,    // Frames are shown: copies and pose work, no input
+    Focused     // Frames are shown and input goes to the game
+};
+
+// The Actual Implementation Class
+class VRSystem::Impl
+{
+public:
+    // Thread safety
+    mutable std::mutex m_mutex;
+    ThreadSafe::Flag m_initialized{false};
+    ThreadSafe::Flag m_sessionReady{false};
+
+    // Background initialization (InitializeAsync)
+    std::thread m_initThread;
+    ThreadSafe::Flag m_frameInProgress{false};
+    std::atomic<SessionState> m_sessionState{SessionState::Unknown};
+    std::atomic<Activity> m_activity{Activity::Stopped};   // Written by the pacer only
+    ThreadSafe::Flag m_activityResumed{false};             // Render thread restarts its frame timing
+
+    // Session recovery (pacer thread)
+    // A lost session (LOSS_PENDING, EXITING, XR_ERROR_SESSION_LOST) is torn down
+    // and recreated on the bound device, reusing the instance, action set and
+    // bindings; a lost instance is recreated with them. The game renders flat
+    // meanwhile: the render thread skips any Present that finds the session
+    // being rebuilt, and packets of the old session are never ended.
+    enum class Recovery
+    {
+        None,
+        Session,
+        Instance
+    };
+    Recovery m_recovery = Recovery::None;
+    uint32_t m_recoveryAttempts = 0;
+    std::chrono::steady_clock::time_point m_nextRecoveryAttempt{};
+    static constexpr std::chrono::milliseconds RECOVERY_RETRY_INTERVAL{250};
+    static constexpr std::chrono::milliseconds RECOVERY_SLOW_RETRY_INTERVAL{2000};
+    static constexpr uint32_t RECOVERY_FAST_ATTEMPTS = 20;     // About 5 s of quick retries
+    std::mutex m_sessionMutex;                  // Render thread per Present (try-lock), pacer while rebuilding
+    std::atomic<uint64_t> m_sessionEpoch{0};    // Bumped on every teardown
+
+    // OpenXR handles
+    XrInstance m_instance = XR_NULL_HANDLE;
+    XrSystemId m_systemId = XR_NULL_SYSTEM_ID;
+    XrSession m_session = XR_NULL_HANDLE;
+    XrSpace m_appSpace = XR_NULL_HANDLE;
+    XrSpace m_viewSpace = XR_NULL_HANDLE;   // Head-locked HUD layer
+
+    // OpenXR Action System for controllers
+    XrActionSet m_actionSet = XR_NULL_HANDLE;
+    XrAction m_triggerAction = XR_NULL_HANDLE;
+    XrAction m_gripAction = XR_NULL_HANDLE;
+    XrAction m_thumbstickAction = XR_NULL_HANDLE;
+    XrAction m_thumbstickClickAction = XR_NULL_HANDLE;
+    XrAction m_primaryButtonAction = XR_NULL_HANDLE;    // A/X buttons
+    XrAction m_secondaryButtonAction = XR_NULL_HANDLE;  // B/Y buttons
+    XrAction m_menuButtonAction = XR_NULL_HANDLE;
+    XrAction m_handPoseAction = XR_NULL_HANDLE;
+
+    XrPath m_handPaths[2] = { XR_NULL_PATH, XR_NULL_PATH };
+    XrSpace m_handSpaces[2] = { XR_NULL_HANDLE, XR_NULL_HANDLE };
+
+    // Controller state: built by the pacer thread, copied out under the mutex
+    VRControllerState m_controllerState;            // Pacer thread only
+    VRControllerState m_publishedControllerState;
+    std::mutex m_controllerMutex;
+    ThreadSafe::Flag m_controllersAvailable{false};
+
+    XrGraphicsBindingD3D12KHR m_graphicsBinding{XR_TYPE_GRAPHICS_BINDING_D3D12_KHR};
+
+    // D3D12 resources (using ComPtr for automatic cleanup)
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12CommandQueue> m_commandQueue;
+    ComPtr<ID3D12CommandAllocator> m_commandAllocator;
+    ComPtr<ID3D12Fence> m_fence;            // Signalled by m_commandQueue only (see SignalFence)
+    FenceWait::EventPool m_fenceEvents;     // Every wait on m_fence or m_copyFence, from any thread
+    std::atomic<UINT64> m_fenceValue{0};
+    std::mutex m_signalMutex;               // Keeps m_fence signals in value order
+
+    // Game back buffer format (DXGI_FORMAT_UNKNOWN until the first Present)
+    // and the swapchain format negotiated against it
+    DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_UNKNOWN;
+    DXGI_FORMAT m_swapchainFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    // Frame state of the frame currently begun (guarded by m_frameMutex)
+    XrFrameState m_frameState{XR_TYPE_FRAME_STATE};
+
+    // Frame pacing thread
+    // Owns xrWaitFrame/xrBeginFrame, event polling, action sync and every
+    // swapchain acquire, wait and (re)creation so the game thread never blocks
+    // inside OpenXR. One frame is in flight at a time: the render thread builds
+    // its layers in SubmitFrame, the submission thread ends it and wakes the
+    // pacer for the next one.
+    struct FrameSlot {
+        XrTime displayTime = 0;
+        XrDuration displayPeriod = 0;
+        XrView views[2] = {};
+        bool valid = false;
+    };
+    ThreadSafe::LatestValue<FrameSlot> m_frameSlot;    // Pacer -> camera hook
+    ThreadSafe::LatestValue<FrameSlot> m_renderSlot;   // Pacer -> render thread, published before m_frameInProgress
+    FrameSlot m_renderFrame;                            // Render thread's copy of the latest begun frame
+    std::thread m_pacingThread;
+    ThreadSafe::Flag m_stopPacing{false};
+    static constexpr std::chrono::milliseconds IDLE_FRAME_INTERVAL{50};   // Empty frames while hidden
+    std::mutex m_frameMutex;                            // Orders xrBeginFrame/xrEndFrame, never taken on Present
+    std::condition_variable m_frameEnded;
+    static constexpr std::chrono::milliseconds FRAME_END_TIMEOUT{100};
+
+    // Submission thread
+    // Present only queues the eye's GPU work, signals m_fence and pushes a packet;
+    // this thread releases the images the packet wrote, waits for the GPU and
+    // ends the OpenXR frame, so neither the GPU nor the compositor can stall the
+    // game's Present. Layers are built on the render thread inside the packet,
+    // which stays put until it is popped.
+    enum class ImageFamily : uint32_t
+    {
+        Color,      // m_swapchains
+        Depth,      // m_depthSwapchains
+        Motion,     // m_motionSwapchains
+        Inset,      // m_insetSwapchains, one per eye
+        Ui,         // m_uiSwapchain, index 0 only
+    };
+    static constexpr uint32_t IMAGE_FAMILY_COUNT = 5;
+
+    struct ImageRelease {
+        ImageFamily family = ImageFamily::Color;
+        uint32_t index = 0;
+        uint32_t generation = 0;        // Dropped if the swapchain was destroyed since
+    };
+
+    struct SubmitPacket {
+        uint64_t frame = 0;
+        uint64_t sessionEpoch = 0;      // Layers reference this session's swapchains
+        XrTime displayTime = 0;         // Frame the layers were built for
+        int eyeIndex = 0;
+        uint32_t backBufferIndex = 0;
+        UINT64 fenceValue = 0;          // Signalled after this Present's GPU work
+        UINT64 copyFenceValue = 0;      // Copy queue eye copy to restore the image after, 0 if none
+        uint32_t imageIndex = 0;        // Eye image the copy wrote
+        bool endFrame = false;          // Ends the frame the pacer began
+        bool submitLayers = false;      // Both eyes have an image
+
+        ImageRelease releases[IMAGE_FAMILY_COUNT] = {};
+        uint32_t releaseCount = 0;
+
+        const XrCompositionLayerBaseHeader* layers[3] = {};
+        uint32_t layerCount = 0;
+        XrCompositionLayerProjection projectionLayer = {};
+        XrCompositionLayerProjectionView projectionViews[2] = {};
+        XrCompositionLayerDepthInfoKHR depthInfos[2] = {};
+        XrCompositionLayerSpaceWarpInfoFB spaceWarpInfos[2] = {};
+        XrCompositionLayerProjection insetLayer = {};
+        XrCompositionLayerProjectionView insetViews[2] = {};
+        XrCompositionLayerQuad uiQuad = {};
+        XrCompositionLayerCylinderKHR uiCylinder = {};
+    };
+    ThreadSafe::SpscQueue<SubmitPacket, 4> m_submitQueue;  // Render thread -> submission thread
+    std::thread m_submissionThread;
+    ThreadSafe::Flag m_stopSubmission{false};
+    HANDLE m_submitEvent = nullptr;                     // Set after every push
+    static constexpr std::chrono::microseconds FENCE_SPIN_TIME{200};  // Before blocking on a frame's fence
+    uint64_t m_droppedPackets = 0;
+    uint64_t m_stalePackets = 0;                        // Submission thread only
+
+    // Game frame parity and the pose snapshot taken for it
+    ThreadSafe::Counter m_presentCount{0};              // Presents submitted so far
+    VRFramePose m_poseSnapshot;                         // Camera thread only
+    uint64_t m_poseSnapshotPresent = ~0ull;             // Present count the snapshot was taken at
+
+    // Views each game frame was rendered with, keyed by present index
+    // Written when the camera pose is injected and read when that frame's back
+    // buffer is submitted, so the runtime reprojects from the rendered pose
+    struct RenderedViews {
+        XrTime displayTime = 0;
+        XrPosef pose[2] = {};
+        XrFovf fov[2] = {};
+    };
+    static constexpr size_t POSE_HISTORY_SIZE = 16;
+    ThreadSafe::FrameHistory<RenderedViews, POSE_HISTORY_SIZE> m_poseHistory;
+
+    // Latest image written for each eye (render thread only)
+    static constexpr uint64_t NO_FRAME = ~0ull;
+    struct EyeWrite {
+        uint64_t frame = NO_FRAME;    // Present index the image was rendered for
+        XrExtent2Di extent = {};      // Region written
+        bool hasDepth = false;        // Matching depth image was written too
+        XrRect2Di depthRect = {};     // Region of the depth and motion images that lines up with extent
+        bool hasMotion = false;       // Matching motion vector image was written too
+    };
+    EyeWrite m_eyeWrites[2];
+
+    // Every-frame submission needs each eye's last image to stay valid on its
+    // own, which only holds with one swapchain per eye
+    bool IsEveryFrameSubmit() const
+    {
+        return VRConfig::IsEveryFrameSubmit() && m_swapchainCount == 2;
+    }
+
+    struct SwapchainInfo {
+        XrSwapchain handle = XR_NULL_HANDLE;
+        int32_t width = 0;
+        int32_t height = 0;
+        uint32_t arraySize = 1;
+        std::vector<XrSwapchainImageD3D12KHR> images;
+
+        // Image currently held by the application (-1 if none)
+        int32_t acquiredImage = -1;
+        bool imageReady = false;
+    };
+
+    // Where each eye's image lives: either its own swapchain, or one slice
+    // of a single arraySize = 2 swapchain shared by both eyes
+    struct EyeTarget {
+        uint32_t swapchainIndex = 0;
+        uint32_t arrayIndex = 0;
+        bool releaseAfterWrite = true; // Last eye written into this swapchain each frame
+    };
+
+    SwapchainInfo m_swapchains[2];
+    EyeTarget m_eyeTargets[2];
+    uint32_t m_swapchainCount = 0;
+
+    // Image ownership, per swapchain of every family. The pacer acquires and
+    // waits for the next image in the gap after each submission; the render
+    // thread takes a ready image without blocking and skips the write when there
+    // is none, and the submission thread releases what the render thread wrote.
+    // Whoever moves a swapchain out of Free/Acquired/Ready/Releasing owns its
+    // image fields.
+    enum class ImageState : uint32_t
+    {
+        Free,       // Nothing acquired
+        Busy,       // The pacer is inside acquire/wait for this swapchain
+        Acquired,   // Acquired, wait not finished yet
+        Ready,      // Acquired and waited: writable
+        Writing,    // Held by the render thread
+        Releasing,  // Written; released by the submission thread with its packet
+    };
+    std::atomic<ImageState> m_imageStates[IMAGE_FAMILY_COUNT][2] = {};
+    std::atomic<uint32_t> m_imageGenerations[IMAGE_FAMILY_COUNT] = {};  // Bumped under m_frameMutex before a destroy
+    ImageRelease m_pendingReleases[IMAGE_FAMILY_COUNT] = {};            // Render thread: rides in the next packet
+    uint32_t m_pendingReleaseCount = 0;
+    static constexpr XrDuration PRE_ACQUIRE_WAIT_TIMEOUT = 2000000;     // 2ms per pacer pass
+    uint32_t m_skippedEyes = 0;
+
+    // Swapchains the render thread needs, made by the pacer between frames while
+    // it holds m_sessionMutex: destroying one waits for the GPU. Sizes are packed
+    // as width << 32 | height, 0 when nothing is asked for
+    std::atomic<uint64_t> m_depthRequest{0};
+    std::atomic<uint64_t> m_uiRequest{0};
+    ThreadSafe::Flag m_insetRequested{false};
+
+    static uint64_t PackExtent(uint64_t width, uint32_t height) { return (width << 32) | height; }
+
+    // Depth swapchains mirror the colour eye targets but are sized to the game's
+    // depth buffer: depth resources can only be copied as whole subresources.
+    // Requested by the render thread when a usable depth buffer is first seen.
+    std::vector<XrExtensionProperties> m_availableExtensions;
+    bool m_depthLayerSupported = false;     // XR_KHR_composition_layer_depth enabled
+    bool m_depthFormatSupported = false;    // Runtime offers D32_FLOAT swapchains
+    SwapchainInfo m_depthSwapchains[2];
+    bool m_hasDepthSwapchains = false;
+
+    // Depth copy lists, one per (eye, depth image), recorded for one game depth
+    // buffer from m_commandAllocator and dropped together with the colour cache
+    ID3D12Resource* m_depthCacheSource = nullptr;
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_depthCopyLists[2];
+    bool m_depthMismatchLogged = false;
+
+    // State the game leaves its depth buffer in at Present
+    static constexpr D3D12_RESOURCE_STATES DEPTH_SOURCE_STATE = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+
+    SwapchainInfo& GetEyeDepthSwapchain(int eyeIndex) { return m_depthSwapchains[m_eyeTargets[eyeIndex].swapchainIndex]; }
+
+    // Application space warp (XR_FB_space_warp): the game's motion vectors are
+    // converted into motion swapchains that mirror the depth swapchains, and
+    // the runtime synthesizes frames from motion + depth instead of guessing
+    bool m_spaceWarpSupported = false;      // XR_FB_space_warp enabled
+    XrSystemSpaceWarpPropertiesFB m_spaceWarpProperties = { XR_TYPE_SYSTEM_SPACE_WARP_PROPERTIES_FB };
+    SwapchainInfo m_motionSwapchains[2];
+    bool m_hasMotionSwapchains = false;
+
+    // Conversion pass; shares the resample root signature
+    // Motion heap layout: [motion source SRV][eye 0 image UAVs][eye 1 image UAVs]
+    ComPtr<ID3D12PipelineState> m_motionPipeline;
+    ComPtr<ID3D12DescriptorHeap> m_motionHeap;
+    ID3D12Resource* m_motionCacheSource = nullptr;
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_motionLists[2];
+
+    // State the game leaves its motion vectors in at Present (read by the TAA resolve)
+    static constexpr D3D12_RESOURCE_STATES MOTION_SOURCE_STATE = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    static constexpr DXGI_FORMAT MOTION_FORMAT = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+    SwapchainInfo& GetEyeMotionSwapchain(int eyeIndex) { return m_motionSwapchains[m_eyeTargets[eyeIndex].swapchainIndex]; }
+
+    // HUD / menu layer: the game's UI target resampled into its own swapchain
+    // at a text-friendly size. A GPU content hash gates the copy, so the image
+    // is only rewritten when the UI changed (render thread only)
+    bool m_cylinderSupported = false;       // XR_KHR_composition_layer_cylinder enabled
+    SwapchainInfo m_uiSwapchain;
+    bool m_uiImageValid = false;            // An image has been released and can be shown
+    bool m_uiVisible = false;               // The UI was taken out of this frame
+    ID3D12Resource* m_uiSource = nullptr;   // Capture the UI lists were recorded for
+
+    // UI heap layout: [capture SRV][hash counter UAV][UI image UAVs]
+    // The UI lists have their own allocator: re-recording them never touches the eye lists
+    ComPtr<ID3D12PipelineState> m_uiHashPipeline;
+    ComPtr<ID3D12DescriptorHeap> m_uiHeap;
+    ComPtr<ID3D12CommandAllocator> m_uiAllocator;
+    ComPtr<ID3D12Resource> m_uiHashCounter;     // 2x1 R32_UINT, accumulated, never cleared
+    ComPtr<ID3D12Resource> m_uiHashReadback;
+    ComPtr<ID3D12GraphicsCommandList> m_uiHashList;
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> m_uiLists;
+
+    // The UI is taken out of the game's frame so it is only seen once, in the
+    // layer: when the game finishes drawing its UI target (the barrier hook sees
+    // RENDER_TARGET -> shader read), the target is copied into m_uiCapture and,
+    // if the user allows it, cleared on the game's own command list. The final
+    // composite then draws nothing into the back buffer the eye images are copied from
+    std::mutex m_uiCaptureMutex;                    // Game recording threads vs pacer
+    ComPtr<ID3D12Resource> m_uiCapture;             // Same size and format as the UI target
+    D3D12_RESOURCE_DESC m_uiCaptureDesc = {};
+    ComPtr<ID3D12DescriptorHeap> m_uiRtvHeap;       // One RTV, rewritten per capture to clear the target
+    // The capture is written on the game's present queue and read on
+    // m_commandQueue: the present queue signals m_uiCaptureFence after the
+    // frame's capture and m_commandQueue waits on it before the UI passes; the
+    // present queue then waits on m_fence behind those passes, so the next
+    // capture does not overwrite what they still read (see WaitForUiCapture)
+    ComPtr<ID3D12Fence> m_uiCaptureFence;           // Signalled by the present queue only
+    UINT64 m_uiCaptureFenceValue = 0;               // Render thread
+    std::mutex m_presentQueueMutex;
+    ComPtr<ID3D12CommandQueue> m_presentQueue;      // From SetPresentQueue (any thread)
+    struct RetiredCapture
+    {
+        ComPtr<ID3D12Resource> capture;
+        uint64_t present = 0;       // Present count when it was replaced
+    };
+    std::vector<RetiredCapture> m_retiredUiCaptures;    // Game lists in flight may still copy into these
+    static constexpr uint64_t UI_CAPTURE_RETIRE_PRESENTS = 16;
+    std::atomic<uint64_t> m_uiCaptureRequest{0};    // PackExtent of the UI target, from the render thread
+    std::atomic<uint32_t> m_uiCaptureFormat{0};
+    std::atomic<bool> m_uiLayerReady{false};        // Capture and swapchain exist: the UI may be taken out
+    std::atomic<uint64_t> m_uiCaptures{0};          // Captures recorded so far
+    uint64_t m_uiCapturesSeen = 0;                  // Render thread: m_uiCaptures at the last Present
+    uint32_t m_uiHashCounterValue[2] = {};      // Counter at the last read
+    UINT64 m_uiHashFenceValue = 0;              // Fence value of the last hash pass
+    uint32_t m_uiShownHash[2] = {};             // Content hash of the image being shown
+    std::chrono::steady_clock::time_point m_uiLastCheck{};
+
+    // Menus are world-locked where the user was facing when they opened
+    bool m_menuAnchored = false;
+    XrPosef m_menuAnchor = {};
+    XrCompositionLayerQuad m_uiQuad = {};
+    XrCompositionLayerCylinderKHR m_uiCylinder = {};
+
+    // State m_uiCapture rests in between captures and UI passes; the game's
+    // own target is left in the state its barrier asked for
+    static constexpr D3D12_RESOURCE_STATES UI_CAPTURE_STATE = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+    SwapchainInfo& GetEyeSwapchain(int eyeIndex) { return m_swapchains[m_eyeTargets[eyeIndex].swapchainIndex]; }
+    const SwapchainInfo& GetEyeSwapchain(int eyeIndex) const { return m_swapchains[m_eyeTargets[eyeIndex].swapchainIndex]; }
+
+    // Region of each eye's image that is written and submitted this frame
+    // Moves between the minimum scale and the allocated size with a dynamic output scale
+    XrExtent2Di m_eyeExtents[2] = {};
+
+    // Dynamic output scale state (copy / resample output only), render thread.
+    // m_outputTimer spans each eye's copy / resample on m_commandQueue
+    OutputScaler m_outputScaler;
+    GpuTimer m_outputTimer;
+    bool m_outputScaleDynamic = false;
+
+    // Submit-to-submit time of the current frame pair, for the performance levels
+    std::chrono::steady_clock::time_point m_lastSubmitTime{};
+    double m_pairCostSeconds = 0.0;
+
+    // Runtime performance hints (XR_EXT_performance_settings), index 0 = CPU, 1 = GPU
+    // Levels are requested from the render thread after each frame pair;
+    // notifications arrive on the pacer thread and are applied there too
+    bool m_perfSettingsSupported = false;
+    PFN_xrPerfSettingsSetPerformanceLevelEXT m_xrPerfSettingsSetPerformanceLevelEXT = nullptr;
+    PerfLevels::Controller m_perfControllers[2];
+    std::atomic<uint32_t> m_perfNotifications[2][3] = {};   // [domain][sub-domain], pacer -> render thread
+    PerfLevels::Notification m_appliedNotifications[2] = {};
+
+    // GPU time of the game's frames, for the GPU performance level: a span on
+    // the queue the game presents on (SetPresentQueue) from its first submission
+    // after a Present (ExecuteCommandLists hook, any game thread) to the Present.
+    // Queue-span time, not busy time (see GpuTimer)
+    GpuTimer m_gameTimer;
+
+    // Display refresh rate (XR_FB_display_refresh_rate), requested from the
+    // render thread; the current rate lives in VRConfig so the pacer thread can
+    // update it from the change event
+    bool m_refreshRateSupported = false;
+    PFN_xrEnumerateDisplayRefreshRatesFB m_xrEnumerateDisplayRefreshRatesFB = nullptr;
+    PFN_xrGetDisplayRefreshRateFB m_xrGetDisplayRefreshRateFB = nullptr;
+    PFN_xrRequestDisplayRefreshRateFB m_xrRequestDisplayRefreshRateFB = nullptr;
+    std::vector<float> m_refreshRates;
+    RefreshRate::Selector m_refreshRateSelector;
+    float m_appliedRefreshRequest = 0.0f;      // Last fixed rate taken from VRConfig (0 = automatic)
+
+    UINT GetEyeSubresource(int eyeIndex) const
+    {
+        return D3D12CalcSubresource(0, m_eyeTargets[eyeIndex].arrayIndex, 0, 1, GetEyeSwapchain(eyeIndex).arraySize);
+    }
+
+    // Pre-recorded copy command lists, one per (back buffer, eye, swapchain image)
+    // Recorded from m_commandAllocator the first time a back buffer is seen and
+    // re-executed every frame; rebuilt only when back buffers or swapchains change.
+    // A rebuild never waits for the GPU: the old allocators are retired with the
+    // fence values that cover their lists and reused once those complete
+    struct CopyCacheEntry {
+        ID3D12Resource* source = nullptr; // Not AddRef'd: an extra ref would make ResizeBuffers fail
+        std::vector<ComPtr<ID3D12GraphicsCommandList>> lists[2];
+        std::vector<ComPtr<ID3D12GraphicsCommandList>> insetLists[2];  // Lens-matched inset, per inset image
+    };
+
+    std::vector<CopyCacheEntry> m_copyCache;
+    ThreadSafe::Flag m_copyCacheDirty{false};
+
+    struct RetiredAllocator {
+        ComPtr<ID3D12CommandAllocator> allocator;
+        D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+        UINT64 fenceValue = 0;      // On m_fence (DIRECT) or m_copyFence (COPY)
+    };
+    std::vector<RetiredAllocator> m_retiredAllocators;
+
+    // Copy queue path: plain eye copies run on the copy engine, next to the
+    // game's graphics work rather than behind it. A COPY queue can only use the
+    // common and copy states: the back buffer is already COMMON (PRESENT) and is
+    // promoted implicitly, while the eye image is moved out of RENDER_TARGET and
+    // back by small DIRECT lists on either side. Each queue signals its own fence,
+    // so a value on either one always means that queue's work up to it is done.
+    // Present only queues the move to COMMON and the copy; the submission thread
+    // waits for the copy fence and queues the move back before it releases the
+    // image, so the direct queue never waits on the copy queue
+    struct CopyTransitions {
+        ComPtr<ID3D12GraphicsCommandList> toCommon;
+        ComPtr<ID3D12GraphicsCommandList> toRenderTarget;
+    };
+    ComPtr<ID3D12CommandQueue> m_copyQueue;
+    ComPtr<ID3D12CommandAllocator> m_copyAllocator;
+    ComPtr<ID3D12Fence> m_copyFence;        // Signalled by m_copyQueue only
+    std::atomic<UINT64> m_copyFenceValue{0};
+
+    // Recorded with the eye swapchains and kept until the session goes:
+    // the submission thread executes them after the copy cache may have moved on
+    ComPtr<ID3D12CommandAllocator> m_transitionAllocator;
+    std::vector<CopyTransitions> m_copyTransitions[2];  // Per eye image
+
+    // How often a copy finished before the direct work queued with it (submission thread)
+    static constexpr uint64_t COPY_OVERLAP_LOG_INTERVAL = 900;
+    uint64_t m_queueCopies = 0;
+    uint64_t m_overlappedCopies = 0;
+
+    // Lens visibility mask (XR_KHR_visibility_mask)
+    // Each eye's visible-area mesh is loaded on the render thread when the pacer
+    // reports a change, and rasterized into tiles against the current extent
+    // when copy lists are recorded; hidden tiles are never copied or resampled
+    struct VisibilityMaskInfo {
+        std::vector<float> vertices;        // xy pairs on the z = -1 plane
+        std::vector<uint32_t> indices;
+        VisibilityMask::TileMask tiles;
+        std::vector<VisibilityMask::Rect> rects;
+        XrExtent2Di rectsExtent = {};       // Extent the rects were built for
+    };
+
+    bool m_visibilityMaskSupported = false;
+    PFN_xrGetVisibilityMaskKHR m_xrGetVisibilityMaskKHR = nullptr;
+    VisibilityMaskInfo m_visibilityMasks[2];
+    ThreadSafe::Flag m_visibilityMaskDirty{true};
+    ThreadSafe::Flag m_visibilityMaskNotify{false};
+
+    std::mutex m_visibilityCallbackMutex;
+    VRVisibilityMaskCallback m_visibilityMaskCallback = nullptr;
+    void* m_visibilityMaskUserData = nullptr;
+
+    // Lens-matched two-band submission (see LensMatch.hpp)
+    // The eye images become the reduced-density outer band; the inset swapchains
+    // hold the full-density centre and are created by the pacer once the view
+    // FOV is known. Descriptor heap layout: [back buffer SRVs][eye 0 inset
+    // UAVs][eye 1 inset UAVs]
+    bool m_lensMatched = false;
+    float m_peripheryScale = 1.0f;
+    SwapchainInfo m_insetSwapchains[2];
+    LensMatch::FovTangents m_insetFov[2];
+    LensMatch::UvRect m_insetUv[2];
+    ComPtr<ID3D12DescriptorHeap> m_insetHeap;
+    bool m_insetWritten[2] = {};
+
+    // Resample pass (used when the back buffer cannot be copied 1:1 into the eye image)
+    // Descriptor heap layout: [back buffer SRVs][eye 0 image UAVs][eye 1 image UAVs]
+    static constexpr uint32_t MAX_BACK_BUFFERS = 16;
+    ComPtr<ID3D12RootSignature> m_resampleRootSignature;
+    ComPtr<ID3D12PipelineState> m_resamplePipeline;
+    ComPtr<ID3D12DescriptorHeap> m_descriptorHeap;
+    UINT m_descriptorSize = 0;
+
+    std::vector<XrViewConfigurationView> m_viewConfigs;
+    std::vector<XrView> m_views;        // Pacer thread; other threads read them from the frame slots
+
+    // Session, frame loop and eye images (VRSystem.cpp)
+    bool CreateInstance();
+    bool IsExtensionAvailable(const char* name);
+    void QuerySpaceWarpProperties();
+    bool CreateSession(ID3D12CommandQueue* gameCommandQueue);
+    bool OpenSession();
+    bool CreateSwapchains();
+    void ConfigureLensMatching();
+    void ConfigureOutputScaler();
+    void GetAllocationSize(const XrViewConfigurationView& view, uint32_t& width, uint32_t& height) const;
+    bool UpdateEyeExtents();
+    void BeginOutputTime();
+    void EndOutputTime();
+    void UpdateOutputScale(ID3D12Resource* source, XrDuration displayPeriod);
+    float GetSourceLimit(ID3D12Resource* source) const;
+    void ConfigurePerfLevels();
+    void SetPerfLevel(int domainIndex);
+    void RecordPerfNotification(const XrEventDataPerfSettingsEXT& perfEvent);
+    void ApplyPerfNotifications();
+    void UpdatePerfLevels(double pairCostSeconds, double gpuSeconds, XrDuration displayPeriod);
+    void BeginGpuTime(ID3D12CommandQueue* queue);
+    double ReadGpuTime();
+    void ConfigureRefreshRates();
+    void RequestRefreshRate(float rate, const char* reason);
+    void UpdateRefreshRate(double presentIntervalSeconds);
+    DXGI_FORMAT SelectSwapchainFormat();
+    std::vector<int64_t> EnumerateSwapchainFormats() const;
+    bool CreateSwapchain(SwapchainInfo& swapchain, uint32_t width, uint32_t height, uint32_t arraySize);
+    bool CreateSwapchain(SwapchainInfo& swapchain, DXGI_FORMAT format, XrSwapchainUsageFlags usageFlags,
+                         uint32_t width, uint32_t height, uint32_t arraySize);
+    bool CreateActionSystem();
+    bool AttachActionSet();
+    void SyncActions(XrTime predictedTime);
+    bool CreateD3D12Resources();
+    bool CreateResamplePipeline();
+    bool CreateDescriptors();
+    UINT GetImageDescriptorIndex(int eyeIndex, uint32_t imageIndex) const;
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCPUDescriptor(UINT index) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptor(UINT index) const;
+    D3D12_CPU_DESCRIPTOR_HANDLE GetDescriptor(ID3D12DescriptorHeap* heap, UINT index) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUDescriptor(ID3D12DescriptorHeap* heap, UINT index) const;
+    bool WaitForGPU();
+    void CreateCopyQueue();
+    void DestroyCopyQueue();
+    static void FlushBarriers(ID3D12GraphicsCommandList* commandList, ResourceStates::Tracker& states);
+    ComPtr<ID3D12GraphicsCommandList> RecordTransitionList(ID3D12Resource* resource, UINT subresource,
+                                                           D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after);
+    bool CreateCopyTransitions();
+    const CopyTransitions* GetCopyTransitions(int eyeIndex, uint32_t imageIndex) const;
+    ComPtr<ID3D12GraphicsCommandList> RecordQueueCopyList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex);
+    ComPtr<ID3D12GraphicsCommandList> RecordCopyList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex);
+    void RecordEyeCopies(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source, ID3D12Resource* dest,
+                         int eyeIndex);
+    ComPtr<ID3D12GraphicsCommandList> RecordResampleList(ID3D12Resource* source, uint32_t backBufferIndex,
+                                                         int eyeIndex, uint32_t imageIndex);
+    bool NeedsResample(ID3D12Resource* source, int eyeIndex, uint32_t backBufferIndex) const;
+    bool NeedsSrgbEncode(DXGI_FORMAT sourceFormat) const;
+    void CreateBackBufferSRV(ID3D12Resource* source, uint32_t backBufferIndex);
+    void ResetCopyCache();
+    void ReplaceAllocator(ComPtr<ID3D12CommandAllocator>& allocator, D3D12_COMMAND_LIST_TYPE type);
+    ID3D12GraphicsCommandList* GetCopyList(ID3D12Resource* source, uint32_t backBufferIndex,
+                                           int eyeIndex, uint32_t imageIndex);
+    void LoadVisibilityMasks();
+    void NotifyVisibilityMasks();
+    const std::vector<VisibilityMask::Rect>& GetVisibleRects(int eyeIndex);
+    SwapchainInfo& GetImageSwapchain(ImageFamily family, uint32_t index);
+    uint32_t GetImageSwapchainCount(ImageFamily family) const;
+    std::atomic<ImageState>& GetImageState(ImageFamily family, uint32_t index);
+    bool AcquireImage(SwapchainInfo& swapchain, XrDuration timeout);
+    void PreAcquireImages();
+    bool IsImageReady(ImageFamily family, uint32_t index);
+    bool TakeImage(ImageFamily family, uint32_t index);
+    void QueueRelease(ImageFamily family, uint32_t index);
+    bool AcquireEyeImage(int eyeIndex);
+    void ReleaseEyeImage(int eyeIndex);
+    void ReleaseImages(const SubmitPacket& packet, bool copyDone);
+    void RetireImages(ImageFamily family);
+    void DestroyInsetSwapchains();
+    bool HaveInsetSwapchains();
+    bool CreateInsetSwapchains();
+    bool CreateInsetDescriptors();
+    UINT GetInsetDescriptorIndex(int eyeIndex, uint32_t imageIndex) const;
+    ComPtr<ID3D12GraphicsCommandList> RecordInsetList(ID3D12Resource* source, uint32_t backBufferIndex,
+                                                      int eyeIndex, uint32_t imageIndex);
+    bool SubmitInset(uint32_t backBufferIndex, int eyeIndex);
+    const XrCompositionLayerBaseHeader* BuildInsetLayer(SubmitPacket& packet);
+    ComPtr<ID3D12CommandQueue> GetPresentQueue();
+    void ExecuteCopy(ID3D12GraphicsCommandList* commandList);
+    UINT64 ExecuteEyeCopy(ID3D12GraphicsCommandList* commandList, int eyeIndex, uint32_t imageIndex);
+    bool WaitForEyeCopy(const SubmitPacket& packet);
+    void RestoreEyeImage(const SubmitPacket& packet, bool copyDone);
+    UINT64 SignalFence();
+    UINT64 SignalCopyFence();
+    void HandleSessionStateChange(XrSessionState newState);
+    void PollEvents();
+    void RequestRecovery(Recovery level);
+    void RecoverSession();
+    bool RebuildSession();
+    void DestroySession();
+    void DestroyInstance();
+    void StartPacingThread();
+    void StopPacingThread();
+    bool StartSubmissionThread();
+    void StopSubmissionThread();
+    void PushPacket();
+    void LogDroppedPacket();
+    void SubmissionThreadMain();
+    void ProcessPacket(const SubmitPacket& packet);
+    void BuildLayers(SubmitPacket& packet);
+    void PacingThreadMain();
+    bool WaitForFrameEnd();
+    void ServiceSwapchainRequests();
+    Activity UpdateActivity(bool shouldRender);
+    bool IsRendering() const;
+    void EndIdleFrame(const XrFrameState& frameState);
+    void BeginFrame(const XrFrameState& frameState);
+    bool IsSessionRunning() const;
+
+    // UI layer (VRSystemUi.cpp)
+    bool CreateUiHashResources();
+    void DestroyUiSwapchain();
+    bool PrepareUiSwapchain(ID3D12Resource* source);
+    bool MatchesUiCapture(const D3D12_RESOURCE_DESC& desc) const;
+    bool PrepareUiCapture(ID3D12Resource* uiTarget);
+    bool CreateUiCapture(uint32_t width, uint32_t height, DXGI_FORMAT format);
+    bool RecordUiCapture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* uiTarget,
+                         D3D12_RESOURCE_STATES uiState);
+    bool CreateUiSwapchain(uint32_t width, uint32_t height);
+    bool CreateUiDescriptors(DXGI_FORMAT format);
+    ComPtr<ID3D12GraphicsCommandList> RecordUiHashList(ID3D12Resource* source);
+    ComPtr<ID3D12GraphicsCommandList> RecordUiList(ID3D12Resource* source, uint32_t imageIndex);
+    void ResetUiLists();
+    bool PrepareUiLists(ID3D12Resource* source);
+    bool HasUiChanged();
+    bool WaitForUiCapture(ID3D12CommandQueue* presentQueue);
+    void ReleaseUiCapture(ID3D12CommandQueue* presentQueue);
+    void UpdateUi(ID3D12Resource* uiTarget);
+    const XrCompositionLayerBaseHeader* BuildUiLayer();
+
+    // Depth and motion vector layers (VRSystemDepth.cpp)
+    void CheckDepthSupport();
+    void DestroyDepthSwapchains();
+    void DestroyMotionSwapchains();
+    bool CreateMotionSwapchains(uint32_t width, uint32_t height);
+    bool CreateDepthSwapchains(uint32_t width, uint32_t height);
+    bool CreateMotionPipeline();
+    bool CreateMotionDescriptors();
+    UINT GetMotionDescriptorIndex(int eyeIndex, uint32_t imageIndex) const;
+    bool IsDepthUsable(ID3D12Resource* depthSource, int eyeIndex, XrRect2Di& outRect);
+    bool PrepareDepthSwapchains(ID3D12Resource* depthSource);
+    ComPtr<ID3D12GraphicsCommandList> RecordDepthCopyList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex);
+    ID3D12GraphicsCommandList* GetDepthCopyList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex);
+    bool SubmitDepth(ID3D12Resource* depthSource, int eyeIndex, XrRect2Di& outRect);
+    ComPtr<ID3D12GraphicsCommandList> RecordMotionList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex);
+    ID3D12GraphicsCommandList* GetMotionList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex);
+    bool SubmitMotion(ID3D12Resource* motionSource, int eyeIndex);
+};
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Lens visibility mask -> tile mask
+// XR_KHR_visibility_mask describes the part of each eye image that can be seen
+// through the lens as a triangle mesh on the z = -1 plane of the view. The
+// mesh is rasterized conservatively into a coarse tile grid over the eye
+// image, and the visible tiles are merged into a few rectangles. The copy and
+// resample passes then only touch those rectangles.
+namespace VisibilityMask
+{
+    constexpr uint32_t DEFAULT_TILE_SIZE = 32;
+
+    // Tangents of the view's half angles (OpenXR XrFovf, after tan())
+    struct FovTangents
+    {
+        float left = -1.0f;
+        float right = 1.0f;
+        float up = 1.0f;
+        float down = -1.0f;
+    };
+
+    // Pixel rectangle, [x0, x1) x [y0, y1)
+    struct Rect
+    {
+        uint32_t x0 = 0;
+        uint32_t y0 = 0;
+        uint32_t x1 = 0;
+        uint32_t y1 = 0;
+    };
+
+    // Map a z = -1 plane point to image pixels (y down)
+    inline void ToPixels(float x, float y, const FovTangents& fov, uint32_t width, uint32_t height,
+                         float& outX, float& outY)
+    {
+        outX = (x - fov.left) / (fov.right - fov.left) * static_cast<float>(width);
+        outY = (fov.up - y) / (fov.up - fov.down) * static_cast<float>(height);
+    }
+
+    // Separating-axis test of a triangle against an axis-aligned box
+    inline bool TriangleOverlapsBox(const float tri[6], float minX, float minY, float maxX, float maxY)
+    {
+        float triMinX = std::min({ tri[0], tri[2], tri[4] });
+        float triMaxX = std::max({ tri[0], tri[2], tri[4] });
+        float triMinY = std::min({ tri[1], tri[3], tri[5] });
+        float triMaxY = std::max({ tri[1], tri[3], tri[5] });
+        if (triMaxX < minX || triMinX > maxX || triMaxY < minY || triMinY > maxY)
+        {
+            return false;
+        }
+
+        const float corners[8] = { minX, minY, maxX, minY, maxX, maxY, minX, maxY };
+        for (int edge = 0; edge < 3; edge++)
+        {
+            float ax = tri[edge * 2], ay = tri[edge * 2 + 1];
+            float bx = tri[((edge + 1) % 3) * 2], by = tri[((edge + 1) % 3) * 2 + 1];
+            float cx = tri[((edge + 2) % 3) * 2], cy = tri[((edge + 2) % 3) * 2 + 1];
+
+            // Edge normal, oriented towards the opposite vertex
+            float nx = ay - by;
+            float ny = bx - ax;
+            if (nx * (cx - ax) + ny * (cy - ay) < 0.0f)
+            {
+                nx = -nx;
+                ny = -ny;
+            }
+
+            bool anyInside = false;
+            for (int corner = 0; corner < 4 && !anyInside; corner++)
+            {
+                anyInside = nx * (corners[corner * 2] - ax) + ny * (corners[corner * 2 + 1] - ay) >= 0.0f;
+            }
+            if (!anyInside)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    class TileMask
+    {
+    public:
+        // Conservative rasterization of a visible-area triangle mesh
+        // vertices are xy pairs on the z = -1 plane; indices form triangles
+        void Rasterize(const float* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                       const FovTangents& fov, uint32_t width, uint32_t height,
+                       uint32_t tileSize = DEFAULT_TILE_SIZE)
+        {
+            m_width = width;
+            m_height = height;
+            m_tileSize = std::max(tileSize, 1u);
+            m_tilesX = (width + m_tileSize - 1) / m_tileSize;
+            m_tilesY = (height + m_tileSize - 1) / m_tileSize;
+            m_visible.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 0);
+
+            for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+            {
+                if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+                {
+                    continue;
+                }
+
+                float tri[6];
+                for (int v = 0; v < 3; v++)
+                {
+                    const float* vertex = &vertices[indices[i + v] * 2];
+                    ToPixels(vertex[0], vertex[1], fov, width, height, tri[v * 2], tri[v * 2 + 1]);
+                }
+                RasterizeTriangle(tri);
+            }
+        }
+
+        // Everything visible (no mask available)
+        void SetAllVisible(uint32_t width, uint32_t height, uint32_t tileSize = DEFAULT_TILE_SIZE)
+        {
+            m_width = width;
+            m_height = height;
+            m_tileSize = std::max(tileSize, 1u);
+            m_tilesX = (width + m_tileSize - 1) / m_tileSize;
+            m_tilesY = (height + m_tileSize - 1) / m_tileSize;
+            m_visible.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 1);
+        }
+
+        bool IsTileVisible(uint32_t tileX, uint32_t tileY) const
+        {
+            return m_visible[static_cast<size_t>(tileY) * m_tilesX + tileX] != 0;
+        }
+
+        float GetVisibleFraction() const
+        {
+            if (m_visible.empty()) return 1.0f;
+            size_t visible = std::count(m_visible.begin(), m_visible.end(), static_cast<uint8_t>(1));
+            return static_cast<float>(visible) / static_cast<float>(m_visible.size());
+        }
+
+        // Visible tiles as pixel rectangles clipped to the image: one span per
+        // tile row (first to last visible tile), merged with the rows below
+        // while the span stays the same. Lens masks are convex per row, so the
+        // span covers no hidden tile in practice
+        std::vector<Rect> GetVisibleRects() const
+        {
+            std::vector<Rect> rects;
+            for (uint32_t ty = 0; ty < m_tilesY; ty++)
+            {
+                uint32_t first = m_tilesX, last = 0;
+                for (uint32_t tx = 0; tx < m_tilesX; tx++)
+                {
+                    if (IsTileVisible(tx, ty))
+                    {
+                        first = std::min(first, tx);
+                        last = tx;
+                    }
+                }
+                if (first == m_tilesX)
+                {
+                    continue;
+                }
+
+                Rect rect;
+                rect.x0 = first * m_tileSize;
+                rect.x1 = std::min((last + 1) * m_tileSize, m_width);
+                rect.y0 = ty * m_tileSize;
+                rect.y1 = std::min((ty + 1) * m_tileSize, m_height);
+
+                if (!rects.empty() && rects.back().x0 == rect.x0 && rects.back().x1 == rect.x1 &&
+                    rects.back().y1 == rect.y0)
+                {
+                    rects.back().y1 = rect.y1;
+                }
+                else
+                {
+                    rects.push_back(rect);
+                }
+            }
+            return rects;
+        }
+
+        uint32_t GetTilesX() const { return m_tilesX; }
+        uint32_t GetTilesY() const { return m_tilesY; }
+        uint32_t GetTileSize() const { return m_tileSize; }
+
+    private:
+        void RasterizeTriangle(const float tri[6])
+        {
+            float minX = std::min({ tri[0], tri[2], tri[4] });
+            float maxX = std::max({ tri[0], tri[2], tri[4] });
+            float minY = std::min({ tri[1], tri[3], tri[5] });
+            float maxY = std::max({ tri[1], tri[3], tri[5] });
+
+            float tile = static_cast<float>(m_tileSize);
+            int x0 = std::max(static_cast<int>(std::floor(minX / tile)), 0);
+            int y0 = std::max(static_cast<int>(std::floor(minY / tile)), 0);
+            int x1 = std::min(static_cast<int>(std::floor(maxX / tile)), static_cast<int>(m_tilesX) - 1);
+            int y1 = std::min(static_cast<int>(std::floor(maxY / tile)), static_cast<int>(m_tilesY) - 1);
+
+            for (int ty = y0; ty <= y1; ty++)
+            {
+                for (int tx = x0; tx <= x1; tx++)
+                {
+                    uint8_t& visible = m_visible[static_cast<size_t>(ty) * m_tilesX + tx];
+                    if (!visible && TriangleOverlapsBox(tri, tx * tile, ty * tile, (tx + 1) * tile, (ty + 1) * tile))
+                    {
+                        visible = 1;
+                    }
+                }
+            }
+        }
+
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+        uint32_t m_tileSize = DEFAULT_TILE_SIZE;
+        uint32_t m_tilesX = 0;
+        uint32_t m_tilesY = 0;
+        std::vector<uint8_t> m_visible;
+    };
+}
@@ -190,13 +190,15 @@ void CameraHook::UpdateVRCamera()
         return;
     }
 
-    // Get VR head pose
-    float x, y, z, qx, qy, qz, qw;
-    if (!g_vrSystem->Update(x, y, z, qx, qy, qz, qw))
+    // Get VR head pose (one snapshot per game frame)
+    VRFramePose pose;
+    if (!g_vrSystem->GetFramePose(pose))
     {
         return;
     }
 
+    float x = pose.x, y = pose.y, z = pose.z;
+
     // If using SDK approach, we modify via the camera system
     if (m_useSDKApproach)
     {
@@ -210,9 +212,6 @@ void CameraHook::UpdateVRCamera()
     }
 
     // AER (Alternate Eye Rendering) logic
-    static ThreadSafe::Counter frameCount{0};
-    uint64_t frame = frameCount.fetch_add(1);
-
     float ipd = VRConfig::GetIPD();
     float worldScale = VRConfig::GetWorldScale();
 
@@ -223,41 +222,38 @@ void CameraHook::UpdateVRCamera()
 
     // Eye offset for stereo rendering
     float offsetX = 0.0f;
-    if (frame % 2 == 0) {
+    if (pose.isLeftEye) {
          offsetX = -(ipd / 2.0f);  // Left eye
     } else {
          offsetX = +(ipd / 2.0f);  // Right eye
     }
 
     // Store for use in hook callback
-    m_lastPose = { x + offsetX, y, z, qx, qy, qz, qw };
+    m_lastPose = { x + offsetX, y, z, pose.qx, pose.qy, pose.qz, pose.qw };
     m_hasPose.store(true);
 }
 
 void __fastcall CameraHook::OnCameraUpdate(RED4ext::ent::BaseCameraComponent* aComponent)
 {
-    // 1. Get VR Head Pose
-    float x, y, z, qx, qy, qz, qw;
-    if (g_vrSystem && VRConfig::IsVREnabled() && g_vrSystem->Update(x, y, z, qx, qy, qz, qw)) {
+    // 1. Get VR Head Pose (same snapshot for every camera updated this frame)
+    VRFramePose pose;
+    if (g_vrSystem && VRConfig::IsVREnabled() && g_vrSystem->GetFramePose(pose)) {
 
         // 2. Cast to IPlacedComponent to access Transform
         auto placed = reinterpret_cast<RED4ext::ent::IPlacedComponent*>(aComponent);
 
         // 3. Apply Eye Offset (AER) Logic
-        static ThreadSafe::Counter frameCount{0};
-        uint64_t frame = frameCount.fetch_add(1);
-
         // Get configurable IPD and world scale (thread-safe)
         float ipd = VRConfig::GetIPD();
         float worldScale = VRConfig::GetWorldScale();
 
         // Apply world scale to position
-        x *= worldScale;
-        y *= worldScale;
-        z *= worldScale;
+        float x = pose.x * worldScale;
+        float y = pose.y * worldScale;
+        float z = pose.z * worldScale;
 
         float offsetX = 0.0f;
-        if (frame % 2 == 0) {
+        if (pose.isLeftEye) {
              offsetX = -(ipd / 2.0f);  // Left eye
         } else {
              offsetX = +(ipd / 2.0f);  // Right eye
@@ -271,10 +267,10 @@ void __fastcall CameraHook::OnCameraUpdate(RED4ext::ent::BaseCameraComponent* aC
         placed->worldTransform.Position = RED4ext::WorldPosition(newPos);
 
         // 5. Override Orientation
-        placed->worldTransform.Orientation.i = qx;
-        placed->worldTransform.Orientation.j = qy;
-        placed->worldTransform.Orientation.k = qz;
-        placed->worldTransform.Orientation.r = qw;
+        placed->worldTransform.Orientation.i = pose.qx;
+        placed->worldTransform.Orientation.j = pose.qy;
+        placed->worldTransform.Orientation.k = pose.qz;
+        placed->worldTransform.Orientation.r = pose.qw;
     }
 
     // 6. Call Original
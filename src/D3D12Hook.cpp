@@ -3,6 +3,8 @@
 #include "VRSystem.hpp"
 #include "ThreadSafe.hpp"
 #include "Utils.hpp"
+#include <algorithm>
+#include <vector>
 
 #ifndef WIN32_LEAN_AND_MEAN
 #define WIN32_LEAN_AND_MEAN
@@ -31,21 +33,514 @@ namespace D3D12Hook
     static ComPtr<ID3D12CommandQueue> s_commandQueue;
     static ComPtr<IDXGISwapChain> s_swapChain;
     static ComPtr<ID3D12Device> s_device;
+    static ComPtr<ID3D12CommandQueue> s_presentQueue;   // The game's swapchain queue, from the creation hooks
 
     // Atomic flags for lock-free checks
     static ThreadSafe::Flag s_initialized{false};
     static ThreadSafe::Flag s_resourcesCaptured{false};
     static ThreadSafe::Flag s_shutdownRequested{false};
 
-    // Frame counter (atomic for thread safety)
-    static ThreadSafe::Counter s_frameCount{0};
+    // Game depth buffer candidate, picked from depth-stencil views as they are created
+    static std::mutex s_depthMutex;
+    static ComPtr<ID3D12Resource> s_depthBuffer;
+    static std::atomic<UINT> s_backBufferWidth{0};
+    static std::atomic<UINT> s_backBufferHeight{0};
+
+    // Game motion vector target candidate, picked from render-target views
+    static std::mutex s_motionMutex;
+    static ComPtr<ID3D12Resource> s_motionVectors;
+
+    // Game UI target candidates, with the last render-target view made for each.
+    // The UI target is the candidate the game clears to transparent black last
+    // in a frame, once the same target with the same format and size has been
+    // that for UI_TARGET_STABLE_FRAMES frames in a row. It is then kept until it
+    // goes UI_TARGET_LOST_FRAMES frames without such a clear or stops matching
+    // the back buffer: other transparent clears never switch it
+    struct UiCandidate
+    {
+        ComPtr<ID3D12Resource> resource;
+        SIZE_T rtv = 0;
+        UINT64 width = 0;
+        UINT height = 0;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    };
+    static std::mutex s_uiMutex;
+    static std::vector<UiCandidate> s_uiCandidates;
+    static std::vector<ID3D12Resource*> s_backBuffers;          // Never UI targets (not owned)
+    static UiCandidate s_uiFrameClear;                          // This frame's last transparent clear
+    static UiCandidate s_uiStreak;                              // Last clear of the previous frames...
+    static uint32_t s_uiStreakFrames = 0;                       // ...and for how many in a row
+    static bool s_uiTargetCleared = false;                      // The target was cleared this frame
+    static uint32_t s_uiTargetMissedFrames = 0;
+    static ComPtr<ID3D12Resource> s_uiTarget;
+    static std::atomic<ID3D12Resource*> s_uiTargetRaw{nullptr}; // Checked without the lock per barrier
+    static constexpr size_t MAX_UI_CANDIDATES = 16;
+    static constexpr uint32_t UI_TARGET_STABLE_FRAMES = 60;
+    static constexpr uint32_t UI_TARGET_LOST_FRAMES = 300;
+    static thread_local bool s_inUiCapture = false;             // The capture's own barriers and clear
 
     // Original function pointer (trampoline)
     static HRESULT(STDMETHODCALLTYPE* Real_Present)(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Flags) = nullptr;
+    static HRESULT(STDMETHODCALLTYPE* Real_CreateSwapChain)(IDXGIFactory* pFactory, IUnknown* pDevice,
+                                                           DXGI_SWAP_CHAIN_DESC* pDesc,
+                                                           IDXGISwapChain** ppSwapChain) = nullptr;
+    static HRESULT(STDMETHODCALLTYPE* Real_CreateSwapChainForHwnd)(IDXGIFactory2* pFactory, IUnknown* pDevice, HWND hWnd,
+                                                                  const DXGI_SWAP_CHAIN_DESC1* pDesc,
+                                                                  const DXGI_SWAP_CHAIN_FULLSCREEN_DESC* pFullscreenDesc,
+                                                                  IDXGIOutput* pRestrictToOutput,
+                                                                  IDXGISwapChain1** ppSwapChain) = nullptr;
+    static HRESULT(STDMETHODCALLTYPE* Real_ResizeBuffers)(IDXGISwapChain* pSwapChain, UINT BufferCount, UINT Width,
+                                                         UINT Height, DXGI_FORMAT NewFormat, UINT SwapChainFlags) = nullptr;
+    static void(STDMETHODCALLTYPE* Real_CreateDepthStencilView)(ID3D12Device* pDevice, ID3D12Resource* pResource,
+                                                                const D3D12_DEPTH_STENCIL_VIEW_DESC* pDesc,
+                                                                D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) = nullptr;
+    static void(STDMETHODCALLTYPE* Real_CreateRenderTargetView)(ID3D12Device* pDevice, ID3D12Resource* pResource,
+                                                                const D3D12_RENDER_TARGET_VIEW_DESC* pDesc,
+                                                                D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) = nullptr;
+    static void(STDMETHODCALLTYPE* Real_ExecuteCommandLists)(ID3D12CommandQueue* pQueue, UINT NumCommandLists,
+                                                             ID3D12CommandList* const* ppCommandLists) = nullptr;
+    static void(STDMETHODCALLTYPE* Real_ResourceBarrier)(ID3D12GraphicsCommandList* pCommandList, UINT NumBarriers,
+                                                         const D3D12_RESOURCE_BARRIER* pBarriers) = nullptr;
+    static void(STDMETHODCALLTYPE* Real_ClearRenderTargetView)(ID3D12GraphicsCommandList* pCommandList,
+                                                               D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView,
+                                                               const FLOAT ColorRGBA[4], UINT NumRects,
+                                                               const D3D12_RECT* pRects) = nullptr;
 
     // Callback
     static OnReadyCallback s_onReadyCallback = nullptr;
 
+    // Only single-sample 2D D32 depth (with or without stencil) can be copied
+    // into the VR depth swapchain
+    static bool IsDepthCandidate(const D3D12_RESOURCE_DESC& desc)
+    {
+        if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || desc.DepthOrArraySize != 1 ||
+            desc.SampleDesc.Count != 1)
+        {
+            return false;
+        }
+
+        switch (desc.Format)
+        {
+        case DXGI_FORMAT_D32_FLOAT:
+        case DXGI_FORMAT_R32_TYPELESS:
+        case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+        case DXGI_FORMAT_R32G8X24_TYPELESS:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // The scene depth buffer is the one matching the back buffer; until the back
+    // buffer size is known (or if nothing matches) the largest candidate wins
+    static void ConsiderDepthBuffer(ID3D12Resource* resource)
+    {
+        ThreadSafe::Lock lock(s_depthMutex);
+        if (resource == s_depthBuffer.Get())
+        {
+            return;
+        }
+
+        D3D12_RESOURCE_DESC desc = resource->GetDesc();
+        if (!IsDepthCandidate(desc))
+        {
+            return;
+        }
+
+        UINT width = s_backBufferWidth.load();
+        UINT height = s_backBufferHeight.load();
+        auto matchesBackBuffer = [&](const D3D12_RESOURCE_DESC& d) {
+            return d.Width == width && d.Height == height;
+        };
+
+        bool replace = !s_depthBuffer;
+        if (!replace)
+        {
+            D3D12_RESOURCE_DESC current = s_depthBuffer->GetDesc();
+            replace = matchesBackBuffer(desc) ||
+                      (!matchesBackBuffer(current) && desc.Width * desc.Height >= current.Width * current.Height);
+        }
+
+        if (replace)
+        {
+            s_depthBuffer = resource;
+
+            char msg[128];
+            snprintf(msg, sizeof(msg), "D3D12Hook: Depth buffer candidate %llux%u (format %d)",
+                     static_cast<unsigned long long>(desc.Width), desc.Height, static_cast<int>(desc.Format));
+            Utils::LogInfo(msg);
+        }
+    }
+
+    static void STDMETHODCALLTYPE Hook_CreateDepthStencilView(ID3D12Device* pDevice, ID3D12Resource* pResource,
+                                                              const D3D12_DEPTH_STENCIL_VIEW_DESC* pDesc,
+                                                              D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+    {
+        // Always: depth may be switched on after the game made its views
+        if (pResource && !s_shutdownRequested.load())
+        {
+            ConsiderDepthBuffer(pResource);
+        }
+
+        if (Real_CreateDepthStencilView)
+        {
+            Real_CreateDepthStencilView(pDevice, pResource, pDesc, DestDescriptor);
+        }
+    }
+
+    // TAA motion vectors are a two-channel FP16 target at render resolution
+    static bool IsMotionVectorCandidate(const D3D12_RESOURCE_DESC& desc)
+    {
+        if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || desc.DepthOrArraySize != 1 ||
+            desc.SampleDesc.Count != 1)
+        {
+            return false;
+        }
+
+        return desc.Format == DXGI_FORMAT_R16G16_FLOAT || desc.Format == DXGI_FORMAT_R16G16_TYPELESS;
+    }
+
+    // Once the back buffer size is known only targets matching it are considered;
+    // the most recently created one wins, as the TAA targets follow the G-buffer
+    static void ConsiderMotionVectors(ID3D12Resource* resource)
+    {
+        D3D12_RESOURCE_DESC desc = resource->GetDesc();
+        if (!IsMotionVectorCandidate(desc))
+        {
+            return;
+        }
+
+        UINT width = s_backBufferWidth.load();
+        if (width != 0 && (desc.Width != width || desc.Height != s_backBufferHeight.load()))
+        {
+            return;
+        }
+
+        ThreadSafe::Lock lock(s_motionMutex);
+        if (resource == s_motionVectors.Get())
+        {
+            return;
+        }
+
+        s_motionVectors = resource;
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "D3D12Hook: Motion vector candidate %llux%u (format %d)",
+                 static_cast<unsigned long long>(desc.Width), desc.Height, static_cast<int>(desc.Format));
+        Utils::LogInfo(msg);
+    }
+
+    // UI is drawn into an 8-bit target with alpha, the size of the back buffer
+    static bool IsUiCandidate(const D3D12_RESOURCE_DESC& desc)
+    {
+        if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || desc.DepthOrArraySize != 1 ||
+            desc.MipLevels != 1 || desc.SampleDesc.Count != 1)
+        {
+            return false;
+        }
+
+        switch (desc.Format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // Remember which view writes which candidate; a view slot reused for
+    // another resource no longer points at the old one
+    static void ConsiderUiTarget(ID3D12Resource* resource, D3D12_CPU_DESCRIPTOR_HANDLE rtv)
+    {
+        D3D12_RESOURCE_DESC desc = resource->GetDesc();
+        UINT width = s_backBufferWidth.load();
+        bool candidate = IsUiCandidate(desc) && width != 0 && desc.Width == width &&
+                         desc.Height == s_backBufferHeight.load();
+
+        ThreadSafe::Lock lock(s_uiMutex);
+        bool known = false;
+        for (UiCandidate& entry : s_uiCandidates)
+        {
+            if (entry.resource.Get() == resource)
+            {
+                entry.rtv = rtv.ptr;
+                known = true;
+            }
+            else if (entry.rtv == rtv.ptr)
+            {
+                entry.rtv = 0;
+            }
+        }
+        if (known || !candidate || s_uiCandidates.size() >= MAX_UI_CANDIDATES ||
+            std::find(s_backBuffers.begin(), s_backBuffers.end(), resource) != s_backBuffers.end())
+        {
+            return;
+        }
+
+        s_uiCandidates.push_back({ resource, rtv.ptr, desc.Width, desc.Height, desc.Format });
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "D3D12Hook: UI target candidate %zu: %llux%u (format %d)", s_uiCandidates.size() - 1,
+                 static_cast<unsigned long long>(desc.Width), desc.Height, static_cast<int>(desc.Format));
+        Utils::LogInfo(msg);
+    }
+
+    // The game starts its UI pass by clearing the UI target to transparent black;
+    // scene targets are overwritten or cleared opaque. G-buffer, bloom or mask
+    // targets may be cleared the same way, so a clear is only noted here and
+    // the target is chosen per frame (see UpdateUiTarget)
+    static void NoteUiClear(D3D12_CPU_DESCRIPTOR_HANDLE rtv)
+    {
+        ThreadSafe::Lock lock(s_uiMutex);
+        for (const UiCandidate& entry : s_uiCandidates)
+        {
+            if (entry.rtv != rtv.ptr)
+            {
+                continue;
+            }
+            s_uiFrameClear = entry;
+            if (entry.resource.Get() == s_uiTarget.Get())
+            {
+                s_uiTargetCleared = true;
+            }
+            return;
+        }
+    }
+
+    static bool IsSameUiSignature(const UiCandidate& a, const UiCandidate& b)
+    {
+        return a.resource.Get() == b.resource.Get() && a.width == b.width && a.height == b.height &&
+               a.format == b.format;
+    }
+
+    static void SetUiTarget(const ComPtr<ID3D12Resource>& target, const char* reason)
+    {
+        s_uiTarget = target;
+        s_uiTargetRaw.store(target.Get());
+        s_uiTargetMissedFrames = 0;
+        Utils::LogInfo(reason);
+    }
+
+    // Once per Present: drop the swapchain's own back buffers (their views are
+    // created and cleared like any other render target), then keep, drop or
+    // pick the UI target from this frame's clears. Returns the target
+    static ComPtr<ID3D12Resource> UpdateUiTarget(ID3D12Resource* backBuffer)
+    {
+        ThreadSafe::Lock lock(s_uiMutex);
+        if (std::find(s_backBuffers.begin(), s_backBuffers.end(), backBuffer) == s_backBuffers.end())
+        {
+            s_backBuffers.push_back(backBuffer);
+        }
+
+        auto isBackBuffer = [&](const UiCandidate& entry) { return entry.resource.Get() == backBuffer; };
+        s_uiCandidates.erase(std::remove_if(s_uiCandidates.begin(), s_uiCandidates.end(), isBackBuffer),
+                             s_uiCandidates.end());
+
+        UiCandidate frameClear = std::move(s_uiFrameClear);
+        s_uiFrameClear = UiCandidate();
+        bool targetCleared = s_uiTargetCleared;
+        s_uiTargetCleared = false;
+
+        bool matchesBackBuffer = frameClear.resource && frameClear.resource.Get() != backBuffer &&
+                                 frameClear.width == s_backBufferWidth.load() &&
+                                 frameClear.height == s_backBufferHeight.load();
+        if (matchesBackBuffer && IsSameUiSignature(frameClear, s_uiStreak))
+        {
+            s_uiStreakFrames++;
+        }
+        else
+        {
+            s_uiStreak = matchesBackBuffer ? frameClear : UiCandidate();
+            s_uiStreakFrames = matchesBackBuffer ? 1 : 0;
+        }
+
+        if (s_uiTarget)
+        {
+            D3D12_RESOURCE_DESC desc = s_uiTarget->GetDesc();
+            s_uiTargetMissedFrames = targetCleared ? 0 : s_uiTargetMissedFrames + 1;
+            if (s_uiTarget.Get() == backBuffer || desc.Width != s_backBufferWidth.load() ||
+                desc.Height != s_backBufferHeight.load() || s_uiTargetMissedFrames >= UI_TARGET_LOST_FRAMES)
+            {
+                SetUiTarget(nullptr, "D3D12Hook: UI target lost");
+            }
+        }
+
+        if (!s_uiTarget && s_uiStreakFrames >= UI_TARGET_STABLE_FRAMES)
+        {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "D3D12Hook: UI target %llux%u (format %d)",
+                     static_cast<unsigned long long>(s_uiStreak.width), s_uiStreak.height,
+                     static_cast<int>(s_uiStreak.format));
+            SetUiTarget(s_uiStreak.resource, msg);
+        }
+        return s_uiTarget;
+    }
+
+    static void ResetUiCandidates()
+    {
+        ThreadSafe::Lock lock(s_uiMutex);
+        s_uiCandidates.clear();
+        s_backBuffers.clear();
+        s_uiFrameClear = UiCandidate();
+        s_uiStreak = UiCandidate();
+        s_uiStreakFrames = 0;
+        s_uiTargetCleared = false;
+        s_uiTarget.Reset();
+        s_uiTargetRaw.store(nullptr);
+    }
+
+    static void STDMETHODCALLTYPE Hook_CreateRenderTargetView(ID3D12Device* pDevice, ID3D12Resource* pResource,
+                                                              const D3D12_RENDER_TARGET_VIEW_DESC* pDesc,
+                                                              D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
+    {
+        if (pResource && !s_shutdownRequested.load())
+        {
+            // Always: space warp and the UI layer may be switched on after
+            // the game made its views
+            ConsiderMotionVectors(pResource);
+            ConsiderUiTarget(pResource, DestDescriptor);
+        }
+
+        if (Real_CreateRenderTargetView)
+        {
+            Real_CreateRenderTargetView(pDevice, pResource, pDesc, DestDescriptor);
+        }
+    }
+
+    static void STDMETHODCALLTYPE Hook_ClearRenderTargetView(ID3D12GraphicsCommandList* pCommandList,
+                                                             D3D12_CPU_DESCRIPTOR_HANDLE RenderTargetView,
+                                                             const FLOAT ColorRGBA[4], UINT NumRects,
+                                                             const D3D12_RECT* pRects)
+    {
+        if (ColorRGBA && !s_inUiCapture && !s_shutdownRequested.load() && VRConfig::IsUILayer() &&
+            ColorRGBA[0] == 0.0f && ColorRGBA[1] == 0.0f && ColorRGBA[2] == 0.0f && ColorRGBA[3] == 0.0f)
+        {
+            NoteUiClear(RenderTargetView);
+        }
+
+        if (Real_ClearRenderTargetView)
+        {
+            Real_ClearRenderTargetView(pCommandList, RenderTargetView, ColorRGBA, NumRects, pRects);
+        }
+    }
+
+    // Shader-read states the final composite samples the UI target in
+    static bool IsShaderReadState(D3D12_RESOURCE_STATES state)
+    {
+        constexpr uint32_t SHADER_READ = static_cast<uint32_t>(D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE) |
+                                         static_cast<uint32_t>(D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+        uint32_t bits = static_cast<uint32_t>(state);
+        return bits != 0 && (bits & ~SHADER_READ) == 0;
+    }
+
+    // The UI pass ends with the UI target leaving RENDER_TARGET for a shader
+    // read: that is where the VR system takes the UI out of the game's frame
+    static void STDMETHODCALLTYPE Hook_ResourceBarrier(ID3D12GraphicsCommandList* pCommandList, UINT NumBarriers,
+                                                       const D3D12_RESOURCE_BARRIER* pBarriers)
+    {
+        if (Real_ResourceBarrier)
+        {
+            Real_ResourceBarrier(pCommandList, NumBarriers, pBarriers);
+        }
+
+        ID3D12Resource* uiTarget = s_uiTargetRaw.load(std::memory_order_relaxed);
+        if (!uiTarget || !pBarriers || s_inUiCapture || s_shutdownRequested.load())
+        {
+            return;
+        }
+
+        for (UINT i = 0; i < NumBarriers; i++)
+        {
+            const D3D12_RESOURCE_BARRIER& barrier = pBarriers[i];
+            if (barrier.Type != D3D12_RESOURCE_BARRIER_TYPE_TRANSITION ||
+                barrier.Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY || barrier.Transition.pResource != uiTarget ||
+                !(barrier.Transition.StateBefore & D3D12_RESOURCE_STATE_RENDER_TARGET) ||
+                !IsShaderReadState(barrier.Transition.StateAfter))
+            {
+                continue;
+            }
+
+            if (g_vrSystem)
+            {
+                s_inUiCapture = true;
+                g_vrSystem->CaptureUi(pCommandList, uiTarget, static_cast<uint32_t>(barrier.Transition.StateAfter));
+                s_inUiCapture = false;
+            }
+            return;
+        }
+    }
+
+    // With D3D12 the swapchain's "device" is the queue it presents on: the
+    // game's frame is timed there
+    static void NotePresentQueue(IUnknown* pDevice)
+    {
+        ComPtr<ID3D12CommandQueue> queue;
+        if (!pDevice || FAILED(pDevice->QueryInterface(IID_PPV_ARGS(&queue))))
+        {
+            return;
+        }
+
+        {
+            ThreadSafe::Lock lock(s_stateMutex);
+            s_presentQueue = queue;
+        }
+        if (g_vrSystem)
+        {
+            g_vrSystem->SetPresentQueue(queue.Get());
+        }
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "D3D12Hook: Game presents on queue 0x%p", queue.Get());
+        Utils::LogInfo(msg);
+    }
+
+    static HRESULT STDMETHODCALLTYPE Hook_CreateSwapChain(IDXGIFactory* pFactory, IUnknown* pDevice,
+                                                          DXGI_SWAP_CHAIN_DESC* pDesc, IDXGISwapChain** ppSwapChain)
+    {
+        HRESULT hr = Real_CreateSwapChain ? Real_CreateSwapChain(pFactory, pDevice, pDesc, ppSwapChain) : E_FAIL;
+        if (SUCCEEDED(hr))
+        {
+            NotePresentQueue(pDevice);
+        }
+        return hr;
+    }
+
+    static HRESULT STDMETHODCALLTYPE Hook_CreateSwapChainForHwnd(IDXGIFactory2* pFactory, IUnknown* pDevice, HWND hWnd,
+                                                                 const DXGI_SWAP_CHAIN_DESC1* pDesc,
+                                                                 const DXGI_SWAP_CHAIN_FULLSCREEN_DESC* pFullscreenDesc,
+                                                                 IDXGIOutput* pRestrictToOutput,
+                                                                 IDXGISwapChain1** ppSwapChain)
+    {
+        HRESULT hr = Real_CreateSwapChainForHwnd
+            ? Real_CreateSwapChainForHwnd(pFactory, pDevice, hWnd, pDesc, pFullscreenDesc, pRestrictToOutput, ppSwapChain)
+            : E_FAIL;
+        if (SUCCEEDED(hr))
+        {
+            NotePresentQueue(pDevice);
+        }
+        return hr;
+    }
+
+    // The game's first submission after a Present starts that frame's GPU time
+    static void STDMETHODCALLTYPE Hook_ExecuteCommandLists(ID3D12CommandQueue* pQueue, UINT NumCommandLists,
+                                                           ID3D12CommandList* const* ppCommandLists)
+    {
+        if (g_vrSystem && !s_shutdownRequested.load())
+        {
+            g_vrSystem->OnQueueSubmit(pQueue);
+        }
+
+        if (Real_ExecuteCommandLists)
+        {
+            Real_ExecuteCommandLists(pQueue, NumCommandLists, ppCommandLists);
+        }
+    }
+
     // Our hook function
     static HRESULT STDMETHODCALLTYPE Hook_Present(IDXGISwapChain* pSwapChain, UINT SyncInterval, UINT Flags)
     {
@@ -97,10 +592,22 @@ namespace D3D12Hook
                                      s_device.Get(), s_commandQueue.Get());
                             Utils::LogInfo(msg);
 
-                            // Initialize VR system with the command queue (thread-safe)
+                            // Session, swapchains and copy resources are built on a worker
+                            // thread; frames pass through untouched until IsReady()
                             if (g_vrSystem)
                             {
-                                g_vrSystem->Initialize(s_commandQueue.Get());
+                                DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
+                                pSwapChain->GetDesc(&swapChainDesc);
+                                g_vrSystem->InitializeAsync(s_commandQueue.Get(),
+                                                            static_cast<uint32_t>(swapChainDesc.BufferDesc.Format));
+                                if (s_presentQueue)
+                                {
+                                    g_vrSystem->SetPresentQueue(s_presentQueue.Get());
+                                }
+                                else
+                                {
+                                    Utils::LogWarn("D3D12Hook: Swapchain created before the hooks - game queue unknown");
+                                }
                             }
 
                             // Notify callback
@@ -123,7 +630,7 @@ namespace D3D12Hook
         }
 
         // VR Frame Submission (only if resources captured and VR system ready)
-        if (s_resourcesCaptured.load() && g_vrSystem && VRConfig::IsVREnabled())
+        if (s_resourcesCaptured.load() && g_vrSystem && g_vrSystem->IsReady() && VRConfig::IsVREnabled())
         {
             ComPtr<IDXGISwapChain3> swapChain3;
             if (SUCCEEDED(pSwapChain->QueryInterface(IID_PPV_ARGS(&swapChain3))))
@@ -133,11 +640,30 @@ namespace D3D12Hook
                 ComPtr<ID3D12Resource> currentBackBuffer;
                 if (SUCCEEDED(swapChain3->GetBuffer(bufferIndex, IID_PPV_ARGS(&currentBackBuffer))))
                 {
-                    // Alternate eye rendering (atomic increment)
-                    uint64_t frame = s_frameCount.fetch_add(1);
-                    bool isLeftEye = (frame % 2) == 0;
+                    D3D12_RESOURCE_DESC backBufferDesc = currentBackBuffer->GetDesc();
+                    s_backBufferWidth.store(static_cast<UINT>(backBufferDesc.Width));
+                    s_backBufferHeight.store(backBufferDesc.Height);
 
-                    g_vrSystem->SubmitFrame(currentBackBuffer.Get(), isLeftEye);
+                    ComPtr<ID3D12Resource> depthBuffer;
+                    {
+                        ThreadSafe::Lock lock(s_depthMutex);
+                        depthBuffer = s_depthBuffer;
+                    }
+
+                    ComPtr<ID3D12Resource> motionVectors;
+                    {
+                        ThreadSafe::Lock lock(s_motionMutex);
+                        motionVectors = s_motionVectors;
+                    }
+
+                    // UI goes out as its own layer (taken out of the frame by the
+                    // barrier hook); refreshed only when it changes
+                    ComPtr<ID3D12Resource> uiTarget = UpdateUiTarget(currentBackBuffer.Get());
+                    g_vrSystem->SubmitUI(uiTarget.Get());
+
+                    // Alternate eye rendering: VRSystem owns the frame parity
+                    g_vrSystem->SubmitFrame(currentBackBuffer.Get(), bufferIndex, depthBuffer.Get(),
+                                            motionVectors.Get());
                     // ComPtr automatically releases currentBackBuffer
                 }
             }
@@ -147,6 +673,35 @@ namespace D3D12Hook
         return Real_Present ? Real_Present(pSwapChain, SyncInterval, Flags) : E_FAIL;
     }
 
+    // Back buffers are about to be destroyed: drop anything recorded against them
+    static HRESULT STDMETHODCALLTYPE Hook_ResizeBuffers(IDXGISwapChain* pSwapChain, UINT BufferCount, UINT Width,
+                                                         UINT Height, DXGI_FORMAT NewFormat, UINT SwapChainFlags)
+    {
+        if (g_vrSystem)
+        {
+            g_vrSystem->InvalidateBackBuffers();
+        }
+
+        // The game recreates its depth buffer at the new size; pick it up fresh
+        {
+            ThreadSafe::Lock lock(s_depthMutex);
+            s_depthBuffer.Reset();
+        }
+        {
+            ThreadSafe::Lock lock(s_motionMutex);
+            s_motionVectors.Reset();
+        }
+        ResetUiCandidates();
+        if (Width != 0 && Height != 0)
+        {
+            s_backBufferWidth.store(Width);
+            s_backBufferHeight.store(Height);
+        }
+
+        return Real_ResizeBuffers ? Real_ResizeBuffers(pSwapChain, BufferCount, Width, Height, NewFormat, SwapChainFlags)
+                                  : E_FAIL;
+    }
+
     bool Initialize()
     {
         if (s_initialized.load())
@@ -252,11 +807,48 @@ namespace D3D12Hook
             return false;
         }
 
-        // Get vtable pointer for Present
-        // IDXGISwapChain vtable layout: QueryInterface(0), AddRef(1), Release(2), ..., Present(8)
+        // Get vtable pointers for Present and ResizeBuffers
+        // IDXGISwapChain vtable layout: QueryInterface(0), AddRef(1), Release(2), ..., Present(8), ..., ResizeBuffers(13)
         constexpr int PRESENT_VTABLE_INDEX = 8;
+        constexpr int RESIZE_BUFFERS_VTABLE_INDEX = 13;
         void** vtable = *reinterpret_cast<void***>(tempSwapChain.Get());
         void* presentAddr = vtable[PRESENT_VTABLE_INDEX];
+        void* resizeBuffersAddr = vtable[RESIZE_BUFFERS_VTABLE_INDEX];
+
+        // ID3D12Device vtable layout: ..., CreateRenderTargetView(20), CreateDepthStencilView(21)
+        constexpr int CREATE_RTV_VTABLE_INDEX = 20;
+        constexpr int CREATE_DSV_VTABLE_INDEX = 21;
+        void** deviceVtable = *reinterpret_cast<void***>(tempDevice.Get());
+        void* createRtvAddr = deviceVtable[CREATE_RTV_VTABLE_INDEX];
+        void* createDsvAddr = deviceVtable[CREATE_DSV_VTABLE_INDEX];
+
+        // IDXGIFactory vtable layout: ..., CreateSwapChain(10); IDXGIFactory2: ..., CreateSwapChainForHwnd(15)
+        constexpr int CREATE_SWAP_CHAIN_VTABLE_INDEX = 10;
+        constexpr int CREATE_SWAP_CHAIN_FOR_HWND_VTABLE_INDEX = 15;
+        void** factoryVtable = *reinterpret_cast<void***>(factory.Get());
+        void* createSwapChainAddr = factoryVtable[CREATE_SWAP_CHAIN_VTABLE_INDEX];
+        void* createSwapChainForHwndAddr = factoryVtable[CREATE_SWAP_CHAIN_FOR_HWND_VTABLE_INDEX];
+
+        // ID3D12CommandQueue vtable layout: ..., ExecuteCommandLists(10)
+        constexpr int EXECUTE_COMMAND_LISTS_VTABLE_INDEX = 10;
+        void** queueVtable = *reinterpret_cast<void***>(tempQueue.Get());
+        void* executeCommandListsAddr = queueVtable[EXECUTE_COMMAND_LISTS_VTABLE_INDEX];
+
+        // ID3D12GraphicsCommandList vtable layout: ..., ResourceBarrier(26), ..., ClearRenderTargetView(48)
+        constexpr int RESOURCE_BARRIER_VTABLE_INDEX = 26;
+        constexpr int CLEAR_RTV_VTABLE_INDEX = 48;
+        void* resourceBarrierAddr = nullptr;
+        void* clearRtvAddr = nullptr;
+        ComPtr<ID3D12CommandAllocator> tempAllocator;
+        ComPtr<ID3D12GraphicsCommandList> tempList;
+        if (SUCCEEDED(tempDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&tempAllocator))) &&
+            SUCCEEDED(tempDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, tempAllocator.Get(), nullptr,
+                                                    IID_PPV_ARGS(&tempList))))
+        {
+            void** listVtable = *reinterpret_cast<void***>(tempList.Get());
+            resourceBarrierAddr = listVtable[RESOURCE_BARRIER_VTABLE_INDEX];
+            clearRtvAddr = listVtable[CLEAR_RTV_VTABLE_INDEX];
+        }
 
         char msg[128];
         snprintf(msg, sizeof(msg), "D3D12Hook: Present vtable address: 0x%p", presentAddr);
@@ -266,6 +858,8 @@ namespace D3D12Hook
         tempSwapChain.Reset();
         DestroyWindow(tempWindow);
         UnregisterClassW(wc.lpszClassName, wc.hInstance);
+        tempList.Reset();
+        tempAllocator.Reset();
         tempQueue.Reset();
         tempDevice.Reset();
 
@@ -277,17 +871,91 @@ namespace D3D12Hook
             reinterpret_cast<void**>(&Real_Present)
         );
 
-        if (success)
-        {
-            s_initialized.store(true);
-            Utils::LogInfo("D3D12Hook: Present hook installed successfully!");
-            return true;
-        }
-        else
+        if (!success)
         {
             Utils::LogError("D3D12Hook: Failed to install Present hook");
             return false;
         }
+
+        Utils::LogInfo("D3D12Hook: Present hook installed successfully!");
+
+        // ResizeBuffers hook is optional: without it the VR copy cache falls
+        // back to detecting recreated back buffers by pointer
+        if (!g_sdk->hooking->Attach(
+            g_pluginHandle,
+            resizeBuffersAddr,
+            reinterpret_cast<void*>(&Hook_ResizeBuffers),
+            reinterpret_cast<void**>(&Real_ResizeBuffers)))
+        {
+            Utils::LogWarn("D3D12Hook: Failed to install ResizeBuffers hook");
+        }
+
+        // CreateDepthStencilView hook is optional: without it no depth layer is submitted
+        if (!g_sdk->hooking->Attach(
+            g_pluginHandle,
+            createDsvAddr,
+            reinterpret_cast<void*>(&Hook_CreateDepthStencilView),
+            reinterpret_cast<void**>(&Real_CreateDepthStencilView)))
+        {
+            Utils::LogWarn("D3D12Hook: Failed to install CreateDepthStencilView hook");
+        }
+
+        // CreateRenderTargetView hook is optional: without it no motion vectors reach space warp
+        if (!g_sdk->hooking->Attach(
+            g_pluginHandle,
+            createRtvAddr,
+            reinterpret_cast<void*>(&Hook_CreateRenderTargetView),
+            reinterpret_cast<void**>(&Real_CreateRenderTargetView)))
+        {
+            Utils::LogWarn("D3D12Hook: Failed to install CreateRenderTargetView hook");
+        }
+
+        // Swapchain creation hooks are optional: without them the game's queue is
+        // unknown, its GPU time is not measured and the UI layer is unavailable
+        if (!g_sdk->hooking->Attach(
+                g_pluginHandle,
+                createSwapChainAddr,
+                reinterpret_cast<void*>(&Hook_CreateSwapChain),
+                reinterpret_cast<void**>(&Real_CreateSwapChain)) ||
+            !g_sdk->hooking->Attach(
+                g_pluginHandle,
+                createSwapChainForHwndAddr,
+                reinterpret_cast<void*>(&Hook_CreateSwapChainForHwnd),
+                reinterpret_cast<void**>(&Real_CreateSwapChainForHwnd)))
+        {
+            Utils::LogWarn("D3D12Hook: Failed to install swapchain creation hooks");
+        }
+
+        // ExecuteCommandLists hook is optional: without it the game's GPU time is
+        // not measured and the GPU performance level only follows runtime notifications
+        if (!g_sdk->hooking->Attach(
+            g_pluginHandle,
+            executeCommandListsAddr,
+            reinterpret_cast<void*>(&Hook_ExecuteCommandLists),
+            reinterpret_cast<void**>(&Real_ExecuteCommandLists)))
+        {
+            Utils::LogWarn("D3D12Hook: Failed to install ExecuteCommandLists hook");
+        }
+
+        // Command list hooks are optional: without them the UI stays in the eye
+        // images and no UI layer is shown
+        if (!resourceBarrierAddr || !clearRtvAddr ||
+            !g_sdk->hooking->Attach(
+                g_pluginHandle,
+                clearRtvAddr,
+                reinterpret_cast<void*>(&Hook_ClearRenderTargetView),
+                reinterpret_cast<void**>(&Real_ClearRenderTargetView)) ||
+            !g_sdk->hooking->Attach(
+                g_pluginHandle,
+                resourceBarrierAddr,
+                reinterpret_cast<void*>(&Hook_ResourceBarrier),
+                reinterpret_cast<void**>(&Real_ResourceBarrier)))
+        {
+            Utils::LogWarn("D3D12Hook: Failed to install command list hooks - UI layer unavailable");
+        }
+
+        s_initialized.store(true);
+        return true;
     }
 
     void Shutdown()
@@ -311,11 +979,21 @@ namespace D3D12Hook
 
             // ComPtr handles Release automatically
             s_commandQueue.Reset();
+            s_presentQueue.Reset();
             s_swapChain.Reset();
             s_device.Reset();
 
             s_resourcesCaptured.store(false);
         }
+        {
+            ThreadSafe::Lock lock(s_depthMutex);
+            s_depthBuffer.Reset();
+        }
+        {
+            ThreadSafe::Lock lock(s_motionMutex);
+            s_motionVectors.Reset();
+        }
+        ResetUiCandidates();
 
         s_initialized.store(false);
         Utils::LogInfo("D3D12Hook: Shutdown complete");
@@ -0,0 +1,241 @@
+#include "GpuTimer.hpp"
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+
+bool GpuTimer::Create(ID3D12Device* device)
+{
+    if (!device)
+    {
+        return false;
+    }
+
+    D3D12_QUERY_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    heapDesc.Count = 2 * SLOTS;
+
+    D3D12_HEAP_PROPERTIES readbackHeap = { D3D12_HEAP_TYPE_READBACK };
+    D3D12_RESOURCE_DESC readbackDesc = {};
+    readbackDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    readbackDesc.Width = 2 * SLOTS * sizeof(UINT64);
+    readbackDesc.Height = 1;
+    readbackDesc.DepthOrArraySize = 1;
+    readbackDesc.MipLevels = 1;
+    readbackDesc.SampleDesc.Count = 1;
+    readbackDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    if (FAILED(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&m_heap))) ||
+        FAILED(device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &readbackDesc,
+                                               D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_readback))) ||
+        FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence))) ||
+        FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_allocator))))
+    {
+        Destroy();
+        return false;
+    }
+
+    for (uint32_t slot = 0; slot < SLOTS; slot++)
+    {
+        SlotLists& lists = m_lists[slot];
+        if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_allocator.Get(), nullptr,
+                                             IID_PPV_ARGS(&lists.start))) ||
+            FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_allocator.Get(), nullptr,
+                                             IID_PPV_ARGS(&lists.end))))
+        {
+            Destroy();
+            return false;
+        }
+
+        lists.start->EndQuery(m_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot);
+        lists.end->EndQuery(m_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot + 1);
+        lists.end->ResolveQueryData(m_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 2 * slot, 2, m_readback.Get(),
+                                    2 * slot * sizeof(UINT64));
+        if (FAILED(lists.start->Close()) || FAILED(lists.end->Close()))
+        {
+            Destroy();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Nothing of the timer's may be left on its queue (see Drain)
+void GpuTimer::Destroy()
+{
+    ThreadSafe::Lock lock(m_mutex);
+    for (SlotLists& lists : m_lists)
+    {
+        lists = SlotLists();
+    }
+    m_allocator.Reset();
+    m_fence.Reset();
+    m_readback.Reset();
+    m_heap.Reset();
+    m_queue.Reset();
+    m_queueRaw.store(nullptr);
+    m_open.store(false);
+    m_spans = 0;
+    m_read = 0;
+}
+
+void GpuTimer::SetQueue(ID3D12CommandQueue* queue, uint32_t timeoutMs)
+{
+    ThreadSafe::Lock lock(m_mutex);
+    if (queue == m_queue.Get())
+    {
+        return;
+    }
+
+    DrainLocked(timeoutMs);
+    m_queue.Reset();
+    m_queueRaw.store(nullptr);
+
+    UINT64 frequency = 0;
+    if (!queue || FAILED(queue->GetTimestampFrequency(&frequency)) || frequency == 0)
+    {
+        return;
+    }
+    m_queue = queue;
+    m_frequency = frequency;
+    m_queueRaw.store(queue);
+}
+
+void GpuTimer::Begin()
+{
+    if (m_open.load())
+    {
+        return;
+    }
+
+    ThreadSafe::Lock lock(m_mutex);
+    if (m_open.load() || !m_queue || !m_heap || m_spans - m_read >= SLOTS)
+    {
+        return;
+    }
+
+    // Opened first: the timestamp's own submission may come back through a hook
+    m_open.store(true);
+    ID3D12CommandList* lists[] = { m_lists[m_spans % SLOTS].start.Get() };
+    m_queue->ExecuteCommandLists(1, lists);
+}
+
+void GpuTimer::End()
+{
+    if (!m_open.load())
+    {
+        return;
+    }
+
+    ThreadSafe::Lock lock(m_mutex);
+    if (!m_open.load())
+    {
+        return;
+    }
+
+    // Still open while queued, so a hook does not take it for a new span
+    ID3D12CommandList* lists[] = { m_lists[m_spans % SLOTS].end.Get() };
+    m_queue->ExecuteCommandLists(1, lists);
+    m_spans++;
+    m_queue->Signal(m_fence.Get(), m_spans);
+    m_open.store(false);
+}
+
+bool GpuTimer::Read(double& averageSeconds)
+{
+    ThreadSafe::Lock lock(m_mutex);
+    if (!m_queue)
+    {
+        return false;
+    }
+
+    UINT64 completed = std::min(m_fence->GetCompletedValue(), m_spans);
+    if (completed <= m_read)
+    {
+        return false;
+    }
+
+    UINT64* ticks = nullptr;
+    D3D12_RANGE readRange = { 0, 2 * SLOTS * sizeof(UINT64) };
+    if (FAILED(m_readback->Map(0, &readRange, reinterpret_cast<void**>(&ticks))))
+    {
+        return false;
+    }
+
+    double seconds = 0.0;
+    uint32_t spans = 0;
+    for (; m_read < completed; m_read++)
+    {
+        uint32_t slot = static_cast<uint32_t>(m_read % SLOTS);
+        UINT64 start = ticks[2 * slot];
+        UINT64 end = ticks[2 * slot + 1];
+        if (end > start)
+        {
+            seconds += static_cast<double>(end - start) / static_cast<double>(m_frequency);
+            spans++;
+        }
+    }
+    D3D12_RANGE writeRange = { 0, 0 };
+    m_readback->Unmap(0, &writeRange);
+
+    if (spans == 0)
+    {
+        return false;
+    }
+    averageSeconds = seconds / spans;
+    return true;
+}
+
+bool GpuTimer::Drain(uint32_t timeoutMs)
+{
+    ThreadSafe::Lock lock(m_mutex);
+    return DrainLocked(timeoutMs);
+}
+
+bool GpuTimer::DrainLocked(uint32_t timeoutMs)
+{
+    if (!m_queue)
+    {
+        return true;
+    }
+
+    // An open span's start has no value of its own yet
+    if (m_open.load())
+    {
+        m_spans++;
+        m_queue->Signal(m_fence.Get(), m_spans);
+        m_open.store(false);
+    }
+    m_read = m_spans;
+
+    if (m_fence->GetCompletedValue() >= m_spans)
+    {
+        return true;
+    }
+
+    HANDLE event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    bool done = event && SUCCEEDED(m_fence->SetEventOnCompletion(m_spans, event)) &&
+                WaitForSingleObject(event, timeoutMs) == WAIT_OBJECT_0;
+    if (event)
+    {
+        CloseHandle(event);
+    }
+
+    if (!done)
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "D3D12: Wait for the GPU timer's queue timed out (%llu spans)",
+                 static_cast<unsigned long long>(m_spans));
+        Utils::LogWarn(msg);
+    }
+    return done;
+}
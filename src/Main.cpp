@@ -50,10 +50,9 @@ RED4EXT_C_EXPORT bool RED4EXT_CALL Main(RED4ext::PluginHandle aHandle, RED4ext::
         // 2. Initialize VR System (OpenXR)
         g_vrSystem = std::make_unique<VRSystem>();
         // Note: passing nullptr for queue now, will hook later
-        if (!g_vrSystem->Initialize(nullptr)) {
-            Utils::LogError("Failed to initialize OpenXR!");
-            return false;
-        }
+        // Instance creation runs in the background so the runtime starting up
+        // (SteamVR can take seconds) does not hold up the game boot
+        g_vrSystem->InitializeAsync(nullptr);
 
         // 3. Initialize D3D12 Hooks (captures command queue for VR)
         if (!D3D12Hook::Initialize()) {
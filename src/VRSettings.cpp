@@ -147,6 +147,374 @@ void Native_GetAimSmoothing(RED4ext::IScriptable* aContext, RED4ext::CStackFrame
     }
 }
 
+// SetUIDistance(meters: Float) -> Void
+void Native_SetUIDistance(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                           void* aOut, int64_t a4)
+{
+    float meters;
+    RED4ext::GetParameter(aFrame, &meters);
+    aFrame->code++;
+
+    // Clamp to the range the CET slider offers
+    if (meters < 0.5f) meters = 0.5f;
+    if (meters > 5.0f) meters = 5.0f;
+
+    VRConfig::SetUIDistance(meters);
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "VR: UI distance set to %.1fm via CET", meters);
+    Utils::LogInfo(msg);
+}
+
+// GetUIDistance() -> Float
+void Native_GetUIDistance(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                           float* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::GetUIDistance();
+    }
+}
+
+// SetRefreshRate(hz: Float) -> Void (0 = match the game's frame rate)
+void Native_SetRefreshRate(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                            void* aOut, int64_t a4)
+{
+    float hz;
+    RED4ext::GetParameter(aFrame, &hz);
+    aFrame->code++;
+
+    if (hz < 0.0f) hz = 0.0f;
+
+    VRConfig::SetRefreshRateRequest(hz);
+
+    char msg[64];
+    if (hz > 0.0f)
+    {
+        snprintf(msg, sizeof(msg), "VR: Refresh rate set to %.0f Hz via CET", hz);
+    }
+    else
+    {
+        snprintf(msg, sizeof(msg), "VR: Refresh rate set to automatic via CET");
+    }
+    Utils::LogInfo(msg);
+}
+
+// GetRefreshRate() -> Float (0 = automatic)
+void Native_GetRefreshRate(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                            float* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::GetRefreshRateRequest();
+    }
+}
+
+// GetDisplayRefreshRate() -> Float (0 = unknown)
+void Native_GetDisplayRefreshRate(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                   float* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::GetDisplayRefreshRate();
+    }
+}
+
+// GetRefreshRateCount() -> Int32
+void Native_GetRefreshRateCount(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                 int32_t* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = static_cast<int32_t>(VRConfig::GetRefreshRateCount());
+    }
+}
+
+// GetRefreshRateAt(index: Int32) -> Float
+void Native_GetRefreshRateAt(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                              float* aOut, int64_t a4)
+{
+    int32_t index;
+    RED4ext::GetParameter(aFrame, &index);
+    aFrame->code++;
+
+    if (aOut)
+    {
+        *aOut = (index >= 0) ? VRConfig::GetRefreshRate(static_cast<uint32_t>(index)) : 0.0f;
+    }
+}
+
+// SetDynamicOutputScale(enabled: Bool) -> Void
+void Native_SetDynamicOutputScale(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                  void* aOut, int64_t a4)
+{
+    bool enabled;
+    RED4ext::GetParameter(aFrame, &enabled);
+    aFrame->code++;
+
+    VRConfig::SetDynamicOutputScale(enabled);
+    Utils::LogInfo(enabled ? "VR: Dynamic output scale enabled via CET" : "VR: Dynamic output scale disabled via CET");
+}
+
+// GetDynamicOutputScale() -> Bool
+void Native_GetDynamicOutputScale(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                  bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsDynamicOutputScale();
+    }
+}
+
+// SetUILayer(enabled: Bool) -> Void
+void Native_SetUILayer(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                       void* aOut, int64_t a4)
+{
+    bool enabled;
+    RED4ext::GetParameter(aFrame, &enabled);
+    aFrame->code++;
+
+    VRConfig::SetUILayer(enabled);
+    Utils::LogInfo(enabled ? "VR: UI layer enabled via CET" : "VR: UI layer disabled via CET");
+}
+
+// GetUILayer() -> Bool
+void Native_GetUILayer(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                       bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsUILayer();
+    }
+}
+
+// SetUILayerClear(enabled: Bool) -> Void
+void Native_SetUILayerClear(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                            void* aOut, int64_t a4)
+{
+    bool enabled;
+    RED4ext::GetParameter(aFrame, &enabled);
+    aFrame->code++;
+
+    VRConfig::SetUILayerClear(enabled);
+    Utils::LogInfo(enabled ? "VR: UI taken out of the game's frame via CET" : "VR: UI left in the game's frame via CET");
+}
+
+// GetUILayerClear() -> Bool
+void Native_GetUILayerClear(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                            bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsUILayerClear();
+    }
+}
+
+// SetEveryFrameSubmit(enabled: Bool) -> Void (applies on restart)
+void Native_SetEveryFrameSubmit(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                void* aOut, int64_t a4)
+{
+    bool enabled;
+    RED4ext::GetParameter(aFrame, &enabled);
+    aFrame->code++;
+
+    VRConfig::SetEveryFrameSubmit(enabled);
+    Utils::LogInfo(enabled ? "VR: Every-frame submission enabled via CET" : "VR: Every-frame submission disabled via CET");
+}
+
+// GetEveryFrameSubmit() -> Bool
+void Native_GetEveryFrameSubmit(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsEveryFrameSubmit();
+    }
+}
+
+// SetDepthRange(nearMeters: Float, farMeters: Float, reversed: Bool) -> Void
+// The camera's clip planes; depth is only submitted once they are set
+void Native_SetDepthRange(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                          void* aOut, int64_t a4)
+{
+    float nearZ;
+    float farZ;
+    bool reversed;
+    RED4ext::GetParameter(aFrame, &nearZ);
+    RED4ext::GetParameter(aFrame, &farZ);
+    RED4ext::GetParameter(aFrame, &reversed);
+    aFrame->code++;
+
+    if (nearZ < 0.0f) nearZ = 0.0f;
+    if (farZ < 0.0f) farZ = 0.0f;
+
+    VRConfig::SetDepthRange(nearZ, farZ, reversed);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "VR: Depth range %.3f-%.0fm%s via CET", nearZ, farZ, reversed ? " (reversed)" : "");
+    Utils::LogInfo(msg);
+}
+
+// GetDepthNear() -> Float (meters, 0 = not set)
+void Native_GetDepthNear(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                         float* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::GetDepthNear();
+    }
+}
+
+// GetDepthFar() -> Float (meters, 0 = not set)
+void Native_GetDepthFar(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                        float* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::GetDepthFar();
+    }
+}
+
+// GetDepthReversed() -> Bool
+void Native_GetDepthReversed(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                             bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsDepthReversed();
+    }
+}
+
+// Restart() -> Void: rebuild the OpenXR session for settings read at its creation
+void Native_Restart(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                    void* aOut, int64_t a4)
+{
+    aFrame->code++;
+
+    VRConfig::RequestRestart();
+    Utils::LogInfo("VR: Restart requested via CET");
+}
+
+// SetSpaceWarp(enabled: Bool) -> Void (applies on restart)
+void Native_SetSpaceWarp(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                         void* aOut, int64_t a4)
+{
+    bool enabled;
+    RED4ext::GetParameter(aFrame, &enabled);
+    aFrame->code++;
+
+    VRConfig::SetSpaceWarp(enabled);
+    Utils::LogInfo(enabled ? "VR: Space warp enabled via CET" : "VR: Space warp disabled via CET");
+}
+
+// GetSpaceWarp() -> Bool
+void Native_GetSpaceWarp(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                         bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsSpaceWarp();
+    }
+}
+
+// SetLensMatched(enabled: Bool) -> Void (applies on restart)
+void Native_SetLensMatched(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                           void* aOut, int64_t a4)
+{
+    bool enabled;
+    RED4ext::GetParameter(aFrame, &enabled);
+    aFrame->code++;
+
+    VRConfig::SetLensMatched(enabled);
+    Utils::LogInfo(enabled ? "VR: Lens-matched layers enabled via CET" : "VR: Lens-matched layers disabled via CET");
+}
+
+// GetLensMatched() -> Bool
+void Native_GetLensMatched(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                           bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsLensMatched();
+    }
+}
+
+// SetLensMatchedAngle(degrees: Float) -> Void (inset half-angle, applies on restart)
+void Native_SetLensMatchedAngle(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                void* aOut, int64_t a4)
+{
+    float degrees;
+    RED4ext::GetParameter(aFrame, &degrees);
+    aFrame->code++;
+
+    if (degrees < 10.0f) degrees = 10.0f;
+    if (degrees > 50.0f) degrees = 50.0f;
+
+    VRConfig::SetLensMatchedAngle(degrees);
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "VR: Lens-matched inset set to +/-%.0f deg via CET", degrees);
+    Utils::LogInfo(msg);
+}
+
+// GetLensMatchedAngle() -> Float
+void Native_GetLensMatchedAngle(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                                float* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::GetLensMatchedAngle();
+    }
+}
+
+// SetDepthSubmission(enabled: Bool) -> Void (applies on restart)
+void Native_SetDepthSubmission(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                               void* aOut, int64_t a4)
+{
+    bool enabled;
+    RED4ext::GetParameter(aFrame, &enabled);
+    aFrame->code++;
+
+    VRConfig::SetDepthSubmission(enabled);
+    Utils::LogInfo(enabled ? "VR: Depth submission enabled via CET" : "VR: Depth submission disabled via CET");
+}
+
+// GetDepthSubmission() -> Bool
+void Native_GetDepthSubmission(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                               bool* aOut, int64_t a4)
+{
+    aFrame->code++;
+    if (aOut)
+    {
+        *aOut = VRConfig::IsDepthSubmission();
+    }
+}
+
+// SetMenuMode(inMenu: Bool) -> Void
+void Native_SetMenuMode(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame,
+                         void* aOut, int64_t a4)
+{
+    bool inMenu;
+    RED4ext::GetParameter(aFrame, &inMenu);
+    aFrame->code++;
+
+    VRConfig::SetMenuMode(inMenu);
+}
+
 namespace VRSettings
 {
     void RegisterNativeFunctions(const RED4ext::Sdk* sdk, RED4ext::PluginHandle handle)
@@ -228,6 +596,211 @@ namespace VRSettings
             rtti->RegisterFunction(func);
         }
 
+        // native func CyberpunkVR_SetUIDistance(meters: Float) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetUIDistance", "CyberpunkVR_SetUIDistance", &Native_SetUIDistance);
+            func->AddParam("Float", "meters");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetUIDistance() -> Float
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetUIDistance", "CyberpunkVR_GetUIDistance", &Native_GetUIDistance);
+            func->SetReturnType("Float");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetRefreshRate(hz: Float) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetRefreshRate", "CyberpunkVR_SetRefreshRate", &Native_SetRefreshRate);
+            func->AddParam("Float", "hz");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetRefreshRate() -> Float
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetRefreshRate", "CyberpunkVR_GetRefreshRate", &Native_GetRefreshRate);
+            func->SetReturnType("Float");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetDisplayRefreshRate() -> Float
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetDisplayRefreshRate", "CyberpunkVR_GetDisplayRefreshRate", &Native_GetDisplayRefreshRate);
+            func->SetReturnType("Float");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetRefreshRateCount() -> Int32
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetRefreshRateCount", "CyberpunkVR_GetRefreshRateCount", &Native_GetRefreshRateCount);
+            func->SetReturnType("Int32");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetRefreshRateAt(index: Int32) -> Float
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetRefreshRateAt", "CyberpunkVR_GetRefreshRateAt", &Native_GetRefreshRateAt);
+            func->AddParam("Int32", "index");
+            func->SetReturnType("Float");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetDynamicOutputScale(enabled: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetDynamicOutputScale", "CyberpunkVR_SetDynamicOutputScale", &Native_SetDynamicOutputScale);
+            func->AddParam("Bool", "enabled");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetDynamicOutputScale() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetDynamicOutputScale", "CyberpunkVR_GetDynamicOutputScale", &Native_GetDynamicOutputScale);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetUILayer(enabled: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetUILayer", "CyberpunkVR_SetUILayer", &Native_SetUILayer);
+            func->AddParam("Bool", "enabled");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetUILayer() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetUILayer", "CyberpunkVR_GetUILayer", &Native_GetUILayer);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetUILayerClear(enabled: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetUILayerClear", "CyberpunkVR_SetUILayerClear", &Native_SetUILayerClear);
+            func->AddParam("Bool", "enabled");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetUILayerClear() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetUILayerClear", "CyberpunkVR_GetUILayerClear", &Native_GetUILayerClear);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetEveryFrameSubmit(enabled: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetEveryFrameSubmit", "CyberpunkVR_SetEveryFrameSubmit", &Native_SetEveryFrameSubmit);
+            func->AddParam("Bool", "enabled");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetEveryFrameSubmit() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetEveryFrameSubmit", "CyberpunkVR_GetEveryFrameSubmit", &Native_GetEveryFrameSubmit);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetDepthRange(nearMeters: Float, farMeters: Float, reversed: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetDepthRange", "CyberpunkVR_SetDepthRange", &Native_SetDepthRange);
+            func->AddParam("Float", "nearMeters");
+            func->AddParam("Float", "farMeters");
+            func->AddParam("Bool", "reversed");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetDepthNear() -> Float
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetDepthNear", "CyberpunkVR_GetDepthNear", &Native_GetDepthNear);
+            func->SetReturnType("Float");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetDepthFar() -> Float
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetDepthFar", "CyberpunkVR_GetDepthFar", &Native_GetDepthFar);
+            func->SetReturnType("Float");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetDepthReversed() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetDepthReversed", "CyberpunkVR_GetDepthReversed", &Native_GetDepthReversed);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_Restart() -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_Restart", "CyberpunkVR_Restart", &Native_Restart);
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetSpaceWarp(enabled: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetSpaceWarp", "CyberpunkVR_SetSpaceWarp", &Native_SetSpaceWarp);
+            func->AddParam("Bool", "enabled");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetSpaceWarp() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetSpaceWarp", "CyberpunkVR_GetSpaceWarp", &Native_GetSpaceWarp);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetLensMatched(enabled: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetLensMatched", "CyberpunkVR_SetLensMatched", &Native_SetLensMatched);
+            func->AddParam("Bool", "enabled");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetLensMatched() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetLensMatched", "CyberpunkVR_GetLensMatched", &Native_GetLensMatched);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetLensMatchedAngle(degrees: Float) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetLensMatchedAngle", "CyberpunkVR_SetLensMatchedAngle", &Native_SetLensMatchedAngle);
+            func->AddParam("Float", "degrees");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetLensMatchedAngle() -> Float
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetLensMatchedAngle", "CyberpunkVR_GetLensMatchedAngle", &Native_GetLensMatchedAngle);
+            func->SetReturnType("Float");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetDepthSubmission(enabled: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetDepthSubmission", "CyberpunkVR_SetDepthSubmission", &Native_SetDepthSubmission);
+            func->AddParam("Bool", "enabled");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_GetDepthSubmission() -> Bool
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_GetDepthSubmission", "CyberpunkVR_GetDepthSubmission", &Native_GetDepthSubmission);
+            func->SetReturnType("Bool");
+            rtti->RegisterFunction(func);
+        }
+
+        // native func CyberpunkVR_SetMenuMode(inMenu: Bool) -> Void
+        {
+            auto func = RED4ext::CGlobalFunction::Create("CyberpunkVR_SetMenuMode", "CyberpunkVR_SetMenuMode", &Native_SetMenuMode);
+            func->AddParam("Bool", "inMenu");
+            rtti->RegisterFunction(func);
+        }
+
         Utils::LogInfo("VRSettings: Native functions registered successfully");
     }
 
@@ -1,28 +1,8 @@
-#include "VRSystem.hpp"
-#include "ThreadSafe.hpp"
-#include "Utils.hpp"
-#include <vector>
-#include <string>
-#include <cmath>
-
-// Windows / DirectX / OpenXR Headers
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
-#include <windows.h>
-#include <d3d12.h>
-#include <dxgi1_4.h>
-
-#include <openxr/openxr.h>
-#include <openxr/openxr_platform.h>
+#include "VRSystemImpl.hpp"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
-
-#include <algorithm>
+#pragma comment(lib, "d3dcompiler.lib")
 
 // Coordinate system conversion
 // REDengine uses: X-right, Y-forward, Z-up (left-handed)
@@ -47,769 +27,3387 @@ namespace CoordinateConversion
     }
 }
 
-// OpenXR session states
-enum class SessionState
-{
-    Unknown,
-    Idle,
-    Ready,
-    Synchronized,
-    Visible,
-    Focused,
-    Stopping,
-    LossPending,
-    Exiting
-};
-
-// The Actual Implementation Class
-class VRSystem::Impl
-{
-public:
-    // Thread safety
-    mutable std::mutex m_mutex;
-    ThreadSafe::Flag m_initialized{false};
-    ThreadSafe::Flag m_sessionReady{false};
-    ThreadSafe::Flag m_frameInProgress{false};
-    std::atomic<SessionState> m_sessionState{SessionState::Unknown};
-
-    // OpenXR handles
-    XrInstance m_instance = XR_NULL_HANDLE;
-    XrSystemId m_systemId = XR_NULL_SYSTEM_ID;
-    XrSession m_session = XR_NULL_HANDLE;
-    XrSpace m_appSpace = XR_NULL_HANDLE;
-
-    // OpenXR Action System for controllers
-    XrActionSet m_actionSet = XR_NULL_HANDLE;
-    XrAction m_triggerAction = XR_NULL_HANDLE;
-    XrAction m_gripAction = XR_NULL_HANDLE;
-    XrAction m_thumbstickAction = XR_NULL_HANDLE;
-    XrAction m_thumbstickClickAction = XR_NULL_HANDLE;
-    XrAction m_primaryButtonAction = XR_NULL_HANDLE;    // A/X buttons
-    XrAction m_secondaryButtonAction = XR_NULL_HANDLE;  // B/Y buttons
-    XrAction m_menuButtonAction = XR_NULL_HANDLE;
-    XrAction m_handPoseAction = XR_NULL_HANDLE;
-
-    XrPath m_handPaths[2] = { XR_NULL_PATH, XR_NULL_PATH };
-    XrSpace m_handSpaces[2] = { XR_NULL_HANDLE, XR_NULL_HANDLE };
-
-    // Cached controller state
-    VRControllerState m_controllerState;
-    ThreadSafe::Flag m_controllersAvailable{false};
-
-    XrGraphicsBindingD3D12KHR m_graphicsBinding{XR_TYPE_GRAPHICS_BINDING_D3D12_KHR};
-
-    // D3D12 resources (using ComPtr for automatic cleanup)
-    ComPtr<ID3D12Device> m_device;
-    ComPtr<ID3D12CommandQueue> m_commandQueue;
-    ComPtr<ID3D12CommandAllocator> m_commandAllocator;
-    ComPtr<ID3D12GraphicsCommandList> m_commandList;
-    ComPtr<ID3D12Fence> m_fence;
-    HANDLE m_fenceEvent = nullptr;
-    std::atomic<UINT64> m_fenceValue{0};
-
-    // Frame state
-    XrFrameState m_frameState{XR_TYPE_FRAME_STATE};
-
-    struct SwapchainInfo {
-        XrSwapchain handle = XR_NULL_HANDLE;
-        int32_t width = 0;
-        int32_t height = 0;
-        std::vector<XrSwapchainImageD3D12KHR> images;
-    };
+bool VRSystem::Impl::CreateInstance()
+{
+    XrApplicationInfo appInfo = {};
+    strcpy_s(appInfo.applicationName, "CyberpunkVR");
+    appInfo.applicationVersion = 1;
+    strcpy_s(appInfo.engineName, "RED4ext");
+    appInfo.engineVersion = 1;
+    appInfo.apiVersion = XR_CURRENT_API_VERSION;
+
+    std::vector<const char*> extensions = { "XR_KHR_D3D12_enable" };
+
+    // Optional extensions are enabled only when the runtime offers them
+    m_depthLayerSupported = VRConfig::IsDepthSubmission() &&
+                            IsExtensionAvailable(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
+    if (m_depthLayerSupported)
+    {
+        extensions.push_back(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
+    }
 
-    SwapchainInfo m_swapchains[2];
+    // Space warp needs the depth the depth layer path already extracts
+    m_spaceWarpSupported = m_depthLayerSupported && VRConfig::IsSpaceWarp() &&
+                           IsExtensionAvailable(XR_FB_SPACE_WARP_EXTENSION_NAME);
+    if (m_spaceWarpSupported)
+    {
+        extensions.push_back(XR_FB_SPACE_WARP_EXTENSION_NAME);
+    }
 
-    std::vector<XrViewConfigurationView> m_viewConfigs;
-    std::vector<XrView> m_views;
-    std::vector<XrCompositionLayerProjectionView> m_projectionViews;
+    // Menus fall back to a flat quad without cylinder layers. Enabled even
+    // with the UI layer off, which may be switched on at any time
+    m_cylinderSupported = IsExtensionAvailable(XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME);
+    if (m_cylinderSupported)
+    {
+        extensions.push_back(XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME);
+    }
 
-    bool CreateInstance()
+    m_perfSettingsSupported = VRConfig::IsPerfHints() &&
+                              IsExtensionAvailable(XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME);
+    if (m_perfSettingsSupported)
     {
-        XrApplicationInfo appInfo = {};
-        strcpy_s(appInfo.applicationName, "CyberpunkVR");
-        appInfo.applicationVersion = 1;
-        strcpy_s(appInfo.engineName, "RED4ext");
-        appInfo.engineVersion = 1;
-        appInfo.apiVersion = XR_CURRENT_API_VERSION;
+        extensions.push_back(XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME);
+    }
 
-        const char* extensions[] = { "XR_KHR_D3D12_enable" };
+    m_refreshRateSupported = VRConfig::IsRefreshRateSelection() &&
+                             IsExtensionAvailable(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME);
+    if (m_refreshRateSupported)
+    {
+        extensions.push_back(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME);
+    }
 
-        XrInstanceCreateInfo createInfo = { XR_TYPE_INSTANCE_CREATE_INFO };
-        createInfo.applicationInfo = appInfo;
-        createInfo.enabledExtensionCount = 1;
-        createInfo.enabledExtensionNames = extensions;
+    m_visibilityMaskSupported = VRConfig::IsVisibilityMask() &&
+                                IsExtensionAvailable(XR_KHR_VISIBILITY_MASK_EXTENSION_NAME);
+    if (m_visibilityMaskSupported)
+    {
+        extensions.push_back(XR_KHR_VISIBILITY_MASK_EXTENSION_NAME);
+    }
 
-        XrResult result = xrCreateInstance(&createInfo, &m_instance);
-        if (XR_FAILED(result))
-        {
-            char msg[128];
-            snprintf(msg, sizeof(msg), "OpenXR: xrCreateInstance failed with code %d", result);
-            Utils::LogError(msg);
-            return false;
-        }
-        return true;
+    XrInstanceCreateInfo createInfo = { XR_TYPE_INSTANCE_CREATE_INFO };
+    createInfo.applicationInfo = appInfo;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.enabledExtensionNames = extensions.data();
+
+    XrResult result = xrCreateInstance(&createInfo, &m_instance);
+    if (XR_FAILED(result))
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: xrCreateInstance failed with code %d", result);
+        Utils::LogError(msg);
+        return false;
+    }
+
+    if (m_visibilityMaskSupported &&
+        XR_FAILED(xrGetInstanceProcAddr(m_instance, "xrGetVisibilityMaskKHR",
+            reinterpret_cast<PFN_xrVoidFunction*>(&m_xrGetVisibilityMaskKHR))))
+    {
+        Utils::LogWarn("OpenXR: xrGetVisibilityMaskKHR not found - copying whole eye images");
+        m_visibilityMaskSupported = false;
+        m_xrGetVisibilityMaskKHR = nullptr;
+    }
+
+    if (m_perfSettingsSupported &&
+        XR_FAILED(xrGetInstanceProcAddr(m_instance, "xrPerfSettingsSetPerformanceLevelEXT",
+            reinterpret_cast<PFN_xrVoidFunction*>(&m_xrPerfSettingsSetPerformanceLevelEXT))))
+    {
+        Utils::LogWarn("OpenXR: xrPerfSettingsSetPerformanceLevelEXT not found - no performance hints");
+        m_perfSettingsSupported = false;
+        m_xrPerfSettingsSetPerformanceLevelEXT = nullptr;
+    }
+
+    if (m_refreshRateSupported &&
+        (XR_FAILED(xrGetInstanceProcAddr(m_instance, "xrEnumerateDisplayRefreshRatesFB",
+             reinterpret_cast<PFN_xrVoidFunction*>(&m_xrEnumerateDisplayRefreshRatesFB))) ||
+         XR_FAILED(xrGetInstanceProcAddr(m_instance, "xrGetDisplayRefreshRateFB",
+             reinterpret_cast<PFN_xrVoidFunction*>(&m_xrGetDisplayRefreshRateFB))) ||
+         XR_FAILED(xrGetInstanceProcAddr(m_instance, "xrRequestDisplayRefreshRateFB",
+             reinterpret_cast<PFN_xrVoidFunction*>(&m_xrRequestDisplayRefreshRateFB)))))
+    {
+        Utils::LogWarn("OpenXR: Display refresh rate functions not found - keeping the runtime's rate");
+        m_refreshRateSupported = false;
     }
+    return true;
+}
 
-    bool CreateSession(ID3D12CommandQueue* gameCommandQueue)
+bool VRSystem::Impl::IsExtensionAvailable(const char* name)
+{
+    if (m_availableExtensions.empty())
     {
-        if (!gameCommandQueue)
+        uint32_t count = 0;
+        if (XR_FAILED(xrEnumerateInstanceExtensionProperties(nullptr, 0, &count, nullptr)) || count == 0)
         {
-            Utils::LogError("OpenXR: CreateSession called with null command queue");
             return false;
         }
 
-        XrSystemGetInfo systemInfo = { XR_TYPE_SYSTEM_GET_INFO };
-        systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
-
-        XrResult result = xrGetSystem(m_instance, &systemInfo, &m_systemId);
-        if (XR_FAILED(result))
+        m_availableExtensions.resize(count, { XR_TYPE_EXTENSION_PROPERTIES });
+        if (XR_FAILED(xrEnumerateInstanceExtensionProperties(nullptr, count, &count, m_availableExtensions.data())))
         {
-            Utils::LogError("OpenXR: No HMD found! Is your headset connected?");
+            m_availableExtensions.clear();
             return false;
         }
+    }
 
-        // Get device from command queue
-        if (FAILED(gameCommandQueue->GetDevice(IID_PPV_ARGS(&m_device))))
+    for (const XrExtensionProperties& extension : m_availableExtensions)
+    {
+        if (strcmp(extension.extensionName, name) == 0)
         {
-            Utils::LogError("OpenXR: Failed to get D3D12 device from command queue");
-            return false;
+            return true;
         }
+    }
+    return false;
+}
+
+void VRSystem::Impl::QuerySpaceWarpProperties()
+{
+    m_spaceWarpProperties = { XR_TYPE_SYSTEM_SPACE_WARP_PROPERTIES_FB };
+    XrSystemProperties systemProperties = { XR_TYPE_SYSTEM_PROPERTIES };
+    systemProperties.next = &m_spaceWarpProperties;
+
+    if (XR_FAILED(xrGetSystemProperties(m_instance, m_systemId, &systemProperties)))
+    {
+        Utils::LogWarn("OpenXR: Space warp properties unavailable - space warp disabled");
+        m_spaceWarpSupported = false;
+        return;
+    }
+
+    // Motion images follow the game's depth size; the recommendation is only logged
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Space warp enabled (recommended motion image %ux%u)",
+             m_spaceWarpProperties.recommendedMotionVectorImageRectWidth,
+             m_spaceWarpProperties.recommendedMotionVectorImageRectHeight);
+    Utils::LogInfo(msg);
+}
+
+bool VRSystem::Impl::CreateSession(ID3D12CommandQueue* gameCommandQueue)
+{
+    if (!gameCommandQueue)
+    {
+        Utils::LogError("OpenXR: CreateSession called with null command queue");
+        return false;
+    }
+
+    // Get device from command queue
+    if (FAILED(gameCommandQueue->GetDevice(IID_PPV_ARGS(&m_device))))
+    {
+        Utils::LogError("OpenXR: Failed to get D3D12 device from command queue");
+        return false;
+    }
+
+    m_commandQueue = gameCommandQueue;
+    m_commandQueue->AddRef(); // Take ownership
+
+    m_graphicsBinding.device = m_device.Get();
+    m_graphicsBinding.queue = gameCommandQueue;
 
-        m_commandQueue = gameCommandQueue;
-        m_commandQueue->AddRef(); // Take ownership
+    return OpenSession();
+}
+
+// Session and its reference spaces on the bound device; also used to
+// recreate a lost session
+bool VRSystem::Impl::OpenSession()
+{
+    XrSystemGetInfo systemInfo = { XR_TYPE_SYSTEM_GET_INFO };
+    systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+
+    XrResult result = xrGetSystem(m_instance, &systemInfo, &m_systemId);
+    if (XR_FAILED(result))
+    {
+        Utils::LogError("OpenXR: No HMD found! Is your headset connected?");
+        return false;
+    }
 
-        m_graphicsBinding.device = m_device.Get();
-        m_graphicsBinding.queue = gameCommandQueue;
+    if (m_spaceWarpSupported)
+    {
+        QuerySpaceWarpProperties();
+    }
+
+    XrSessionCreateInfo sessionInfo = { XR_TYPE_SESSION_CREATE_INFO };
+    sessionInfo.next = &m_graphicsBinding;
+    sessionInfo.systemId = m_systemId;
+
+    result = xrCreateSession(m_instance, &sessionInfo, &m_session);
+    if (XR_FAILED(result))
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: xrCreateSession failed with code %d", result);
+        Utils::LogError(msg);
+        return false;
+    }
 
-        XrSessionCreateInfo sessionInfo = { XR_TYPE_SESSION_CREATE_INFO };
-        sessionInfo.next = &m_graphicsBinding;
-        sessionInfo.systemId = m_systemId;
+    // Try STAGE space first, fall back to LOCAL
+    XrReferenceSpaceCreateInfo spaceInfo = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
+    spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_STAGE;
+    spaceInfo.poseInReferenceSpace.orientation.w = 1.0f;
 
-        result = xrCreateSession(m_instance, &sessionInfo, &m_session);
+    result = xrCreateReferenceSpace(m_session, &spaceInfo, &m_appSpace);
+    if (XR_FAILED(result))
+    {
+        Utils::LogWarn("OpenXR: STAGE space not available, trying LOCAL");
+        spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+        result = xrCreateReferenceSpace(m_session, &spaceInfo, &m_appSpace);
         if (XR_FAILED(result))
         {
-            char msg[128];
-            snprintf(msg, sizeof(msg), "OpenXR: xrCreateSession failed with code %d", result);
-            Utils::LogError(msg);
+            Utils::LogError("OpenXR: Failed to create reference space");
             return false;
         }
+    }
 
-        // Try STAGE space first, fall back to LOCAL
-        XrReferenceSpaceCreateInfo spaceInfo = { XR_TYPE_REFERENCE_SPACE_CREATE_INFO };
-        spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_STAGE;
-        spaceInfo.poseInReferenceSpace.orientation.w = 1.0f;
+    // Without a VIEW space the HUD is world-locked like menus
+    spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+    if (XR_FAILED(xrCreateReferenceSpace(m_session, &spaceInfo, &m_viewSpace)))
+    {
+        Utils::LogWarn("OpenXR: VIEW space not available - HUD layer will not follow the head");
+        m_viewSpace = XR_NULL_HANDLE;
+    }
 
-        result = xrCreateReferenceSpace(m_session, &spaceInfo, &m_appSpace);
-        if (XR_FAILED(result))
+    if (m_perfSettingsSupported)
+    {
+        ConfigurePerfLevels();
+    }
+
+    if (m_refreshRateSupported)
+    {
+        ConfigureRefreshRates();
+    }
+
+    return true;
+}
+
+bool VRSystem::Impl::CreateSwapchains()
+{
+    uint32_t viewCount = 0;
+    xrEnumerateViewConfigurationViews(m_instance, m_systemId,
+        XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, 0, &viewCount, nullptr);
+
+    if (viewCount != 2)
+    {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "OpenXR: Expected 2 views, got %u", viewCount);
+        Utils::LogError(msg);
+        return false;
+    }
+
+    m_viewConfigs.resize(viewCount, { XR_TYPE_VIEW_CONFIGURATION_VIEW });
+    xrEnumerateViewConfigurationViews(m_instance, m_systemId,
+        XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, viewCount, &viewCount, m_viewConfigs.data());
+
+    m_views.resize(viewCount, { XR_TYPE_VIEW });
+
+    m_swapchainFormat = SelectSwapchainFormat();
+
+    ConfigureOutputScaler();
+
+    uint32_t allocWidth[2], allocHeight[2];
+    for (uint32_t i = 0; i < viewCount; i++)
+    {
+        GetAllocationSize(m_viewConfigs[i], allocWidth[i], allocHeight[i]);
+    }
+
+    bool created = false;
+    if (VRConfig::IsSingleSwapchain() && !VRConfig::IsEveryFrameSubmit())
+    {
+        // Both eyes in one array swapchain: one acquire/wait/release per frame pair
+        uint32_t width = std::max(allocWidth[0], allocWidth[1]);
+        uint32_t height = std::max(allocHeight[0], allocHeight[1]);
+
+        if (CreateSwapchain(m_swapchains[0], width, height, 2))
         {
-            Utils::LogWarn("OpenXR: STAGE space not available, trying LOCAL");
-            spaceInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
-            result = xrCreateReferenceSpace(m_session, &spaceInfo, &m_appSpace);
-            if (XR_FAILED(result))
+            m_swapchainCount = 1;
+            m_eyeTargets[0] = { 0, 0, false };
+            m_eyeTargets[1] = { 0, 1, true };
+            created = true;
+        }
+        else
+        {
+            Utils::LogWarn("OpenXR: Array swapchain unavailable, using one swapchain per eye");
+        }
+    }
+
+    if (!created)
+    {
+        for (uint32_t i = 0; i < viewCount; i++)
+        {
+            if (!CreateSwapchain(m_swapchains[i], allocWidth[i], allocHeight[i], 1))
             {
-                Utils::LogError("OpenXR: Failed to create reference space");
                 return false;
             }
+            m_eyeTargets[i] = { i, 0, true };
         }
+        m_swapchainCount = viewCount;
+    }
 
-        return true;
+    ConfigureLensMatching();
+    UpdateEyeExtents();
+    CheckDepthSupport();
+    return true;
+}
+
+void VRSystem::Impl::ConfigureLensMatching()
+{
+    m_lensMatched = VRConfig::IsLensMatched();
+    if (!m_lensMatched)
+    {
+        return;
     }
 
-    bool CreateSwapchains()
+    float angle = std::clamp(VRConfig::GetLensMatchedAngle(), LensMatch::MIN_INSET_HALF_ANGLE_DEGREES,
+                             LensMatch::MAX_INSET_HALF_ANGLE_DEGREES);
+    m_peripheryScale = LensMatch::PeripheryScale(LensMatch::DegreesToRadians(angle),
+                                                 VRConfig::GetLensMatchedPeripheryFactor());
+
+    // The outer band is always resampled, and depth is only submitted 1:1
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Lens-matched layers, inset +/-%.0f deg, outer band at %.2fx (no depth layer)",
+             angle, m_peripheryScale);
+    Utils::LogInfo(msg);
+}
+
+void VRSystem::Impl::ConfigureOutputScaler()
+{
+    OutputScaler::Settings settings;
+    settings.minScale = VRConfig::GetMinOutputScale();
+    settings.maxScale = VRConfig::GetMaxOutputScale();
+    m_outputScaler.Configure(settings);
+    m_outputScaleDynamic = VRConfig::IsDynamicOutputScale();
+    m_pairCostSeconds = 0.0;
+    m_lastSubmitTime = {};
+}
+
+// The output scale never exceeds 1, so the recommended size holds every
+// scale and turning the dynamic scale on or off never reallocates
+void VRSystem::Impl::GetAllocationSize(const XrViewConfigurationView& view, uint32_t& width, uint32_t& height) const
+{
+    width = view.recommendedImageRectWidth;
+    height = view.recommendedImageRectHeight;
+}
+
+// Recompute the submitted region from the current scale
+// Returns true if either eye changed size
+bool VRSystem::Impl::UpdateEyeExtents()
+{
+    float scale = m_outputScaleDynamic ? m_outputScaler.GetScale() : 1.0f;
+    if (m_lensMatched)
     {
-        uint32_t viewCount = 0;
-        xrEnumerateViewConfigurationViews(m_instance, m_systemId,
-            XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, 0, &viewCount, nullptr);
+        scale *= m_peripheryScale;
+    }
+    bool changed = false;
 
-        if (viewCount != 2)
+    for (int eye = 0; eye < 2; eye++)
+    {
+        const SwapchainInfo& swapchain = GetEyeSwapchain(eye);
+        XrExtent2Di extent;
+        extent.width = static_cast<int32_t>(OutputScaler::ScaleExtent(
+            m_viewConfigs[eye].recommendedImageRectWidth, scale, static_cast<uint32_t>(swapchain.width)));
+        extent.height = static_cast<int32_t>(OutputScaler::ScaleExtent(
+            m_viewConfigs[eye].recommendedImageRectHeight, scale, static_cast<uint32_t>(swapchain.height)));
+
+        if (extent.width != m_eyeExtents[eye].width || extent.height != m_eyeExtents[eye].height)
         {
-            char msg[64];
-            snprintf(msg, sizeof(msg), "OpenXR: Expected 2 views, got %u", viewCount);
-            Utils::LogError(msg);
-            return false;
+            m_eyeExtents[eye] = extent;
+            changed = true;
         }
+    }
 
-        m_viewConfigs.resize(viewCount, { XR_TYPE_VIEW_CONFIGURATION_VIEW });
-        xrEnumerateViewConfigurationViews(m_instance, m_systemId,
-            XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, viewCount, &viewCount, m_viewConfigs.data());
+    return changed;
+}
 
-        m_views.resize(viewCount, { XR_TYPE_VIEW });
-        m_projectionViews.resize(viewCount, { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW });
+// Render thread, around each eye's copy / resample
+void VRSystem::Impl::BeginOutputTime()
+{
+    if (m_outputScaleDynamic)
+    {
+        m_outputTimer.Begin();
+    }
+}
 
-        for (uint32_t i = 0; i < viewCount; i++)
+void VRSystem::Impl::EndOutputTime()
+{
+    m_outputTimer.End();
+}
+
+// Called once per frame pair, after xrEndFrame
+// Resizes only the copy / resample output the compositor receives; the game
+// renders at its own resolution whatever the scale. The cost is the GPU time
+// of the plugin's own eye copies / resamples (queue-span time on
+// m_commandQueue, see GpuTimer), the one cost the scale changes; the
+// compositor's work on the submitted images follows it. A copy queue copy
+// runs off that queue and reads as free, but is only used at the source's
+// own resolution, which is already the upper bound
+void VRSystem::Impl::UpdateOutputScale(ID3D12Resource* source, XrDuration displayPeriod)
+{
+    bool dynamic = VRConfig::IsDynamicOutputScale();
+    if (dynamic != m_outputScaleDynamic)
+    {
+        // Images are allocated at the recommended size either way
+        m_outputScaleDynamic = dynamic;
+        m_outputScaler.Reset(m_outputScaler.GetMaxScale());
+        if (UpdateEyeExtents())
         {
-            XrSwapchainCreateInfo swapchainInfo = { XR_TYPE_SWAPCHAIN_CREATE_INFO };
-            swapchainInfo.usageFlags = XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT;
-            swapchainInfo.format = DXGI_FORMAT_R8G8B8A8_UNORM;
-            swapchainInfo.sampleCount = 1;
-            swapchainInfo.width = m_viewConfigs[i].recommendedImageRectWidth;
-            swapchainInfo.height = m_viewConfigs[i].recommendedImageRectHeight;
-            swapchainInfo.arraySize = 1;
-            swapchainInfo.faceCount = 1;
-            swapchainInfo.mipCount = 1;
-
-            XrResult result = xrCreateSwapchain(m_session, &swapchainInfo, &m_swapchains[i].handle);
-            if (XR_FAILED(result))
-            {
-                Utils::LogError("OpenXR: Failed to create swapchain");
-                return false;
-            }
+            m_copyCacheDirty.store(true);
+        }
+    }
 
-            m_swapchains[i].width = swapchainInfo.width;
-            m_swapchains[i].height = swapchainInfo.height;
+    double frameSeconds = 0.0;
+    bool measured = m_outputTimer.Read(frameSeconds);
+    if (!m_outputScaleDynamic || !measured || displayPeriod <= 0)
+    {
+        return;
+    }
 
-            uint32_t imageCount;
-            xrEnumerateSwapchainImages(m_swapchains[i].handle, 0, &imageCount, nullptr);
-            m_swapchains[i].images.resize(imageCount, { XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR });
-            xrEnumerateSwapchainImages(m_swapchains[i].handle, imageCount, &imageCount,
-                (XrSwapchainImageBaseHeader*)m_swapchains[i].images.data());
+    bool changed = m_outputScaler.SetSourceLimit(GetSourceLimit(source));
 
-            char msg[128];
-            snprintf(msg, sizeof(msg), "OpenXR: Swapchain %u: %dx%d (%u images)",
-                     i, m_swapchains[i].width, m_swapchains[i].height, imageCount);
-            Utils::LogInfo(msg);
-        }
+    // Both eyes of a pair share the budget
+    double budgetSeconds = static_cast<double>(displayPeriod) * 1e-9 * VRConfig::GetOutputScaleBudget();
+    changed = m_outputScaler.Update(2.0 * frameSeconds, budgetSeconds) || changed;
 
-        return true;
+    if (changed && UpdateEyeExtents())
+    {
+        // Copy and resample lists are recorded against the extent
+        m_copyCacheDirty.store(true);
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: Output scale %.2f (%dx%d), copy cost %.2fms",
+                 m_outputScaler.GetScale(), m_eyeExtents[0].width, m_eyeExtents[0].height,
+                 m_outputScaler.GetAverageCost() * 1000.0);
+        Utils::LogInfo(msg);
     }
+}
 
-    bool CreateActionSystem()
+// Source resolution relative to the recommended size, for the smaller axis
+// of the tighter eye
+float VRSystem::Impl::GetSourceLimit(ID3D12Resource* source) const
+{
+    D3D12_RESOURCE_DESC desc = source->GetDesc();
+    float limit = 0.0f;
+    for (int eye = 0; eye < 2; eye++)
     {
-        // Create action set
-        XrActionSetCreateInfo actionSetInfo = { XR_TYPE_ACTION_SET_CREATE_INFO };
-        strcpy_s(actionSetInfo.actionSetName, "gameplay");
-        strcpy_s(actionSetInfo.localizedActionSetName, "Gameplay");
-        actionSetInfo.priority = 0;
-
-        if (XR_FAILED(xrCreateActionSet(m_instance, &actionSetInfo, &m_actionSet)))
+        const XrViewConfigurationView& view = m_viewConfigs[eye];
+        if (view.recommendedImageRectWidth == 0 || view.recommendedImageRectHeight == 0)
         {
-            Utils::LogWarn("OpenXR: Failed to create action set");
-            return false;
+            continue;
         }
+        float eyeLimit = std::min(static_cast<float>(desc.Width) / view.recommendedImageRectWidth,
+                                  static_cast<float>(desc.Height) / view.recommendedImageRectHeight);
+        limit = (limit > 0.0f) ? std::min(limit, eyeLimit) : eyeLimit;
+    }
+    return limit;
+}
+
+void VRSystem::Impl::ConfigurePerfLevels()
+{
+    for (int domain = 0; domain < 2; domain++)
+    {
+        m_perfControllers[domain].Configure(PerfLevels::Controller::Settings());
+        m_appliedNotifications[domain] = PerfLevels::Notification::Normal;
+        SetPerfLevel(domain);
+    }
+}
+
+void VRSystem::Impl::SetPerfLevel(int domainIndex)
+{
+    PerfLevels::Level level = m_perfControllers[domainIndex].GetLevel();
+    XrResult result = m_xrPerfSettingsSetPerformanceLevelEXT(
+        m_session, domainIndex == 0 ? XR_PERF_SETTINGS_DOMAIN_CPU_EXT : XR_PERF_SETTINGS_DOMAIN_GPU_EXT,
+        static_cast<XrPerfSettingsLevelEXT>(level));
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: %s performance level %s%s", domainIndex == 0 ? "CPU" : "GPU",
+             PerfLevels::ToString(level), XR_FAILED(result) ? " (rejected)" : "");
+    Utils::LogInfo(msg);
+}
+
+// Pacer thread: remember the latest level per sub-domain
+void VRSystem::Impl::RecordPerfNotification(const XrEventDataPerfSettingsEXT& perfEvent)
+{
+    uint32_t domain = static_cast<uint32_t>(perfEvent.domain) - 1;
+    uint32_t subDomain = static_cast<uint32_t>(perfEvent.subDomain) - 1;
+    if (domain >= 2 || subDomain >= 3)
+    {
+        return;
+    }
+    m_perfNotifications[domain][subDomain].store(static_cast<uint32_t>(perfEvent.toLevel));
 
-        // Setup hand paths
-        xrStringToPath(m_instance, "/user/hand/left", &m_handPaths[0]);
-        xrStringToPath(m_instance, "/user/hand/right", &m_handPaths[1]);
+    static const char* const subDomainNames[] = { "compositing", "rendering", "thermal" };
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: %s %s performance notification %d -> %d",
+             domain == 0 ? "CPU" : "GPU", subDomainNames[subDomain], perfEvent.fromLevel, perfEvent.toLevel);
+    Utils::LogInfo(msg);
+}
 
-        // Create actions
-        auto createAction = [&](XrAction& action, XrActionType type, const char* name, const char* locName, bool useSubactionPaths = true) -> bool
+// Render thread: cap the requested levels and, for the GPU, the output
+// scale while the runtime reports trouble
+void VRSystem::Impl::ApplyPerfNotifications()
+{
+    for (int domain = 0; domain < 2; domain++)
+    {
+        uint32_t worst = 0;
+        for (const std::atomic<uint32_t>& notification : m_perfNotifications[domain])
         {
-            XrActionCreateInfo info = { XR_TYPE_ACTION_CREATE_INFO };
-            info.actionType = type;
-            strcpy_s(info.actionName, name);
-            strcpy_s(info.localizedActionName, locName);
-            if (useSubactionPaths)
-            {
-                info.countSubactionPaths = 2;
-                info.subactionPaths = m_handPaths;
-            }
-            return XR_SUCCEEDED(xrCreateAction(m_actionSet, &info, &action));
-        };
+            worst = std::max(worst, notification.load());
+        }
 
-        createAction(m_triggerAction, XR_ACTION_TYPE_FLOAT_INPUT, "trigger", "Trigger");
-        createAction(m_gripAction, XR_ACTION_TYPE_FLOAT_INPUT, "grip", "Grip");
-        createAction(m_thumbstickAction, XR_ACTION_TYPE_VECTOR2F_INPUT, "thumbstick", "Thumbstick");
-        createAction(m_thumbstickClickAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "thumbstick_click", "Thumbstick Click");
-        createAction(m_primaryButtonAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "primary_button", "Primary Button (A/X)");
-        createAction(m_secondaryButtonAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "secondary_button", "Secondary Button (B/Y)");
-        createAction(m_menuButtonAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "menu", "Menu Button", false);
-        createAction(m_handPoseAction, XR_ACTION_TYPE_POSE_INPUT, "hand_pose", "Hand Pose");
+        auto level = static_cast<PerfLevels::Notification>(worst);
+        if (level == m_appliedNotifications[domain])
+        {
+            continue;
+        }
+        m_appliedNotifications[domain] = level;
 
-        // Suggest bindings for common controllers
-        std::vector<XrActionSuggestedBinding> bindings;
+        if (m_perfControllers[domain].Notify(level))
+        {
+            SetPerfLevel(domain);
+        }
 
-        auto addBinding = [&](XrAction action, const char* path)
+        if (domain == 1)
         {
-            XrPath bindingPath;
-            if (XR_SUCCEEDED(xrStringToPath(m_instance, path, &bindingPath)))
+            // Warning: stop growing; impaired: shed a step now
+            float ceiling = 0.0f;
+            if (level == PerfLevels::Notification::Warning)
             {
-                bindings.push_back({ action, bindingPath });
+                ceiling = m_outputScaler.GetScale();
             }
-        };
-
-        // Oculus Touch bindings
-        addBinding(m_triggerAction, "/user/hand/left/input/trigger/value");
-        addBinding(m_triggerAction, "/user/hand/right/input/trigger/value");
-        addBinding(m_gripAction, "/user/hand/left/input/squeeze/value");
-        addBinding(m_gripAction, "/user/hand/right/input/squeeze/value");
-        addBinding(m_thumbstickAction, "/user/hand/left/input/thumbstick");
-        addBinding(m_thumbstickAction, "/user/hand/right/input/thumbstick");
-        addBinding(m_thumbstickClickAction, "/user/hand/left/input/thumbstick/click");
-        addBinding(m_thumbstickClickAction, "/user/hand/right/input/thumbstick/click");
-        addBinding(m_primaryButtonAction, "/user/hand/left/input/x/click");
-        addBinding(m_primaryButtonAction, "/user/hand/right/input/a/click");
-        addBinding(m_secondaryButtonAction, "/user/hand/left/input/y/click");
-        addBinding(m_secondaryButtonAction, "/user/hand/right/input/b/click");
-        addBinding(m_menuButtonAction, "/user/hand/left/input/menu/click");
-        addBinding(m_handPoseAction, "/user/hand/left/input/grip/pose");
-        addBinding(m_handPoseAction, "/user/hand/right/input/grip/pose");
-
-        // Try Oculus Touch profile
-        XrPath oculusProfile;
-        if (XR_SUCCEEDED(xrStringToPath(m_instance, "/interaction_profiles/oculus/touch_controller", &oculusProfile)))
-        {
-            XrInteractionProfileSuggestedBinding suggestedBindings = { XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
-            suggestedBindings.interactionProfile = oculusProfile;
-            suggestedBindings.suggestedBindings = bindings.data();
-            suggestedBindings.countSuggestedBindings = static_cast<uint32_t>(bindings.size());
-
-            XrResult result = xrSuggestInteractionProfileBindings(m_instance, &suggestedBindings);
-            if (XR_FAILED(result))
+            else if (level == PerfLevels::Notification::Impaired)
             {
-                Utils::LogWarn("OpenXR: Failed to suggest Oculus bindings");
+                ceiling = m_outputScaler.GetScale() * 0.9f;
             }
-        }
 
-        // Try Valve Index profile with different paths
-        bindings.clear();
-        addBinding(m_triggerAction, "/user/hand/left/input/trigger/value");
-        addBinding(m_triggerAction, "/user/hand/right/input/trigger/value");
-        addBinding(m_gripAction, "/user/hand/left/input/squeeze/value");
-        addBinding(m_gripAction, "/user/hand/right/input/squeeze/value");
-        addBinding(m_thumbstickAction, "/user/hand/left/input/thumbstick");
-        addBinding(m_thumbstickAction, "/user/hand/right/input/thumbstick");
-        addBinding(m_thumbstickClickAction, "/user/hand/left/input/thumbstick/click");
-        addBinding(m_thumbstickClickAction, "/user/hand/right/input/thumbstick/click");
-        addBinding(m_primaryButtonAction, "/user/hand/left/input/a/click");
-        addBinding(m_primaryButtonAction, "/user/hand/right/input/a/click");
-        addBinding(m_secondaryButtonAction, "/user/hand/left/input/b/click");
-        addBinding(m_secondaryButtonAction, "/user/hand/right/input/b/click");
-        addBinding(m_menuButtonAction, "/user/hand/left/input/system/click");
-        addBinding(m_handPoseAction, "/user/hand/left/input/grip/pose");
-        addBinding(m_handPoseAction, "/user/hand/right/input/grip/pose");
-
-        XrPath indexProfile;
-        if (XR_SUCCEEDED(xrStringToPath(m_instance, "/interaction_profiles/valve/index_controller", &indexProfile)))
-        {
-            XrInteractionProfileSuggestedBinding suggestedBindings = { XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
-            suggestedBindings.interactionProfile = indexProfile;
-            suggestedBindings.suggestedBindings = bindings.data();
-            suggestedBindings.countSuggestedBindings = static_cast<uint32_t>(bindings.size());
-
-            XrResult result = xrSuggestInteractionProfileBindings(m_instance, &suggestedBindings);
-            if (XR_FAILED(result))
+            if (m_outputScaler.SetCeiling(ceiling) && m_outputScaleDynamic && UpdateEyeExtents())
             {
-                Utils::LogWarn("OpenXR: Failed to suggest Index bindings");
+                m_copyCacheDirty.store(true);
+
+                char msg[128];
+                snprintf(msg, sizeof(msg), "OpenXR: GPU impaired - output scale %.2f", m_outputScaler.GetScale());
+                Utils::LogInfo(msg);
             }
         }
+    }
+}
 
-        Utils::LogInfo("OpenXR: Action system created");
-        return true;
+// Called once per frame pair, after xrEndFrame
+// GPU load is the queue-span time of the game's frames (see ReadGpuTime): a
+// GPU left idle between submissions by a slow CPU reads low however long the
+// frame took, while waits inside a frame read as load; 0 while nothing was
+// measured, which holds the GPU level
+void VRSystem::Impl::UpdatePerfLevels(double pairCostSeconds, double gpuSeconds, XrDuration displayPeriod)
+{
+    if (!m_perfSettingsSupported)
+    {
+        return;
     }
 
-    bool AttachActionSet()
+    ApplyPerfNotifications();
+
+    if (displayPeriod <= 0 || pairCostSeconds <= 0.0)
     {
-        if (!m_session || !m_actionSet) return false;
+        return;
+    }
 
-        XrSessionActionSetsAttachInfo attachInfo = { XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO };
-        attachInfo.countActionSets = 1;
-        attachInfo.actionSets = &m_actionSet;
+    double budgetSeconds = static_cast<double>(displayPeriod) * 1e-9;
 
-        XrResult result = xrAttachSessionActionSets(m_session, &attachInfo);
-        if (XR_FAILED(result))
-        {
-            Utils::LogWarn("OpenXR: Failed to attach action sets");
-            return false;
-        }
+    // A frame that takes as long as its GPU work is paced by the GPU: the
+    // CPU's own share of it is not known, so the CPU level is held
+    bool gpuBound = gpuSeconds > 0.9 * pairCostSeconds;
+    double loads[2] = {
+        gpuBound ? 0.0 : pairCostSeconds / budgetSeconds,
+        gpuSeconds / budgetSeconds,
+    };
 
-        // Create hand spaces for pose tracking
-        for (int i = 0; i < 2; i++)
+    for (int domain = 0; domain < 2; domain++)
+    {
+        if (m_perfControllers[domain].Update(loads[domain]))
         {
-            XrActionSpaceCreateInfo spaceInfo = { XR_TYPE_ACTION_SPACE_CREATE_INFO };
-            spaceInfo.action = m_handPoseAction;
-            spaceInfo.subactionPath = m_handPaths[i];
-            spaceInfo.poseInActionSpace.orientation.w = 1.0f;
-
-            if (XR_FAILED(xrCreateActionSpace(m_session, &spaceInfo, &m_handSpaces[i])))
-            {
-                Utils::LogWarn("OpenXR: Failed to create hand space");
-            }
+            SetPerfLevel(domain);
         }
+    }
+}
 
-        Utils::LogInfo("OpenXR: Action sets attached");
-        return true;
+// Game threads, before the lists reach the queue: the first submission on
+// the present queue after a Present opens the frame's span
+void VRSystem::Impl::BeginGpuTime(ID3D12CommandQueue* queue)
+{
+    if (!m_gameTimer.IsOpen() && m_gameTimer.IsTimed(queue))
+    {
+        m_gameTimer.Begin();
     }
+}
+
+// Render thread, once per frame pair: queue-span time of the game's recent
+// frames for two frames; 0 if none finished
+double VRSystem::Impl::ReadGpuTime()
+{
+    double frameSeconds = 0.0;
+    return m_gameTimer.Read(frameSeconds) ? 2.0 * frameSeconds : 0.0;
+}
 
-    void SyncActions(XrTime predictedTime)
+void VRSystem::Impl::ConfigureRefreshRates()
+{
+    uint32_t count = 0;
+    std::vector<float> rates;
+    if (XR_SUCCEEDED(m_xrEnumerateDisplayRefreshRatesFB(m_session, 0, &count, nullptr)) && count > 0)
     {
-        if (!m_session || !m_actionSet) return;
+        rates.resize(count);
+        if (XR_FAILED(m_xrEnumerateDisplayRefreshRatesFB(m_session, count, &count, rates.data())))
+        {
+            count = 0;
+        }
+        rates.resize(count);
+    }
 
-        XrActiveActionSet activeSet = {};
-        activeSet.actionSet = m_actionSet;
-        activeSet.subactionPath = XR_NULL_PATH;
+    float current = 0.0f;
+    if (rates.empty() || XR_FAILED(m_xrGetDisplayRefreshRateFB(m_session, &current)))
+    {
+        Utils::LogWarn("OpenXR: Display refresh rates not available - keeping the runtime's rate");
+        m_refreshRateSupported = false;
+        return;
+    }
 
-        XrActionsSyncInfo syncInfo = { XR_TYPE_ACTIONS_SYNC_INFO };
-        syncInfo.countActiveActionSets = 1;
-        syncInfo.activeActionSets = &activeSet;
+    std::sort(rates.begin(), rates.end());
+    VRConfig::SetRefreshRates(rates.data(), static_cast<uint32_t>(rates.size()));
+    VRConfig::SetDisplayRefreshRate(current);
+    m_refreshRates = rates;
+    m_refreshRateSelector.Configure(RefreshRate::Selector::Settings(), m_refreshRates);
+    m_appliedRefreshRequest = 0.0f;
 
-        if (XR_FAILED(xrSyncActions(m_session, &syncInfo)))
+    char msg[128];
+    int length = snprintf(msg, sizeof(msg), "OpenXR: Display refresh %.0f Hz, available", current);
+    for (float rate : rates)
+    {
+        if (length > 0 && length < static_cast<int>(sizeof(msg)))
         {
-            return;
+            length += snprintf(msg + length, sizeof(msg) - length, " %.0f", rate);
         }
+    }
+    Utils::LogInfo(msg);
+}
 
-        // Read trigger values
-        for (int hand = 0; hand < 2; hand++)
-        {
-            XrActionStateFloat triggerState = { XR_TYPE_ACTION_STATE_FLOAT };
-            XrActionStateGetInfo getInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-            getInfo.action = m_triggerAction;
-            getInfo.subactionPath = m_handPaths[hand];
+void VRSystem::Impl::RequestRefreshRate(float rate, const char* reason)
+{
+    XrResult result = m_xrRequestDisplayRefreshRateFB(m_session, rate);
 
-            if (XR_SUCCEEDED(xrGetActionStateFloat(m_session, &getInfo, &triggerState)) && triggerState.isActive)
-            {
-                if (hand == 0)
-                    m_controllerState.leftTrigger = triggerState.currentState;
-                else
-                    m_controllerState.rightTrigger = triggerState.currentState;
-            }
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Requesting %.0f Hz display refresh (%s)%s", rate, reason,
+             XR_FAILED(result) ? " - rejected" : "");
+    Utils::LogInfo(msg);
+}
 
-            // Grip
-            XrActionStateFloat gripState = { XR_TYPE_ACTION_STATE_FLOAT };
-            getInfo.action = m_gripAction;
-            if (XR_SUCCEEDED(xrGetActionStateFloat(m_session, &getInfo, &gripState)) && gripState.isActive)
-            {
-                if (hand == 0)
-                    m_controllerState.leftGrip = gripState.currentState;
-                else
-                    m_controllerState.rightGrip = gripState.currentState;
-            }
+// Called every present with the present-to-present interval
+// A fixed rate from the overlay is requested once; otherwise the selector
+// picks the rate that fits the measured frame rate
+void VRSystem::Impl::UpdateRefreshRate(double presentIntervalSeconds)
+{
+    if (!m_refreshRateSupported)
+    {
+        return;
+    }
 
-            // Thumbstick
-            XrActionStateVector2f thumbState = { XR_TYPE_ACTION_STATE_VECTOR2F };
-            getInfo.action = m_thumbstickAction;
-            if (XR_SUCCEEDED(xrGetActionStateVector2f(m_session, &getInfo, &thumbState)) && thumbState.isActive)
+    float fixedRate = VRConfig::GetRefreshRateRequest();
+    if (fixedRate != m_appliedRefreshRequest)
+    {
+        m_appliedRefreshRequest = fixedRate;
+        if (fixedRate > 0.0f)
+        {
+            RequestRefreshRate(fixedRate, "overlay");
+        }
+        else
+        {
+            // Back to automatic: start measuring afresh
+            m_refreshRateSelector.Configure(RefreshRate::Selector::Settings(), m_refreshRates);
+        }
+    }
+    if (fixedRate > 0.0f)
+    {
+        return;
+    }
+
+    // One OpenXR frame per eye pair unless every present ends one
+    uint32_t presentsPerFrame = IsEveryFrameSubmit() ? 1 : 2;
+    float rate = m_refreshRateSelector.Update(presentIntervalSeconds, presentsPerFrame,
+                                              VRConfig::GetDisplayRefreshRate());
+    if (rate > 0.0f)
+    {
+        char reason[64];
+        snprintf(reason, sizeof(reason), "game at %.1f fps",
+                 m_refreshRateSelector.GetContentRate(presentsPerFrame));
+        RequestRefreshRate(rate, reason);
+    }
+}
+
+// Pick the swapchain format from the runtime's list so that the back buffer
+// can be copied as-is whenever possible. Preference order:
+//   1. sRGB twin of the back buffer (same bytes, runtime decodes them correctly)
+//   2. the back buffer format itself
+//   3. any other format in the same copy-compatible family
+//   4. the runtime's first format the resample pass can convert into
+DXGI_FORMAT VRSystem::Impl::SelectSwapchainFormat()
+{
+    // Before the first Present the game's format is unknown; assume 8-bit RGBA
+    DXGI_FORMAT backBuffer = m_backBufferFormat != DXGI_FORMAT_UNKNOWN ? m_backBufferFormat : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    std::vector<int64_t> formats = EnumerateSwapchainFormats();
+    if (formats.empty())
+    {
+        Utils::LogWarn("OpenXR: Could not enumerate swapchain formats, using R8G8B8A8_UNORM");
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+
+    auto isSupported = [&](DXGI_FORMAT format) {
+        return format != DXGI_FORMAT_UNKNOWN &&
+               std::find(formats.begin(), formats.end(), static_cast<int64_t>(format)) != formats.end();
+    };
+
+    DXGI_FORMAT selected = DXGI_FORMAT_UNKNOWN;
+    const char* reason = "copy";
+
+    if (isSupported(FormatUtils::GetSrgbFormat(backBuffer)))
+    {
+        selected = FormatUtils::GetSrgbFormat(backBuffer);
+    }
+    else if (isSupported(backBuffer))
+    {
+        selected = backBuffer;
+    }
+    else
+    {
+        for (int64_t format : formats)
+        {
+            if (FormatUtils::IsCopyCompatible(static_cast<DXGI_FORMAT>(format), backBuffer))
             {
-                if (hand == 0)
-                {
-                    m_controllerState.leftThumbX = thumbState.currentState.x;
-                    m_controllerState.leftThumbY = thumbState.currentState.y;
-                }
-                else
-                {
-                    m_controllerState.rightThumbX = thumbState.currentState.x;
-                    m_controllerState.rightThumbY = thumbState.currentState.y;
-                }
+                selected = static_cast<DXGI_FORMAT>(format);
+                break;
             }
+        }
+    }
 
-            // Thumbstick click
-            XrActionStateBoolean thumbClickState = { XR_TYPE_ACTION_STATE_BOOLEAN };
-            getInfo.action = m_thumbstickClickAction;
-            if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &getInfo, &thumbClickState)) && thumbClickState.isActive)
+    if (selected == DXGI_FORMAT_UNKNOWN)
+    {
+        reason = "convert";
+        for (int64_t format : formats)
+        {
+            if (FormatUtils::IsResampleTarget(static_cast<DXGI_FORMAT>(format)))
             {
-                if (hand == 0 && thumbClickState.currentState)
-                    m_controllerState.buttons |= VRControllerState::BUTTON_LEFT_THUMB;
-                else if (hand == 1 && thumbClickState.currentState)
-                    m_controllerState.buttons |= VRControllerState::BUTTON_RIGHT_THUMB;
+                selected = static_cast<DXGI_FORMAT>(format);
+                break;
             }
+        }
+    }
+
+    if (selected == DXGI_FORMAT_UNKNOWN)
+    {
+        Utils::LogWarn("OpenXR: No usable swapchain format offered, using R8G8B8A8_UNORM");
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Back buffer format %d, swapchain format %d (%s)",
+             static_cast<int>(backBuffer), static_cast<int>(selected), reason);
+    Utils::LogInfo(msg);
+    return selected;
+}
+
+std::vector<int64_t> VRSystem::Impl::EnumerateSwapchainFormats() const
+{
+    uint32_t formatCount = 0;
+    xrEnumerateSwapchainFormats(m_session, 0, &formatCount, nullptr);
+    std::vector<int64_t> formats(formatCount);
+    if (formatCount == 0 || XR_FAILED(xrEnumerateSwapchainFormats(m_session, formatCount, &formatCount, formats.data())))
+    {
+        formats.clear();
+    }
+    return formats;
+}
+
+bool VRSystem::Impl::CreateSwapchain(SwapchainInfo& swapchain, uint32_t width, uint32_t height, uint32_t arraySize)
+{
+    XrSwapchainUsageFlags usageFlags = XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT | XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT |
+                                       XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT;
+    if (FormatUtils::IsSrgbFormat(m_swapchainFormat))
+    {
+        // Lets the resample pass write through a UNORM UAV
+        usageFlags |= XR_SWAPCHAIN_USAGE_MUTABLE_FORMAT_BIT;
+    }
+    return CreateSwapchain(swapchain, m_swapchainFormat, usageFlags, width, height, arraySize);
+}
+
+bool VRSystem::Impl::CreateSwapchain(SwapchainInfo& swapchain, DXGI_FORMAT format, XrSwapchainUsageFlags usageFlags,
+                                     uint32_t width, uint32_t height, uint32_t arraySize)
+{
+    XrSwapchainCreateInfo swapchainInfo = { XR_TYPE_SWAPCHAIN_CREATE_INFO };
+    swapchainInfo.usageFlags = usageFlags;
+    swapchainInfo.format = format;
+    swapchainInfo.sampleCount = 1;
+    swapchainInfo.width = width;
+    swapchainInfo.height = height;
+    swapchainInfo.arraySize = arraySize;
+    swapchainInfo.faceCount = 1;
+    swapchainInfo.mipCount = 1;
+
+    XrResult result = xrCreateSwapchain(m_session, &swapchainInfo, &swapchain.handle);
+    if (XR_FAILED(result))
+    {
+        swapchain.handle = XR_NULL_HANDLE;
+        Utils::LogError("OpenXR: Failed to create swapchain");
+        return false;
+    }
+
+    swapchain.width = swapchainInfo.width;
+    swapchain.height = swapchainInfo.height;
+    swapchain.arraySize = arraySize;
+
+    uint32_t imageCount;
+    xrEnumerateSwapchainImages(swapchain.handle, 0, &imageCount, nullptr);
+    swapchain.images.resize(imageCount, { XR_TYPE_SWAPCHAIN_IMAGE_D3D12_KHR });
+    xrEnumerateSwapchainImages(swapchain.handle, imageCount, &imageCount,
+        (XrSwapchainImageBaseHeader*)swapchain.images.data());
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Swapchain %dx%d, %u layer(s) (%u images)",
+             swapchain.width, swapchain.height, arraySize, imageCount);
+    Utils::LogInfo(msg);
+    return true;
+}
+
+bool VRSystem::Impl::CreateActionSystem()
+{
+    // Create action set
+    XrActionSetCreateInfo actionSetInfo = { XR_TYPE_ACTION_SET_CREATE_INFO };
+    strcpy_s(actionSetInfo.actionSetName, "gameplay");
+    strcpy_s(actionSetInfo.localizedActionSetName, "Gameplay");
+    actionSetInfo.priority = 0;
+
+    if (XR_FAILED(xrCreateActionSet(m_instance, &actionSetInfo, &m_actionSet)))
+    {
+        Utils::LogWarn("OpenXR: Failed to create action set");
+        return false;
+    }
+
+    // Setup hand paths
+    xrStringToPath(m_instance, "/user/hand/left", &m_handPaths[0]);
+    xrStringToPath(m_instance, "/user/hand/right", &m_handPaths[1]);
+
+    // Create actions
+    auto createAction = [&](XrAction& action, XrActionType type, const char* name, const char* locName, bool useSubactionPaths = true) -> bool
+    {
+        XrActionCreateInfo info = { XR_TYPE_ACTION_CREATE_INFO };
+        info.actionType = type;
+        strcpy_s(info.actionName, name);
+        strcpy_s(info.localizedActionName, locName);
+        if (useSubactionPaths)
+        {
+            info.countSubactionPaths = 2;
+            info.subactionPaths = m_handPaths;
+        }
+        return XR_SUCCEEDED(xrCreateAction(m_actionSet, &info, &action));
+    };
+
+    createAction(m_triggerAction, XR_ACTION_TYPE_FLOAT_INPUT, "trigger", "Trigger");
+    createAction(m_gripAction, XR_ACTION_TYPE_FLOAT_INPUT, "grip", "Grip");
+    createAction(m_thumbstickAction, XR_ACTION_TYPE_VECTOR2F_INPUT, "thumbstick", "Thumbstick");
+    createAction(m_thumbstickClickAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "thumbstick_click", "Thumbstick Click");
+    createAction(m_primaryButtonAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "primary_button", "Primary Button (A/X)");
+    createAction(m_secondaryButtonAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "secondary_button", "Secondary Button (B/Y)");
+    createAction(m_menuButtonAction, XR_ACTION_TYPE_BOOLEAN_INPUT, "menu", "Menu Button", false);
+    createAction(m_handPoseAction, XR_ACTION_TYPE_POSE_INPUT, "hand_pose", "Hand Pose");
+
+    // Suggest bindings for common controllers
+    std::vector<XrActionSuggestedBinding> bindings;
+
+    auto addBinding = [&](XrAction action, const char* path)
+    {
+        XrPath bindingPath;
+        if (XR_SUCCEEDED(xrStringToPath(m_instance, path, &bindingPath)))
+        {
+            bindings.push_back({ action, bindingPath });
+        }
+    };
+
+    // Oculus Touch bindings
+    addBinding(m_triggerAction, "/user/hand/left/input/trigger/value");
+    addBinding(m_triggerAction, "/user/hand/right/input/trigger/value");
+    addBinding(m_gripAction, "/user/hand/left/input/squeeze/value");
+    addBinding(m_gripAction, "/user/hand/right/input/squeeze/value");
+    addBinding(m_thumbstickAction, "/user/hand/left/input/thumbstick");
+    addBinding(m_thumbstickAction, "/user/hand/right/input/thumbstick");
+    addBinding(m_thumbstickClickAction, "/user/hand/left/input/thumbstick/click");
+    addBinding(m_thumbstickClickAction, "/user/hand/right/input/thumbstick/click");
+    addBinding(m_primaryButtonAction, "/user/hand/left/input/x/click");
+    addBinding(m_primaryButtonAction, "/user/hand/right/input/a/click");
+    addBinding(m_secondaryButtonAction, "/user/hand/left/input/y/click");
+    addBinding(m_secondaryButtonAction, "/user/hand/right/input/b/click");
+    addBinding(m_menuButtonAction, "/user/hand/left/input/menu/click");
+    addBinding(m_handPoseAction, "/user/hand/left/input/grip/pose");
+    addBinding(m_handPoseAction, "/user/hand/right/input/grip/pose");
+
+    // Try Oculus Touch profile
+    XrPath oculusProfile;
+    if (XR_SUCCEEDED(xrStringToPath(m_instance, "/interaction_profiles/oculus/touch_controller", &oculusProfile)))
+    {
+        XrInteractionProfileSuggestedBinding suggestedBindings = { XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
+        suggestedBindings.interactionProfile = oculusProfile;
+        suggestedBindings.suggestedBindings = bindings.data();
+        suggestedBindings.countSuggestedBindings = static_cast<uint32_t>(bindings.size());
+
+        XrResult result = xrSuggestInteractionProfileBindings(m_instance, &suggestedBindings);
+        if (XR_FAILED(result))
+        {
+            Utils::LogWarn("OpenXR: Failed to suggest Oculus bindings");
+        }
+    }
+
+    // Try Valve Index profile with different paths
+    bindings.clear();
+    addBinding(m_triggerAction, "/user/hand/left/input/trigger/value");
+    addBinding(m_triggerAction, "/user/hand/right/input/trigger/value");
+    addBinding(m_gripAction, "/user/hand/left/input/squeeze/value");
+    addBinding(m_gripAction, "/user/hand/right/input/squeeze/value");
+    addBinding(m_thumbstickAction, "/user/hand/left/input/thumbstick");
+    addBinding(m_thumbstickAction, "/user/hand/right/input/thumbstick");
+    addBinding(m_thumbstickClickAction, "/user/hand/left/input/thumbstick/click");
+    addBinding(m_thumbstickClickAction, "/user/hand/right/input/thumbstick/click");
+    addBinding(m_primaryButtonAction, "/user/hand/left/input/a/click");
+    addBinding(m_primaryButtonAction, "/user/hand/right/input/a/click");
+    addBinding(m_secondaryButtonAction, "/user/hand/left/input/b/click");
+    addBinding(m_secondaryButtonAction, "/user/hand/right/input/b/click");
+    addBinding(m_menuButtonAction, "/user/hand/left/input/system/click");
+    addBinding(m_handPoseAction, "/user/hand/left/input/grip/pose");
+    addBinding(m_handPoseAction, "/user/hand/right/input/grip/pose");
+
+    XrPath indexProfile;
+    if (XR_SUCCEEDED(xrStringToPath(m_instance, "/interaction_profiles/valve/index_controller", &indexProfile)))
+    {
+        XrInteractionProfileSuggestedBinding suggestedBindings = { XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING };
+        suggestedBindings.interactionProfile = indexProfile;
+        suggestedBindings.suggestedBindings = bindings.data();
+        suggestedBindings.countSuggestedBindings = static_cast<uint32_t>(bindings.size());
+
+        XrResult result = xrSuggestInteractionProfileBindings(m_instance, &suggestedBindings);
+        if (XR_FAILED(result))
+        {
+            Utils::LogWarn("OpenXR: Failed to suggest Index bindings");
+        }
+    }
+
+    Utils::LogInfo("OpenXR: Action system created");
+    return true;
+}
+
+bool VRSystem::Impl::AttachActionSet()
+{
+    if (!m_session || !m_actionSet) return false;
+
+    XrSessionActionSetsAttachInfo attachInfo = { XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO };
+    attachInfo.countActionSets = 1;
+    attachInfo.actionSets = &m_actionSet;
+
+    XrResult result = xrAttachSessionActionSets(m_session, &attachInfo);
+    if (XR_FAILED(result))
+    {
+        Utils::LogWarn("OpenXR: Failed to attach action sets");
+        return false;
+    }
+
+    // Create hand spaces for pose tracking
+    for (int i = 0; i < 2; i++)
+    {
+        XrActionSpaceCreateInfo spaceInfo = { XR_TYPE_ACTION_SPACE_CREATE_INFO };
+        spaceInfo.action = m_handPoseAction;
+        spaceInfo.subactionPath = m_handPaths[i];
+        spaceInfo.poseInActionSpace.orientation.w = 1.0f;
+
+        if (XR_FAILED(xrCreateActionSpace(m_session, &spaceInfo, &m_handSpaces[i])))
+        {
+            Utils::LogWarn("OpenXR: Failed to create hand space");
+        }
+    }
+
+    Utils::LogInfo("OpenXR: Action sets attached");
+    return true;
+}
+
+void VRSystem::Impl::SyncActions(XrTime predictedTime)
+{
+    if (!m_session || !m_actionSet) return;
+
+    XrActiveActionSet activeSet = {};
+    activeSet.actionSet = m_actionSet;
+    activeSet.subactionPath = XR_NULL_PATH;
+
+    XrActionsSyncInfo syncInfo = { XR_TYPE_ACTIONS_SYNC_INFO };
+    syncInfo.countActiveActionSets = 1;
+    syncInfo.activeActionSets = &activeSet;
+
+    if (XR_FAILED(xrSyncActions(m_session, &syncInfo)))
+    {
+        return;
+    }
 
-            // Primary button (A/X)
-            XrActionStateBoolean primaryState = { XR_TYPE_ACTION_STATE_BOOLEAN };
-            getInfo.action = m_primaryButtonAction;
-            if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &getInfo, &primaryState)) && primaryState.isActive)
+    // Built in a local and published whole, so the input hook never sees a
+    // half-updated state; inactive actions keep their last value
+    VRControllerState state = m_controllerState;
+    state.buttons = 0;
+
+    // Read trigger values
+    for (int hand = 0; hand < 2; hand++)
+    {
+        XrActionStateFloat triggerState = { XR_TYPE_ACTION_STATE_FLOAT };
+        XrActionStateGetInfo getInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
+        getInfo.action = m_triggerAction;
+        getInfo.subactionPath = m_handPaths[hand];
+
+        if (XR_SUCCEEDED(xrGetActionStateFloat(m_session, &getInfo, &triggerState)) && triggerState.isActive)
+        {
+            if (hand == 0)
+                state.leftTrigger = triggerState.currentState;
+            else
+                state.rightTrigger = triggerState.currentState;
+        }
+
+        // Grip
+        XrActionStateFloat gripState = { XR_TYPE_ACTION_STATE_FLOAT };
+        getInfo.action = m_gripAction;
+        if (XR_SUCCEEDED(xrGetActionStateFloat(m_session, &getInfo, &gripState)) && gripState.isActive)
+        {
+            if (hand == 0)
+                state.leftGrip = gripState.currentState;
+            else
+                state.rightGrip = gripState.currentState;
+        }
+
+        // Thumbstick
+        XrActionStateVector2f thumbState = { XR_TYPE_ACTION_STATE_VECTOR2F };
+        getInfo.action = m_thumbstickAction;
+        if (XR_SUCCEEDED(xrGetActionStateVector2f(m_session, &getInfo, &thumbState)) && thumbState.isActive)
+        {
+            if (hand == 0)
             {
-                if (hand == 0 && primaryState.currentState)
-                    m_controllerState.buttons |= VRControllerState::BUTTON_X;
-                else if (hand == 1 && primaryState.currentState)
-                    m_controllerState.buttons |= VRControllerState::BUTTON_A;
+                state.leftThumbX = thumbState.currentState.x;
+                state.leftThumbY = thumbState.currentState.y;
             }
-
-            // Secondary button (B/Y)
-            XrActionStateBoolean secondaryState = { XR_TYPE_ACTION_STATE_BOOLEAN };
-            getInfo.action = m_secondaryButtonAction;
-            if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &getInfo, &secondaryState)) && secondaryState.isActive)
+            else
             {
-                if (hand == 0 && secondaryState.currentState)
-                    m_controllerState.buttons |= VRControllerState::BUTTON_Y;
-                else if (hand == 1 && secondaryState.currentState)
-                    m_controllerState.buttons |= VRControllerState::BUTTON_B;
+                state.rightThumbX = thumbState.currentState.x;
+                state.rightThumbY = thumbState.currentState.y;
             }
+        }
+
+        // Thumbstick click
+        XrActionStateBoolean thumbClickState = { XR_TYPE_ACTION_STATE_BOOLEAN };
+        getInfo.action = m_thumbstickClickAction;
+        if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &getInfo, &thumbClickState)) && thumbClickState.isActive)
+        {
+            if (hand == 0 && thumbClickState.currentState)
+                state.buttons |= VRControllerState::BUTTON_LEFT_THUMB;
+            else if (hand == 1 && thumbClickState.currentState)
+                state.buttons |= VRControllerState::BUTTON_RIGHT_THUMB;
+        }
+
+        // Primary button (A/X)
+        XrActionStateBoolean primaryState = { XR_TYPE_ACTION_STATE_BOOLEAN };
+        getInfo.action = m_primaryButtonAction;
+        if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &getInfo, &primaryState)) && primaryState.isActive)
+        {
+            if (hand == 0 && primaryState.currentState)
+                state.buttons |= VRControllerState::BUTTON_X;
+            else if (hand == 1 && primaryState.currentState)
+                state.buttons |= VRControllerState::BUTTON_A;
+        }
+
+        // Secondary button (B/Y)
+        XrActionStateBoolean secondaryState = { XR_TYPE_ACTION_STATE_BOOLEAN };
+        getInfo.action = m_secondaryButtonAction;
+        if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &getInfo, &secondaryState)) && secondaryState.isActive)
+        {
+            if (hand == 0 && secondaryState.currentState)
+                state.buttons |= VRControllerState::BUTTON_Y;
+            else if (hand == 1 && secondaryState.currentState)
+                state.buttons |= VRControllerState::BUTTON_B;
+        }
 
-            // Hand tracking - get full pose for motion aiming
-            if (m_handSpaces[hand] != XR_NULL_HANDLE)
+        // Hand tracking - get full pose for motion aiming
+        if (m_handSpaces[hand] != XR_NULL_HANDLE)
+        {
+            XrSpaceLocation handLoc = { XR_TYPE_SPACE_LOCATION };
+            if (XR_SUCCEEDED(xrLocateSpace(m_handSpaces[hand], m_appSpace, predictedTime, &handLoc)))
             {
-                XrSpaceLocation handLoc = { XR_TYPE_SPACE_LOCATION };
-                if (XR_SUCCEEDED(xrLocateSpace(m_handSpaces[hand], m_appSpace, predictedTime, &handLoc)))
+                bool posValid = (handLoc.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0;
+                bool oriValid = (handLoc.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
+                bool valid = posValid && oriValid;
+
+                VRHandPose* handPose = (hand == 0) ? &state.leftHand : &state.rightHand;
+                handPose->valid = valid;
+
+                if (valid)
                 {
-                    bool posValid = (handLoc.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0;
-                    bool oriValid = (handLoc.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0;
-                    bool valid = posValid && oriValid;
-
-                    VRHandPose* handPose = (hand == 0) ? &m_controllerState.leftHand : &m_controllerState.rightHand;
-                    handPose->valid = valid;
-
-                    if (valid)
-                    {
-                        // Convert position from OpenXR to game coordinates
-                        float worldScale = VRConfig::GetWorldScale();
-                        CoordinateConversion::OpenXRToRED(
-                            handLoc.pose.position.x * worldScale,
-                            handLoc.pose.position.y * worldScale,
-                            handLoc.pose.position.z * worldScale,
-                            handPose->x, handPose->y, handPose->z
-                        );
-
-                        // Convert orientation from OpenXR to game coordinates
-                        CoordinateConversion::OpenXRQuatToRED(
-                            handLoc.pose.orientation.x,
-                            handLoc.pose.orientation.y,
-                            handLoc.pose.orientation.z,
-                            handLoc.pose.orientation.w,
-                            handPose->qx, handPose->qy, handPose->qz, handPose->qw
-                        );
-
-                        // Calculate aim direction from quaternion (forward vector)
-                        // Forward in OpenXR is -Z, we need to transform this
-                        float qx = handPose->qx, qy = handPose->qy, qz = handPose->qz, qw = handPose->qw;
-
-                        // Rotate forward vector (0, 1, 0) in game space by quaternion
-                        // Using quaternion rotation: v' = q * v * q^-1
-                        // Simplified for unit forward vector:
-                        handPose->aimX = 2.0f * (qx * qy + qw * qz);
-                        handPose->aimY = 1.0f - 2.0f * (qx * qx + qz * qz);
-                        handPose->aimZ = 2.0f * (qy * qz - qw * qx);
-
-                        // Calculate yaw and pitch angles (degrees)
-                        // Yaw: rotation around Z axis (up)
-                        // Pitch: rotation around X axis (right)
-                        handPose->yaw = std::atan2(handPose->aimX, handPose->aimY) * (180.0f / 3.14159265f);
-                        handPose->pitch = std::asin(-handPose->aimZ) * (180.0f / 3.14159265f);
-                    }
-
-                    if (hand == 0)
-                        m_controllerState.leftHandValid = valid;
-                    else
-                        m_controllerState.rightHandValid = valid;
+                    // Convert position from OpenXR to game coordinates
+                    float worldScale = VRConfig::GetWorldScale();
+                    CoordinateConversion::OpenXRToRED(
+                        handLoc.pose.position.x * worldScale,
+                        handLoc.pose.position.y * worldScale,
+                        handLoc.pose.position.z * worldScale,
+                        handPose->x, handPose->y, handPose->z
+                    );
+
+                    // Convert orientation from OpenXR to game coordinates
+                    CoordinateConversion::OpenXRQuatToRED(
+                        handLoc.pose.orientation.x,
+                        handLoc.pose.orientation.y,
+                        handLoc.pose.orientation.z,
+                        handLoc.pose.orientation.w,
+                        handPose->qx, handPose->qy, handPose->qz, handPose->qw
+                    );
+
+                    // Calculate aim direction from quaternion (forward vector)
+                    // Forward in OpenXR is -Z, we need to transform this
+                    float qx = handPose->qx, qy = handPose->qy, qz = handPose->qz, qw = handPose->qw;
+
+                    // Rotate forward vector (0, 1, 0) in game space by quaternion
+                    // Using quaternion rotation: v' = q * v * q^-1
+                    // Simplified for unit forward vector:
+                    handPose->aimX = 2.0f * (qx * qy + qw * qz);
+                    handPose->aimY = 1.0f - 2.0f * (qx * qx + qz * qz);
+                    handPose->aimZ = 2.0f * (qy * qz - qw * qx);
+
+                    // Calculate yaw and pitch angles (degrees)
+                    // Yaw: rotation around Z axis (up)
+                    // Pitch: rotation around X axis (right)
+                    handPose->yaw = std::atan2(handPose->aimX, handPose->aimY) * (180.0f / 3.14159265f);
+                    handPose->pitch = std::asin(-handPose->aimZ) * (180.0f / 3.14159265f);
                 }
+
+                if (hand == 0)
+                    state.leftHandValid = valid;
+                else
+                    state.rightHandValid = valid;
+            }
+        }
+    }
+
+    // Menu button (global, not per-hand)
+    XrActionStateBoolean menuState = { XR_TYPE_ACTION_STATE_BOOLEAN };
+    XrActionStateGetInfo menuGetInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
+    menuGetInfo.action = m_menuButtonAction;
+    menuGetInfo.subactionPath = XR_NULL_PATH;
+    if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &menuGetInfo, &menuState)) && menuState.isActive)
+    {
+        if (menuState.currentState)
+            state.buttons |= VRControllerState::BUTTON_START;
+    }
+
+    // Grip buttons (based on grip value)
+    if (state.leftGrip > 0.8f)
+        state.buttons |= VRControllerState::BUTTON_LEFT_SHOULDER;
+    if (state.rightGrip > 0.8f)
+        state.buttons |= VRControllerState::BUTTON_RIGHT_SHOULDER;
+
+    m_controllerState = state;
+    {
+        ThreadSafe::Lock lock(m_controllerMutex);
+        m_publishedControllerState = state;
+    }
+    m_controllersAvailable.store(state.leftHandValid || state.rightHandValid);
+}
+
+bool VRSystem::Impl::CreateD3D12Resources()
+{
+    if (!m_device)
+    {
+        Utils::LogError("D3D12: No device available");
+        return false;
+    }
+
+    if (FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+        IID_PPV_ARGS(&m_commandAllocator))))
+    {
+        Utils::LogError("D3D12: Failed to create command allocator");
+        return false;
+    }
+
+    if (FAILED(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence))))
+    {
+        Utils::LogError("D3D12: Failed to create fence");
+        return false;
+    }
+
+    if (VRConfig::IsCopyQueue())
+    {
+        CreateCopyQueue();
+    }
+    if (m_copyQueue && !CreateCopyTransitions())
+    {
+        DestroyCopyQueue();
+    }
+
+    if (!CreateResamplePipeline() || !CreateDescriptors())
+    {
+        // Not fatal: eye images are then cropped with a plain copy
+        Utils::LogWarn("D3D12: Resample pass unavailable - falling back to cropped copy");
+        m_resamplePipeline.Reset();
+    }
+
+    // The conversion pass reuses the resample root signature
+    if (m_spaceWarpSupported && m_resamplePipeline && !CreateMotionPipeline())
+    {
+        m_motionPipeline.Reset();
+    }
+    if (m_spaceWarpSupported && !m_motionPipeline)
+    {
+        Utils::LogWarn("D3D12: Motion vector pass unavailable - space warp disabled");
+        m_spaceWarpSupported = false;
+    }
+
+    if (m_perfSettingsSupported && !m_gameTimer.Create(m_device.Get()))
+    {
+        Utils::LogWarn("D3D12: Game GPU timing unavailable - GPU performance level follows runtime notifications only");
+    }
+
+    if (m_outputTimer.Create(m_device.Get()))
+    {
+        m_outputTimer.SetQueue(m_commandQueue.Get(), VRConfig::GetGPUWaitTimeout());
+    }
+    else
+    {
+        Utils::LogWarn("D3D12: Copy GPU timing unavailable - output scale stays fixed");
+    }
+
+    // The UI layer needs the resample pass (scaling) and the hash pass (change
+    // detection); created even with the layer off, which may be switched on later
+    if (m_resamplePipeline && !CreateUiHashResources())
+    {
+        Utils::LogWarn("D3D12: UI change detection unavailable - UI layer disabled");
+        m_uiHashPipeline.Reset();
+    }
+
+    Utils::LogInfo("D3D12: Copy resources created");
+    return true;
+}
+
+bool VRSystem::Impl::CreateResamplePipeline()
+{
+    ComPtr<ID3DBlob> shader;
+    ComPtr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(EyeResample::SHADER_SOURCE, strlen(EyeResample::SHADER_SOURCE), "EyeResample",
+                            nullptr, nullptr, "main", "cs_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &shader, &errors);
+    if (FAILED(hr))
+    {
+        Utils::LogError("D3D12: Failed to compile resample shader");
+        if (errors)
+        {
+            Utils::LogError(static_cast<const char*>(errors->GetBufferPointer()));
+        }
+        return false;
+    }
+
+    D3D12_DESCRIPTOR_RANGE ranges[2] = {};
+    ranges[0].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    ranges[0].NumDescriptors = 1;
+    ranges[0].BaseShaderRegister = 0;
+    ranges[1].RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+    ranges[1].NumDescriptors = 1;
+    ranges[1].BaseShaderRegister = 0;
+
+    D3D12_ROOT_PARAMETER params[3] = {};
+    params[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    params[0].Constants.ShaderRegister = 0;
+    params[0].Constants.Num32BitValues = EyeResample::ROOT_CONSTANT_COUNT;
+    params[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    params[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    params[1].DescriptorTable.NumDescriptorRanges = 1;
+    params[1].DescriptorTable.pDescriptorRanges = &ranges[0];
+    params[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    params[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    params[2].DescriptorTable.NumDescriptorRanges = 1;
+    params[2].DescriptorTable.pDescriptorRanges = &ranges[1];
+    params[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    D3D12_STATIC_SAMPLER_DESC sampler = {};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.ComparisonFunc = D3D12_COMPARISON_FUNC_NEVER;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootDesc = {};
+    rootDesc.NumParameters = 3;
+    rootDesc.pParameters = params;
+    rootDesc.NumStaticSamplers = 1;
+    rootDesc.pStaticSamplers = &sampler;
+
+    ComPtr<ID3DBlob> rootBlob;
+    if (FAILED(D3D12SerializeRootSignature(&rootDesc, D3D_ROOT_SIGNATURE_VERSION_1, &rootBlob, &errors)) ||
+        FAILED(m_device->CreateRootSignature(0, rootBlob->GetBufferPointer(), rootBlob->GetBufferSize(),
+                                             IID_PPV_ARGS(&m_resampleRootSignature))))
+    {
+        Utils::LogError("D3D12: Failed to create resample root signature");
+        return false;
+    }
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineDesc = {};
+    pipelineDesc.pRootSignature = m_resampleRootSignature.Get();
+    pipelineDesc.CS.pShaderBytecode = shader->GetBufferPointer();
+    pipelineDesc.CS.BytecodeLength = shader->GetBufferSize();
+
+    if (FAILED(m_device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(&m_resamplePipeline))))
+    {
+        Utils::LogError("D3D12: Failed to create resample pipeline");
+        return false;
+    }
+
+    return true;
+}
+
+// One shader-visible heap; eye image UAVs are written once here,
+// back buffer SRVs when their copy lists are recorded
+bool VRSystem::Impl::CreateDescriptors()
+{
+    UINT imageCount = static_cast<UINT>(GetEyeSwapchain(0).images.size() + GetEyeSwapchain(1).images.size());
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = MAX_BACK_BUFFERS + imageCount;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+    if (FAILED(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_descriptorHeap))))
+    {
+        Utils::LogError("D3D12: Failed to create descriptor heap");
+        return false;
+    }
+
+    m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    for (int eye = 0; eye < 2; eye++)
+    {
+        const SwapchainInfo& swapchain = GetEyeSwapchain(eye);
+        for (uint32_t image = 0; image < swapchain.images.size(); image++)
+        {
+            ID3D12Resource* texture = swapchain.images[image].texture;
+
+            D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+            uavDesc.Format = FormatUtils::GetUavFormat(m_swapchainFormat);
+            // The kernel writes through a single-slice array view, which covers
+            // both per-eye textures and one slice of the shared array texture
+            uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
+            uavDesc.Texture2DArray.FirstArraySlice = m_eyeTargets[eye].arrayIndex;
+            uavDesc.Texture2DArray.ArraySize = 1;
+
+            m_device->CreateUnorderedAccessView(texture, nullptr, &uavDesc, GetCPUDescriptor(GetImageDescriptorIndex(eye, image)));
+        }
+    }
+
+    return true;
+}
+
+UINT VRSystem::Impl::GetImageDescriptorIndex(int eyeIndex, uint32_t imageIndex) const
+{
+    UINT index = MAX_BACK_BUFFERS + imageIndex;
+    if (eyeIndex == 1)
+    {
+        index += static_cast<UINT>(GetEyeSwapchain(0).images.size());
+    }
+    return index;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE VRSystem::Impl::GetCPUDescriptor(UINT index) const
+{
+    return GetDescriptor(m_descriptorHeap.Get(), index);
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE VRSystem::Impl::GetGPUDescriptor(UINT index) const
+{
+    return GetGPUDescriptor(m_descriptorHeap.Get(), index);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE VRSystem::Impl::GetDescriptor(ID3D12DescriptorHeap* heap, UINT index) const
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle = heap->GetCPUDescriptorHandleForHeapStart();
+    handle.ptr += static_cast<SIZE_T>(index) * m_descriptorSize;
+    return handle;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE VRSystem::Impl::GetGPUDescriptor(ID3D12DescriptorHeap* heap, UINT index) const
+{
+    D3D12_GPU_DESCRIPTOR_HANDLE handle = heap->GetGPUDescriptorHandleForHeapStart();
+    handle.ptr += static_cast<UINT64>(index) * m_descriptorSize;
+    return handle;
+}
+
+// Idle every queue we submit to: the direct queue first waits (on the GPU)
+// for the copy queue, so one value on m_fence covers both
+bool VRSystem::Impl::WaitForGPU()
+{
+    if (!m_fence || !m_commandQueue) return false;
+
+    if (m_copyQueue)
+    {
+        UINT64 copied = SignalCopyFence();
+        if (copied == 0 || FAILED(m_commandQueue->Wait(m_copyFence.Get(), copied))) return false;
+    }
+
+    UINT64 fenceValue = SignalFence();
+    if (fenceValue == 0) return false;
+
+    FenceWait::Result result = FenceWait::Wait(m_fenceEvents, { m_fence.Get(), fenceValue },
+                                               VRConfig::GetGPUWaitTimeout());
+    if (result == FenceWait::Result::Timeout)
+    {
+        Utils::LogWarn("D3D12: GPU wait timed out");
+        return false;
+    }
+    else if (result != FenceWait::Result::Complete)
+    {
+        Utils::LogError("D3D12: GPU wait failed");
+        return false;
+    }
+
+    return true;
+}
+
+// Not fatal: copies then stay on the DIRECT queue
+void VRSystem::Impl::CreateCopyQueue()
+{
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Priority = D3D12_COMMAND_QUEUE_PRIORITY_HIGH;
+
+    if (FAILED(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_copyQueue))) ||
+        FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_copyAllocator))) ||
+        FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_transitionAllocator))) ||
+        FAILED(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_copyFence))))
+    {
+        DestroyCopyQueue();
+        return;
+    }
+
+    Utils::LogInfo("D3D12: Eye copies run on a copy queue");
+}
+
+// Nothing may be queued on the copy queue any more (set up, or GPU idle)
+void VRSystem::Impl::DestroyCopyQueue()
+{
+    Utils::LogWarn("D3D12: Copy queue unavailable - eye copies stay on the direct queue");
+    m_copyQueue.Reset();
+    m_copyAllocator.Reset();
+    m_copyFence.Reset();
+    m_transitionAllocator.Reset();
+    m_copyTransitions[0].clear();
+    m_copyTransitions[1].clear();
+}
+
+// Record the transitions collected by a tracker as one ResourceBarrier call
+void VRSystem::Impl::FlushBarriers(ID3D12GraphicsCommandList* commandList, ResourceStates::Tracker& states)
+{
+    states.Flush([commandList](const ResourceStates::Barrier* barriers, size_t count)
+    {
+        std::vector<D3D12_RESOURCE_BARRIER> d3dBarriers(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            D3D12_RESOURCE_BARRIER& barrier = d3dBarriers[i];
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Flags = (barriers[i].split == ResourceStates::Split::Begin) ? D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY :
+                            (barriers[i].split == ResourceStates::Split::End) ? D3D12_RESOURCE_BARRIER_FLAG_END_ONLY :
+                                                                                D3D12_RESOURCE_BARRIER_FLAG_NONE;
+            barrier.Transition.pResource = static_cast<ID3D12Resource*>(const_cast<void*>(barriers[i].resource));
+            barrier.Transition.Subresource = barriers[i].subresource;
+            barrier.Transition.StateBefore = static_cast<D3D12_RESOURCE_STATES>(barriers[i].before);
+            barrier.Transition.StateAfter = static_cast<D3D12_RESOURCE_STATES>(barriers[i].after);
+        }
+        commandList->ResourceBarrier(static_cast<UINT>(count), d3dBarriers.data());
+    });
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordTransitionList(ID3D12Resource* resource, UINT subresource,
+                                                                       D3D12_RESOURCE_STATES before,
+                                                                       D3D12_RESOURCE_STATES after)
+{
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_transitionAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create transition command list");
+        return nullptr;
+    }
+
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = resource;
+    barrier.Transition.StateBefore = before;
+    barrier.Transition.StateAfter = after;
+    barrier.Transition.Subresource = subresource;
+    commandList->ResourceBarrier(1, &barrier);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close transition command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+// Both transitions of every eye image, once per set of eye swapchains
+bool VRSystem::Impl::CreateCopyTransitions()
+{
+    m_copyTransitions[0].clear();
+    m_copyTransitions[1].clear();
+    if (FAILED(m_transitionAllocator->Reset()))
+    {
+        return false;
+    }
+
+    for (int eye = 0; eye < 2; eye++)
+    {
+        UINT subresource = GetEyeSubresource(eye);
+        for (const XrSwapchainImageD3D12KHR& image : GetEyeSwapchain(eye).images)
+        {
+            CopyTransitions entry;
+            entry.toCommon = RecordTransitionList(image.texture, subresource,
+                D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COMMON);
+            entry.toRenderTarget = RecordTransitionList(image.texture, subresource,
+                D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_RENDER_TARGET);
+            if (!entry.toCommon || !entry.toRenderTarget)
+            {
+                return false;
+            }
+            m_copyTransitions[eye].push_back(entry);
+        }
+    }
+    return true;
+}
+
+const VRSystem::Impl::CopyTransitions* VRSystem::Impl::GetCopyTransitions(int eyeIndex, uint32_t imageIndex) const
+{
+    const std::vector<CopyTransitions>& transitions = m_copyTransitions[eyeIndex];
+    return imageIndex < transitions.size() ? &transitions[imageIndex] : nullptr;
+}
+
+// Copy engine version of RecordCopyList: no barriers, both resources are
+// promoted from COMMON on first use and decay back when the list completes
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordQueueCopyList(ID3D12Resource* source,
+                                                                      int eyeIndex, uint32_t imageIndex)
+{
+    ID3D12Resource* dest = GetEyeSwapchain(eyeIndex).images[imageIndex].texture;
+
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY,
+        m_copyAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create copy queue command list");
+        return nullptr;
+    }
+
+    RecordEyeCopies(commandList.Get(), source, dest, eyeIndex);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close copy queue command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordCopyList(ID3D12Resource* source,
+                                                                 int eyeIndex, uint32_t imageIndex)
+{
+    if (m_copyQueue)
+    {
+        return RecordQueueCopyList(source, eyeIndex, imageIndex);
+    }
+
+    ID3D12Resource* dest = GetEyeSwapchain(eyeIndex).images[imageIndex].texture;
+    UINT destSubresource = GetEyeSubresource(eyeIndex);
+
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create copy command list");
+        return nullptr;
+    }
+
+    // The back buffer is read straight out of PRESENT through implicit promotion
+    ResourceStates::Tracker states;
+    states.Track(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::Present, true);
+    states.Track(dest, destSubresource, ResourceStates::State::RenderTarget);
+
+    states.Transition(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::CopySource);
+    states.Transition(dest, destSubresource, ResourceStates::State::CopyDest);
+    FlushBarriers(commandList.Get(), states);
+
+    RecordEyeCopies(commandList.Get(), source, dest, eyeIndex);
+
+    states.Restore();
+    FlushBarriers(commandList.Get(), states);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close copy command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+// One copy per lens-visible rectangle; hidden pixels are never displayed
+void VRSystem::Impl::RecordEyeCopies(ID3D12GraphicsCommandList* commandList, ID3D12Resource* source,
+                                     ID3D12Resource* dest, int eyeIndex)
+{
+    D3D12_RESOURCE_DESC srcDesc = source->GetDesc();
+    const XrExtent2Di& extent = m_eyeExtents[eyeIndex];
+
+    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+    srcLoc.pResource = source;
+    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    srcLoc.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+    dstLoc.pResource = dest;
+    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLoc.SubresourceIndex = GetEyeSubresource(eyeIndex);
+
+    UINT copyWidth = static_cast<UINT>(std::min<UINT64>(srcDesc.Width, static_cast<UINT64>(extent.width)));
+    UINT copyHeight = std::min<UINT>(srcDesc.Height, static_cast<UINT>(extent.height));
+
+    for (const VisibilityMask::Rect& rect : GetVisibleRects(eyeIndex))
+    {
+        D3D12_BOX srcBox = {};
+        srcBox.left = rect.x0;
+        srcBox.top = rect.y0;
+        srcBox.right = std::min<UINT>(rect.x1, copyWidth);
+        srcBox.bottom = std::min<UINT>(rect.y1, copyHeight);
+        srcBox.back = 1;
+
+        if (srcBox.right > srcBox.left && srcBox.bottom > srcBox.top)
+        {
+            commandList->CopyTextureRegion(&dstLoc, rect.x0, rect.y0, 0, &srcLoc, &srcBox);
+        }
+    }
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordResampleList(ID3D12Resource* source, uint32_t backBufferIndex,
+                                                                     int eyeIndex, uint32_t imageIndex)
+{
+    ID3D12Resource* dest = GetEyeSwapchain(eyeIndex).images[imageIndex].texture;
+
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_commandAllocator.Get(), m_resamplePipeline.Get(), IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create resample command list");
+        return nullptr;
+    }
+
+    D3D12_RESOURCE_DESC srcDesc = source->GetDesc();
+    const XrExtent2Di& extent = m_eyeExtents[eyeIndex];
+
+    // Only the submitted region is written; the rest of the image is never sampled
+    uint32_t flags = NeedsSrgbEncode(srcDesc.Format) ? EyeResample::Flags::EncodeSrgb : EyeResample::Flags::None;
+    EyeResample::Params params = EyeResample::ComputeParams(
+        static_cast<uint32_t>(srcDesc.Width), srcDesc.Height,
+        static_cast<uint32_t>(extent.width), static_cast<uint32_t>(extent.height), flags);
+
+    UINT destSubresource = GetEyeSubresource(eyeIndex);
+
+    ResourceStates::Tracker states;
+    states.Track(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::Present, true);
+    states.Track(dest, destSubresource, ResourceStates::State::RenderTarget);
+
+    states.Transition(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::NonPixelShaderResource);
+    states.Transition(dest, destSubresource, ResourceStates::State::UnorderedAccess);
+    FlushBarriers(commandList.Get(), states);
+
+    ID3D12DescriptorHeap* heaps[] = { m_descriptorHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetComputeRootSignature(m_resampleRootSignature.Get());
+    commandList->SetComputeRoot32BitConstants(0, EyeResample::ROOT_CONSTANT_COUNT, &params, 0);
+    commandList->SetComputeRootDescriptorTable(1, GetGPUDescriptor(backBufferIndex));
+    commandList->SetComputeRootDescriptorTable(2, GetGPUDescriptor(GetImageDescriptorIndex(eyeIndex, imageIndex)));
+
+    // One dispatch per lens-visible rectangle (tile-aligned, so groups never straddle two)
+    constexpr UINT offsetConstant = offsetof(EyeResample::Params, dispatchOffset) / sizeof(uint32_t);
+    for (const VisibilityMask::Rect& rect : GetVisibleRects(eyeIndex))
+    {
+        commandList->SetComputeRoot32BitConstant(0, EyeResample::PackDispatchOffset(rect.x0, rect.y0), offsetConstant);
+        commandList->Dispatch(EyeResample::GetDispatchCount(rect.x1 - rect.x0),
+                              EyeResample::GetDispatchCount(rect.y1 - rect.y0), 1);
+    }
+
+    states.Restore();
+    FlushBarriers(commandList.Get(), states);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close resample command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+// Plain copy when sizes and formats line up, otherwise the resample pass
+bool VRSystem::Impl::NeedsResample(ID3D12Resource* source, int eyeIndex, uint32_t backBufferIndex) const
+{
+    if (!m_resamplePipeline || backBufferIndex >= MAX_BACK_BUFFERS || GetEyeSwapchain(eyeIndex).images.empty())
+    {
+        return false;
+    }
+
+    D3D12_RESOURCE_DESC srcDesc = source->GetDesc();
+    const XrExtent2Di& extent = m_eyeExtents[eyeIndex];
+
+    return srcDesc.Width != static_cast<UINT64>(extent.width) || srcDesc.Height != static_cast<UINT>(extent.height) ||
+           !FormatUtils::IsCopyCompatible(srcDesc.Format, m_swapchainFormat) ||
+           NeedsSrgbEncode(srcDesc.Format);
+}
+
+// Linear (scRGB) back buffers only need encoding when the swapchain is not linear too
+bool VRSystem::Impl::NeedsSrgbEncode(DXGI_FORMAT sourceFormat) const
+{
+    return FormatUtils::IsLinearFormat(sourceFormat) && !FormatUtils::IsLinearFormat(m_swapchainFormat);
+}
+
+void VRSystem::Impl::CreateBackBufferSRV(ID3D12Resource* source, uint32_t backBufferIndex)
+{
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = source->GetDesc().Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+
+    m_device->CreateShaderResourceView(source, &srvDesc, GetCPUDescriptor(backBufferIndex));
+    if (m_insetHeap)
+    {
+        m_device->CreateShaderResourceView(source, &srvDesc, GetDescriptor(m_insetHeap.Get(), backBufferIndex));
+    }
+}
+
+// Drop every cached list without waiting for the GPU: lists that may still be
+// executing keep their allocator alive in m_retiredAllocators
+void VRSystem::Impl::ResetCopyCache()
+{
+    m_copyCache.clear();
+    m_depthCacheSource = nullptr;
+    m_depthCopyLists[0].clear();
+    m_depthCopyLists[1].clear();
+    m_motionCacheSource = nullptr;
+    m_motionLists[0].clear();
+    m_motionLists[1].clear();
+    if (m_commandAllocator)
+    {
+        ReplaceAllocator(m_commandAllocator, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    }
+    if (m_copyAllocator)
+    {
+        ReplaceAllocator(m_copyAllocator, D3D12_COMMAND_LIST_TYPE_COPY);
+    }
+}
+
+// Retire an allocator behind a fence value on its queue and put a free one
+// in its place: a retired one the GPU is past, or a new one
+void VRSystem::Impl::ReplaceAllocator(ComPtr<ID3D12CommandAllocator>& allocator, D3D12_COMMAND_LIST_TYPE type)
+{
+    bool direct = type == D3D12_COMMAND_LIST_TYPE_DIRECT;
+    UINT64 fenceValue = direct ? SignalFence() : SignalCopyFence();
+    // A failed signal never completes: that allocator is not reused
+    m_retiredAllocators.push_back({ allocator, type, fenceValue != 0 ? fenceValue : UINT64_MAX });
+    allocator.Reset();
+
+    UINT64 completed = (direct ? m_fence : m_copyFence)->GetCompletedValue();
+    for (auto it = m_retiredAllocators.begin(); it != m_retiredAllocators.end(); ++it)
+    {
+        if (it->type == type && it->fenceValue <= completed && SUCCEEDED(it->allocator->Reset()))
+        {
+            allocator = it->allocator;
+            m_retiredAllocators.erase(it);
+            return;
+        }
+    }
+
+    if (FAILED(m_device->CreateCommandAllocator(type, IID_PPV_ARGS(&allocator))))
+    {
+        Utils::LogError("D3D12: Failed to create command allocator");
+        allocator.Reset();
+    }
+}
+
+ID3D12GraphicsCommandList* VRSystem::Impl::GetCopyList(ID3D12Resource* source, uint32_t backBufferIndex,
+                                                       int eyeIndex, uint32_t imageIndex)
+{
+    if (!source || !m_commandAllocator) return nullptr;
+
+    if (m_copyCacheDirty.exchange(false))
+    {
+        ResetCopyCache();
+    }
+
+    // New masks change the regions every list copies
+    if (m_visibilityMaskSupported && m_visibilityMaskDirty.exchange(false))
+    {
+        LoadVisibilityMasks();
+        ResetCopyCache();
+    }
+
+    if (m_visibilityMaskNotify.exchange(false))
+    {
+        NotifyVisibilityMasks();
+    }
+
+    // A different resource at a known index means the buffers were recreated
+    // without passing through ResizeBuffers (e.g. ResizeBuffers1), so drop everything
+    if (backBufferIndex < m_copyCache.size() && m_copyCache[backBufferIndex].source &&
+        m_copyCache[backBufferIndex].source != source)
+    {
+        Utils::LogInfo("D3D12: Back buffers changed - rebuilding copy cache");
+        ResetCopyCache();
+    }
+
+    if (backBufferIndex >= m_copyCache.size())
+    {
+        m_copyCache.resize(backBufferIndex + 1);
+    }
+
+    CopyCacheEntry& entry = m_copyCache[backBufferIndex];
+    if (!entry.source)
+    {
+        bool inset = m_lensMatched && backBufferIndex < MAX_BACK_BUFFERS && HaveInsetSwapchains();
+        bool srvCreated = false;
+        for (int eye = 0; eye < 2; eye++)
+        {
+            const SwapchainInfo& swapchain = GetEyeSwapchain(eye);
+            bool resample = NeedsResample(source, eye, backBufferIndex);
+            if ((resample || inset) && !srvCreated)
+            {
+                CreateBackBufferSRV(source, backBufferIndex);
+                srvCreated = true;
+            }
+
+            entry.lists[eye].clear();
+            entry.lists[eye].reserve(swapchain.images.size());
+
+            for (uint32_t image = 0; image < swapchain.images.size(); image++)
+            {
+                entry.lists[eye].push_back(resample
+                    ? RecordResampleList(source, backBufferIndex, eye, image)
+                    : RecordCopyList(source, eye, image));
+            }
+
+            entry.insetLists[eye].clear();
+            for (uint32_t image = 0; inset && image < m_insetSwapchains[eye].images.size(); image++)
+            {
+                entry.insetLists[eye].push_back(RecordInsetList(source, backBufferIndex, eye, image));
+            }
+        }
+        entry.source = source;
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "D3D12: Recorded copy lists for back buffer %u", backBufferIndex);
+        Utils::LogInfo(msg);
+    }
+
+    if (imageIndex >= entry.lists[eyeIndex].size()) return nullptr;
+    return entry.lists[eyeIndex][imageIndex].Get();
+}
+
+// Query the visible-area mesh of both eyes; an eye without one is copied whole
+void VRSystem::Impl::LoadVisibilityMasks()
+{
+    for (uint32_t eye = 0; eye < 2; eye++)
+    {
+        VisibilityMaskInfo& mask = m_visibilityMasks[eye];
+        mask.vertices.clear();
+        mask.indices.clear();
+        mask.rects.clear();
+        mask.rectsExtent = {};
+
+        XrVisibilityMaskKHR query = { XR_TYPE_VISIBILITY_MASK_KHR };
+        XrResult result = m_xrGetVisibilityMaskKHR(m_session, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, eye,
+                                                   XR_VISIBILITY_MASK_TYPE_VISIBLE_TRIANGLE_MESH_KHR, &query);
+        if (XR_FAILED(result) || query.vertexCountOutput == 0 || query.indexCountOutput == 0)
+        {
+            continue;
+        }
+
+        std::vector<XrVector2f> vertices(query.vertexCountOutput);
+        mask.indices.resize(query.indexCountOutput);
+        query.vertexCapacityInput = query.vertexCountOutput;
+        query.vertices = vertices.data();
+        query.indexCapacityInput = query.indexCountOutput;
+        query.indices = mask.indices.data();
+
+        result = m_xrGetVisibilityMaskKHR(m_session, XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO, eye,
+                                          XR_VISIBILITY_MASK_TYPE_VISIBLE_TRIANGLE_MESH_KHR, &query);
+        if (XR_FAILED(result))
+        {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "OpenXR: xrGetVisibilityMaskKHR failed for eye %u with code %d", eye, result);
+            Utils::LogWarn(msg);
+            mask.indices.clear();
+            continue;
+        }
+
+        mask.indices.resize(query.indexCountOutput);
+        mask.vertices.reserve(static_cast<size_t>(query.vertexCountOutput) * 2);
+        for (uint32_t i = 0; i < query.vertexCountOutput; i++)
+        {
+            mask.vertices.push_back(vertices[i].x);
+            mask.vertices.push_back(vertices[i].y);
+        }
+    }
+
+    m_visibilityMaskNotify.store(true);
+}
+
+void VRSystem::Impl::NotifyVisibilityMasks()
+{
+    ThreadSafe::Lock lock(m_visibilityCallbackMutex);
+    if (!m_visibilityMaskCallback)
+    {
+        return;
+    }
+
+    for (uint32_t eye = 0; eye < 2; eye++)
+    {
+        const VisibilityMaskInfo& mask = m_visibilityMasks[eye];
+        if (mask.indices.empty())
+        {
+            continue;
+        }
+
+        VRVisibilityMask info;
+        info.eyeIndex = eye;
+        info.vertices = mask.vertices.data();
+        info.vertexCount = static_cast<uint32_t>(mask.vertices.size() / 2);
+        info.indices = mask.indices.data();
+        info.indexCount = static_cast<uint32_t>(mask.indices.size());
+        m_visibilityMaskCallback(info, m_visibilityMaskUserData);
+    }
+}
+
+// Regions of the eye image the copy or resample pass writes at the current extent
+const std::vector<VisibilityMask::Rect>& VRSystem::Impl::GetVisibleRects(int eyeIndex)
+{
+    VisibilityMaskInfo& mask = m_visibilityMasks[eyeIndex];
+    const XrExtent2Di& extent = m_eyeExtents[eyeIndex];
+    if (!mask.rects.empty() && mask.rectsExtent.width == extent.width && mask.rectsExtent.height == extent.height)
+    {
+        return mask.rects;
+    }
+
+    uint32_t width = static_cast<uint32_t>(extent.width);
+    uint32_t height = static_cast<uint32_t>(extent.height);
+
+    const XrFovf& fov = m_renderFrame.views[eyeIndex].fov;
+    bool haveFov = fov.angleRight > fov.angleLeft && fov.angleUp > fov.angleDown;
+    if (mask.indices.empty() || !haveFov)
+    {
+        // No views located yet: copy everything now and rasterize once they are
+        if (!mask.indices.empty())
+        {
+            m_visibilityMaskDirty.store(true);
+        }
+        mask.tiles.SetAllVisible(width, height);
+        mask.rects = mask.tiles.GetVisibleRects();
+        mask.rectsExtent = haveFov ? extent : XrExtent2Di{};
+        return mask.rects;
+    }
+
+    VisibilityMask::FovTangents tangents;
+    tangents.left = std::tan(fov.angleLeft);
+    tangents.right = std::tan(fov.angleRight);
+    tangents.up = std::tan(fov.angleUp);
+    tangents.down = std::tan(fov.angleDown);
+
+    mask.tiles.Rasterize(mask.vertices.data(), static_cast<uint32_t>(mask.vertices.size() / 2),
+                         mask.indices.data(), static_cast<uint32_t>(mask.indices.size()),
+                         tangents, width, height);
+    mask.rects = mask.tiles.GetVisibleRects();
+    if (mask.rects.empty())
+    {
+        // A mask that hides everything is bogus; show the whole image instead
+        mask.tiles.SetAllVisible(width, height);
+        mask.rects = mask.tiles.GetVisibleRects();
+    }
+    mask.rectsExtent = extent;
+
+    uint64_t visiblePixels = 0;
+    for (const VisibilityMask::Rect& rect : mask.rects)
+    {
+        visiblePixels += static_cast<uint64_t>(rect.x1 - rect.x0) * (rect.y1 - rect.y0);
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Eye %d visibility mask at %ux%u: %zu regions, %.1f%% of pixels copied",
+             eyeIndex, width, height, mask.rects.size(),
+             100.0 * static_cast<double>(visiblePixels) / (static_cast<double>(width) * height));
+    Utils::LogInfo(msg);
+
+    return mask.rects;
+}
+
+VRSystem::Impl::SwapchainInfo& VRSystem::Impl::GetImageSwapchain(ImageFamily family, uint32_t index)
+{
+    switch (family)
+    {
+    case ImageFamily::Depth:    return m_depthSwapchains[index];
+    case ImageFamily::Motion:   return m_motionSwapchains[index];
+    case ImageFamily::Inset:    return m_insetSwapchains[index];
+    case ImageFamily::Ui:       return m_uiSwapchain;
+    default:                    return m_swapchains[index];
+    }
+}
+
+uint32_t VRSystem::Impl::GetImageSwapchainCount(ImageFamily family) const
+{
+    return (family == ImageFamily::Inset) ? 2 : (family == ImageFamily::Ui) ? 1 : m_swapchainCount;
+}
+
+std::atomic<VRSystem::Impl::ImageState>& VRSystem::Impl::GetImageState(ImageFamily family, uint32_t index)
+{
+    return m_imageStates[static_cast<uint32_t>(family)][index];
+}
+
+// Pacer thread: acquire (once) and wait for the next image of a swapchain
+// An image the runtime still holds stays acquired; the wait is retried on
+// the next pass
+bool VRSystem::Impl::AcquireImage(SwapchainInfo& swapchain, XrDuration timeout)
+{
+    if (swapchain.acquiredImage < 0)
+    {
+        uint32_t imageIndex;
+        XrSwapchainImageAcquireInfo acquireInfo = { XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
+        if (XR_FAILED(xrAcquireSwapchainImage(swapchain.handle, &acquireInfo, &imageIndex)))
+        {
+            return false;
+        }
+
+        swapchain.acquiredImage = static_cast<int32_t>(imageIndex);
+        swapchain.imageReady = false;
+    }
+
+    if (!swapchain.imageReady)
+    {
+        XrSwapchainImageWaitInfo waitInfo = { XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
+        waitInfo.timeout = timeout;
+
+        // XR_TIMEOUT_EXPIRED is a success code: only XR_SUCCESS means the image is ready
+        XrResult result = xrWaitSwapchainImage(swapchain.handle, &waitInfo);
+        if (result != XR_SUCCESS)
+        {
+            if (XR_FAILED(result))
+            {
+                char msg[128];
+                snprintf(msg, sizeof(msg), "OpenXR: xrWaitSwapchainImage failed with code %d", result);
+                Utils::LogWarn(msg);
+            }
+            return false;
+        }
+
+        swapchain.imageReady = true;
+    }
+
+    return true;
+}
+
+// Pacer thread: get the next image of every swapchain ready before the game
+// presents. Images the render thread holds or has not released yet are left alone
+void VRSystem::Impl::PreAcquireImages()
+{
+    for (uint32_t family = 0; family < IMAGE_FAMILY_COUNT; family++)
+    {
+        ImageFamily imageFamily = static_cast<ImageFamily>(family);
+        for (uint32_t i = 0; i < GetImageSwapchainCount(imageFamily); i++)
+        {
+            SwapchainInfo& swapchain = GetImageSwapchain(imageFamily, i);
+            if (swapchain.handle == XR_NULL_HANDLE)
+            {
+                continue;
+            }
+
+            std::atomic<ImageState>& state = m_imageStates[family][i];
+            ImageState expected = ImageState::Free;
+            if (!state.compare_exchange_strong(expected, ImageState::Busy))
+            {
+                expected = ImageState::Acquired;
+                if (!state.compare_exchange_strong(expected, ImageState::Busy))
+                {
+                    continue;
+                }
+            }
+
+            bool ready = AcquireImage(swapchain, PRE_ACQUIRE_WAIT_TIMEOUT);
+            state.store(ready ? ImageState::Ready
+                              : (swapchain.acquiredImage >= 0 ? ImageState::Acquired : ImageState::Free));
+        }
+    }
+}
+
+// Render thread: is a pre-acquired image waiting to be taken?
+bool VRSystem::Impl::IsImageReady(ImageFamily family, uint32_t index)
+{
+    ImageState state = GetImageState(family, index).load();
+    return state == ImageState::Ready || state == ImageState::Writing;
+}
+
+// Render thread: take a pre-acquired image for writing without blocking
+// A shared array swapchain stays taken from the first eye written until
+// its release is queued
+bool VRSystem::Impl::TakeImage(ImageFamily family, uint32_t index)
+{
+    std::atomic<ImageState>& state = GetImageState(family, index);
+    if (state.load() == ImageState::Writing)
+    {
+        return true;
+    }
+
+    ImageState expected = ImageState::Ready;
+    return state.compare_exchange_strong(expected, ImageState::Writing);
+}
+
+// Render thread: the image's writes are queued; the submission thread
+// releases it with the next packet, before the frame that shows it ends
+// (the runtime waits on m_commandQueue before reading)
+void VRSystem::Impl::QueueRelease(ImageFamily family, uint32_t index)
+{
+    GetImageState(family, index).store(ImageState::Releasing);
+    if (m_pendingReleaseCount < IMAGE_FAMILY_COUNT)
+    {
+        m_pendingReleases[m_pendingReleaseCount++] = { family, index,
+                                                       m_imageGenerations[static_cast<uint32_t>(family)].load() };
+    }
+}
+
+// Render thread: take the eye's image without blocking
+// Returns false when no image is ready; the eye is skipped this frame and
+// the compositor keeps showing its previous image
+bool VRSystem::Impl::AcquireEyeImage(int eyeIndex)
+{
+    if (TakeImage(ImageFamily::Color, m_eyeTargets[eyeIndex].swapchainIndex))
+    {
+        return true;
+    }
+
+    if ((m_skippedEyes++ % 100) == 0)
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: No swapchain image ready - eye skipped (%u so far)", m_skippedEyes);
+        Utils::LogWarn(msg);
+    }
+    return false;
+}
+
+void VRSystem::Impl::ReleaseEyeImage(int eyeIndex)
+{
+    QueueRelease(ImageFamily::Color, m_eyeTargets[eyeIndex].swapchainIndex);
+}
+
+// Submission thread: restore the copy queue eye image, then release the
+// images a packet wrote. Under m_frameMutex, so a swapchain destroyed by the
+// pacer is either released before or skipped
+void VRSystem::Impl::ReleaseImages(const SubmitPacket& packet, bool copyDone)
+{
+    if (packet.releaseCount == 0 && packet.copyFenceValue == 0)
+    {
+        return;
+    }
+
+    ThreadSafe::Lock frameLock(m_frameMutex);
+    if (packet.copyFenceValue != 0 && packet.sessionEpoch == m_sessionEpoch.load())
+    {
+        RestoreEyeImage(packet, copyDone);
+    }
+
+    for (uint32_t i = 0; i < packet.releaseCount; i++)
+    {
+        const ImageRelease& release = packet.releases[i];
+        if (release.generation != m_imageGenerations[static_cast<uint32_t>(release.family)].load())
+        {
+            continue;
+        }
+
+        SwapchainInfo& swapchain = GetImageSwapchain(release.family, release.index);
+        XrSwapchainImageReleaseInfo releaseInfo = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
+        xrReleaseSwapchainImage(swapchain.handle, &releaseInfo);
+        swapchain.acquiredImage = -1;
+        swapchain.imageReady = false;
+        GetImageState(release.family, release.index).store(ImageState::Free);
+    }
+}
+
+// Pacer thread (or teardown), before a family's swapchains are destroyed:
+// releases still queued for them are dropped and their states start over
+void VRSystem::Impl::RetireImages(ImageFamily family)
+{
+    {
+        ThreadSafe::Lock frameLock(m_frameMutex);
+        m_imageGenerations[static_cast<uint32_t>(family)].fetch_add(1);
+    }
+    for (std::atomic<ImageState>& state : m_imageStates[static_cast<uint32_t>(family)])
+    {
+        state.store(ImageState::Free);
+    }
+}
+
+void VRSystem::Impl::DestroyInsetSwapchains()
+{
+    WaitForGPU();
+    RetireImages(ImageFamily::Inset);
+    for (SwapchainInfo& inset : m_insetSwapchains)
+    {
+        if (inset.handle != XR_NULL_HANDLE)
+        {
+            xrDestroySwapchain(inset.handle);
+        }
+        inset = SwapchainInfo();
+    }
+    m_insetHeap.Reset();
+    m_insetWritten[0] = false;
+    m_insetWritten[1] = false;
+}
+
+// Render thread: the inset swapchains exist, or the pacer is asked for them
+// Lists are recorded without the inset meanwhile and rebuilt once they are made
+bool VRSystem::Impl::HaveInsetSwapchains()
+{
+    if (m_insetSwapchains[0].handle != XR_NULL_HANDLE)
+    {
+        return true;
+    }
+
+    m_insetRequested.store(true);
+    return false;
+}
+
+// Pacer thread: inset swapchains sized for the full recommended density over
+// the inset FOV. Returns false until the views are located; failure falls
+// back to one uniform layer
+bool VRSystem::Impl::CreateInsetSwapchains()
+{
+    if (m_insetSwapchains[0].handle != XR_NULL_HANDLE)
+    {
+        return true;
+    }
+
+    // The pacer locates the views itself
+    XrFovf fov[2] = { m_views[0].fov, m_views[1].fov };
+    for (int eye = 0; eye < 2; eye++)
+    {
+        if (fov[eye].angleRight <= fov[eye].angleLeft || fov[eye].angleUp <= fov[eye].angleDown)
+        {
+            return false;
+        }
+    }
+
+    float angle = std::clamp(VRConfig::GetLensMatchedAngle(), LensMatch::MIN_INSET_HALF_ANGLE_DEGREES,
+                             LensMatch::MAX_INSET_HALF_ANGLE_DEGREES);
+    bool created = true;
+    for (int eye = 0; eye < 2 && created; eye++)
+    {
+        LensMatch::FovTangents tangents;
+        tangents.left = std::tan(fov[eye].angleLeft);
+        tangents.right = std::tan(fov[eye].angleRight);
+        tangents.up = std::tan(fov[eye].angleUp);
+        tangents.down = std::tan(fov[eye].angleDown);
+
+        m_insetFov[eye] = LensMatch::ComputeInset(tangents, LensMatch::DegreesToRadians(angle));
+        m_insetUv[eye] = LensMatch::InsetUv(tangents, m_insetFov[eye]);
+
+        uint32_t width, height;
+        LensMatch::InsetSize(m_viewConfigs[eye].recommendedImageRectWidth,
+                             m_viewConfigs[eye].recommendedImageRectHeight, m_insetUv[eye], width, height);
+        created = CreateSwapchain(m_insetSwapchains[eye], width, height, 1);
+    }
+
+    if (!created || !CreateInsetDescriptors())
+    {
+        Utils::LogWarn("OpenXR: Inset swapchain creation failed - lens-matched layers disabled");
+        DestroyInsetSwapchains();
+        m_lensMatched = false;
+        UpdateEyeExtents();
+        return false;
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Lens-matched layers write %.0f%% of the uniform image's pixels",
+             100.0f * LensMatch::PixelFraction(m_peripheryScale, m_insetUv[0]));
+    Utils::LogInfo(msg);
+    return true;
+}
+
+bool VRSystem::Impl::CreateInsetDescriptors()
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = MAX_BACK_BUFFERS +
+        static_cast<UINT>(m_insetSwapchains[0].images.size() + m_insetSwapchains[1].images.size());
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+    if (FAILED(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_insetHeap))))
+    {
+        Utils::LogError("D3D12: Failed to create inset descriptor heap");
+        return false;
+    }
+
+    for (int eye = 0; eye < 2; eye++)
+    {
+        const SwapchainInfo& inset = m_insetSwapchains[eye];
+        for (uint32_t image = 0; image < inset.images.size(); image++)
+        {
+            D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+            uavDesc.Format = FormatUtils::GetUavFormat(m_swapchainFormat);
+            uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
+            uavDesc.Texture2DArray.ArraySize = 1;
+
+            m_device->CreateUnorderedAccessView(inset.images[image].texture, nullptr, &uavDesc,
+                                                GetDescriptor(m_insetHeap.Get(), GetInsetDescriptorIndex(eye, image)));
+        }
+    }
+
+    return true;
+}
+
+UINT VRSystem::Impl::GetInsetDescriptorIndex(int eyeIndex, uint32_t imageIndex) const
+{
+    UINT index = MAX_BACK_BUFFERS + imageIndex;
+    if (eyeIndex == 1)
+    {
+        index += static_cast<UINT>(m_insetSwapchains[0].images.size());
+    }
+    return index;
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordInsetList(ID3D12Resource* source, uint32_t backBufferIndex,
+                                                                  int eyeIndex, uint32_t imageIndex)
+{
+    const SwapchainInfo& inset = m_insetSwapchains[eyeIndex];
+    ID3D12Resource* dest = inset.images[imageIndex].texture;
+
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_commandAllocator.Get(), m_resamplePipeline.Get(), IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create inset command list");
+        return nullptr;
+    }
+
+    // Same source crop as the outer band, narrowed to the inset region
+    D3D12_RESOURCE_DESC srcDesc = source->GetDesc();
+    const XrExtent2Di& extent = m_eyeExtents[eyeIndex];
+    uint32_t flags = NeedsSrgbEncode(srcDesc.Format) ? EyeResample::Flags::EncodeSrgb : EyeResample::Flags::None;
+    EyeResample::Params eyeParams = EyeResample::ComputeParams(
+        static_cast<uint32_t>(srcDesc.Width), srcDesc.Height,
+        static_cast<uint32_t>(extent.width), static_cast<uint32_t>(extent.height), flags);
+    EyeResample::Params params = LensMatch::InsetParams(eyeParams, m_insetUv[eyeIndex],
+        static_cast<uint32_t>(inset.width), static_cast<uint32_t>(inset.height));
+
+    ResourceStates::Tracker states;
+    states.Track(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::Present, true);
+    states.Track(dest, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::RenderTarget);
+
+    states.Transition(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::NonPixelShaderResource);
+    states.Transition(dest, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::UnorderedAccess);
+    FlushBarriers(commandList.Get(), states);
+
+    ID3D12DescriptorHeap* heaps[] = { m_insetHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetComputeRootSignature(m_resampleRootSignature.Get());
+    commandList->SetComputeRoot32BitConstants(0, EyeResample::ROOT_CONSTANT_COUNT, &params, 0);
+    commandList->SetComputeRootDescriptorTable(1, GetGPUDescriptor(m_insetHeap.Get(), backBufferIndex));
+    commandList->SetComputeRootDescriptorTable(2, GetGPUDescriptor(m_insetHeap.Get(), GetInsetDescriptorIndex(eyeIndex, imageIndex)));
+    commandList->Dispatch(EyeResample::GetDispatchCount(params.dstWidth),
+                          EyeResample::GetDispatchCount(params.dstHeight), 1);
+
+    states.Restore();
+    FlushBarriers(commandList.Get(), states);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close inset command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+// Write the full-density inset of one eye; the copy lists for this back
+// buffer were just looked up, so the cache entry exists
+bool VRSystem::Impl::SubmitInset(uint32_t backBufferIndex, int eyeIndex)
+{
+    SwapchainInfo& inset = m_insetSwapchains[eyeIndex];
+    if (inset.handle == XR_NULL_HANDLE || backBufferIndex >= m_copyCache.size())
+    {
+        return false;
+    }
+
+    const std::vector<ComPtr<ID3D12GraphicsCommandList>>& lists = m_copyCache[backBufferIndex].insetLists[eyeIndex];
+    if (lists.empty() || !TakeImage(ImageFamily::Inset, static_cast<uint32_t>(eyeIndex)))
+    {
+        return false;
+    }
+
+    uint32_t imageIndex = static_cast<uint32_t>(inset.acquiredImage);
+    ID3D12GraphicsCommandList* insetList = imageIndex < lists.size() ? lists[imageIndex].Get() : nullptr;
+    ExecuteCopy(insetList);
+
+    // One swapchain per eye, written once per frame pair
+    QueueRelease(ImageFamily::Inset, static_cast<uint32_t>(eyeIndex));
+    return insetList != nullptr;
+}
+
+// Second projection layer, drawn over the outer band with the same poses
+const XrCompositionLayerBaseHeader* VRSystem::Impl::BuildInsetLayer(SubmitPacket& packet)
+{
+    if (!m_lensMatched || !m_insetWritten[0] || !m_insetWritten[1])
+    {
+        return nullptr;
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        const SwapchainInfo& inset = m_insetSwapchains[i];
+        XrCompositionLayerProjectionView& view = packet.insetViews[i];
+        view = { XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW };
+        view.pose = packet.projectionViews[i].pose;
+        view.fov.angleLeft = std::atan(m_insetFov[i].left);
+        view.fov.angleRight = std::atan(m_insetFov[i].right);
+        view.fov.angleUp = std::atan(m_insetFov[i].up);
+        view.fov.angleDown = std::atan(m_insetFov[i].down);
+        view.subImage.swapchain = inset.handle;
+        view.subImage.imageRect.offset = { 0, 0 };
+        view.subImage.imageRect.extent = { inset.width, inset.height };
+    }
+
+    packet.insetLayer = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+    packet.insetLayer.space = m_appSpace;
+    packet.insetLayer.viewCount = 2;
+    packet.insetLayer.views = packet.insetViews;
+    return reinterpret_cast<const XrCompositionLayerBaseHeader*>(&packet.insetLayer);
+}
+
+ComPtr<ID3D12CommandQueue> VRSystem::Impl::GetPresentQueue()
+{
+    ThreadSafe::Lock lock(m_presentQueueMutex);
+    return m_presentQueue;
+}
+
+// Queue a cached list; completion is tracked by the fence value the
+// caller signals afterwards (see SignalFence)
+void VRSystem::Impl::ExecuteCopy(ID3D12GraphicsCommandList* commandList)
+{
+    if (!commandList) return;
+
+    ID3D12CommandList* lists[] = { commandList };
+    m_commandQueue->ExecuteCommandLists(1, lists);
+}
+
+// Eye list. A copy queue list runs after the image's move to COMMON on the
+// DIRECT queue (a GPU wait on the copy queue only); the move back is left to
+// the submission thread (see RestoreEyeImage). Returns the copy fence value
+// that marks the copy, 0 when nothing is left to restore
+UINT64 VRSystem::Impl::ExecuteEyeCopy(ID3D12GraphicsCommandList* commandList, int eyeIndex, uint32_t imageIndex)
+{
+    if (!commandList || commandList->GetType() != D3D12_COMMAND_LIST_TYPE_COPY)
+    {
+        ExecuteCopy(commandList);
+        return 0;
+    }
+
+    const CopyTransitions* transitions = GetCopyTransitions(eyeIndex, imageIndex);
+    if (!transitions)
+    {
+        return 0;
+    }
+
+    ID3D12CommandList* toCommon[] = { transitions->toCommon.Get() };
+    m_commandQueue->ExecuteCommandLists(1, toCommon);
+    m_copyQueue->Wait(m_fence.Get(), SignalFence());
+
+    ID3D12CommandList* copy[] = { commandList };
+    m_copyQueue->ExecuteCommandLists(1, copy);
+    UINT64 copied = SignalCopyFence();
+    if (copied == 0)
+    {
+        // Nothing to wait for: order the move back on the GPU right away
+        ID3D12CommandList* toRenderTarget[] = { transitions->toRenderTarget.Get() };
+        m_commandQueue->ExecuteCommandLists(1, toRenderTarget);
+    }
+    return copied;
+}
+
+// Submission thread, before the packet's images are released: once the
+// copy is done the move back to RENDER_TARGET is queued without a GPU wait,
+// so the game's next frame is never ordered behind the copy queue. A copy
+// still running after the GPU timeout is ordered with a GPU wait instead
+// Returns true once the copy is done
+bool VRSystem::Impl::WaitForEyeCopy(const SubmitPacket& packet)
+{
+    bool copyDone = FenceWait::Wait(m_fenceEvents, { m_copyFence.Get(), packet.copyFenceValue },
+                               VRConfig::GetGPUWaitTimeout(), FENCE_SPIN_TIME) == FenceWait::Result::Complete;
+
+    // Overlap: the copy finished while the direct work queued with it was still running
+    m_queueCopies++;
+    if (copyDone && m_fence->GetCompletedValue() < packet.fenceValue)
+    {
+        m_overlappedCopies++;
+    }
+    if (m_queueCopies == COPY_OVERLAP_LOG_INTERVAL)
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "D3D12: %.0f%% of copy queue eye copies finished before the direct work queued with them",
+                 100.0 * static_cast<double>(m_overlappedCopies) / static_cast<double>(m_queueCopies));
+        Utils::LogInfo(msg);
+        m_queueCopies = 0;
+        m_overlappedCopies = 0;
+    }
+    return copyDone;
+}
+
+// Submission thread, under m_frameMutex with the packet's session current
+void VRSystem::Impl::RestoreEyeImage(const SubmitPacket& packet, bool copyDone)
+{
+    const CopyTransitions* transitions = GetCopyTransitions(packet.eyeIndex, packet.imageIndex);
+    if (!transitions)
+    {
+        return;
+    }
+
+    if (!copyDone)
+    {
+        m_commandQueue->Wait(m_copyFence.Get(), packet.copyFenceValue);
+    }
+    ID3D12CommandList* toRenderTarget[] = { transitions->toRenderTarget.Get() };
+    m_commandQueue->ExecuteCommandLists(1, toRenderTarget);
+}
+
+// Returns the fence value that marks everything queued so far, 0 on failure
+// Values are taken and signalled under one lock, so m_fence never steps back
+UINT64 VRSystem::Impl::SignalFence()
+{
+    ThreadSafe::Lock lock(m_signalMutex);
+    UINT64 fenceValue = m_fenceValue.fetch_add(1) + 1;
+    return SUCCEEDED(m_commandQueue->Signal(m_fence.Get(), fenceValue)) ? fenceValue : 0;
+}
+
+// Same for the copy queue, on its own fence
+UINT64 VRSystem::Impl::SignalCopyFence()
+{
+    ThreadSafe::Lock lock(m_signalMutex);
+    UINT64 fenceValue = m_copyFenceValue.fetch_add(1) + 1;
+    return SUCCEEDED(m_copyQueue->Signal(m_copyFence.Get(), fenceValue)) ? fenceValue : 0;
+}
+
+void VRSystem::Impl::HandleSessionStateChange(XrSessionState newState)
+{
+    switch (newState)
+    {
+    case XR_SESSION_STATE_IDLE:
+        m_sessionState.store(SessionState::Idle);
+        Utils::LogInfo("OpenXR: Session IDLE");
+        break;
+
+    case XR_SESSION_STATE_READY:
+    {
+        m_sessionState.store(SessionState::Ready);
+        Utils::LogInfo("OpenXR: Session READY - Beginning session");
+
+        XrSessionBeginInfo beginInfo = { XR_TYPE_SESSION_BEGIN_INFO };
+        beginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+
+        XrResult result = xrBeginSession(m_session, &beginInfo);
+        if (XR_FAILED(result))
+        {
+            Utils::LogError("OpenXR: Failed to begin session");
+        }
+        break;
+    }
+
+    case XR_SESSION_STATE_SYNCHRONIZED:
+        m_sessionState.store(SessionState::Synchronized);
+        Utils::LogInfo("OpenXR: Session SYNCHRONIZED");
+        break;
+
+    case XR_SESSION_STATE_VISIBLE:
+        m_sessionState.store(SessionState::Visible);
+        Utils::LogInfo("OpenXR: Session VISIBLE");
+        break;
+
+    case XR_SESSION_STATE_FOCUSED:
+        m_sessionState.store(SessionState::Focused);
+        Utils::LogInfo("OpenXR: Session FOCUSED");
+        break;
+
+    case XR_SESSION_STATE_STOPPING:
+    {
+        m_sessionState.store(SessionState::Stopping);
+        Utils::LogInfo("OpenXR: Session STOPPING");
+
+        // Any begun frame dies with the session
+        m_frameInProgress.store(false);
+
+        XrResult result = xrEndSession(m_session);
+        if (XR_FAILED(result))
+        {
+            Utils::LogWarn("OpenXR: Failed to end session gracefully");
+        }
+        break;
+    }
+
+    case XR_SESSION_STATE_LOSS_PENDING:
+        m_sessionState.store(SessionState::LossPending);
+        Utils::LogWarn("OpenXR: Session LOSS_PENDING - HMD may have disconnected");
+        RequestRecovery(Recovery::Session);
+        break;
+
+    case XR_SESSION_STATE_EXITING:
+        m_sessionState.store(SessionState::Exiting);
+        Utils::LogInfo("OpenXR: Session EXITING");
+        RequestRecovery(Recovery::Session);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void VRSystem::Impl::PollEvents()
+{
+    if (m_instance == XR_NULL_HANDLE)
+    {
+        return;
+    }
+
+    XrEventDataBuffer eventBuffer = { XR_TYPE_EVENT_DATA_BUFFER };
+    XrResult result;
+    while ((result = xrPollEvent(m_instance, &eventBuffer)) == XR_SUCCESS)
+    {
+        // Validate event type before casting
+        if (eventBuffer.type == XR_TYPE_EVENT_DATA_INSTANCE_LOSS_PENDING)
+        {
+            Utils::LogWarn("OpenXR: Instance LOSS_PENDING - runtime is going away");
+            RequestRecovery(Recovery::Instance);
+        }
+        else if (eventBuffer.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED)
+        {
+            auto* stateEvent = reinterpret_cast<XrEventDataSessionStateChanged*>(&eventBuffer);
+            HandleSessionStateChange(stateEvent->state);
+        }
+        else if (eventBuffer.type == XR_TYPE_EVENT_DATA_VISIBILITY_MASK_CHANGED_KHR)
+        {
+            // Reloaded on the render thread, which owns the copy lists
+            m_visibilityMaskDirty.store(true);
+            Utils::LogInfo("OpenXR: Visibility mask changed");
+        }
+        else if (eventBuffer.type == XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT)
+        {
+            RecordPerfNotification(*reinterpret_cast<XrEventDataPerfSettingsEXT*>(&eventBuffer));
+        }
+        else if (eventBuffer.type == XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB)
+        {
+            auto* rateEvent = reinterpret_cast<XrEventDataDisplayRefreshRateChangedFB*>(&eventBuffer);
+            VRConfig::SetDisplayRefreshRate(rateEvent->toDisplayRefreshRate);
+
+            char msg[128];
+            snprintf(msg, sizeof(msg), "OpenXR: Display refresh %.0f -> %.0f Hz",
+                     rateEvent->fromDisplayRefreshRate, rateEvent->toDisplayRefreshRate);
+            Utils::LogInfo(msg);
+        }
+        eventBuffer = { XR_TYPE_EVENT_DATA_BUFFER };
+    }
+
+    if (result == XR_ERROR_INSTANCE_LOST)
+    {
+        RequestRecovery(Recovery::Instance);
+    }
+}
+
+// Pacer thread; an instance loss takes the session with it
+void VRSystem::Impl::RequestRecovery(Recovery level)
+{
+    if (level > m_recovery)
+    {
+        m_recovery = level;
+    }
+}
+
+// Pacer thread: tear down once, then try to rebuild at the retry interval
+void VRSystem::Impl::RecoverSession()
+{
+    bool dropInstance = m_recovery == Recovery::Instance && m_instance != XR_NULL_HANDLE;
+    if (m_session != XR_NULL_HANDLE || dropInstance)
+    {
+        ThreadSafe::Lock sessionLock(m_sessionMutex);
+        {
+            ThreadSafe::Lock frameLock(m_frameMutex);
+            m_frameInProgress.store(false);
+            m_sessionEpoch.fetch_add(1);
+        }
+        m_controllersAvailable.store(false);
+        DestroySession();
+        if (dropInstance)
+        {
+            DestroyInstance();
+        }
+        UpdateActivity(false);
+
+        m_recoveryAttempts = 0;
+        m_nextRecoveryAttempt = std::chrono::steady_clock::now();
+        Utils::LogInfo(dropInstance ? "OpenXR: Instance lost - waiting for the runtime to return"
+                                    : "OpenXR: Session lost - waiting for the headset to return");
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < m_nextRecoveryAttempt)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        return;
+    }
+
+    m_recoveryAttempts++;
+    m_nextRecoveryAttempt = now + ((m_recoveryAttempts < RECOVERY_FAST_ATTEMPTS) ? RECOVERY_RETRY_INTERVAL
+                                                                                : RECOVERY_SLOW_RETRY_INTERVAL);
+    if (!RebuildSession())
+    {
+        return;
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: Session recreated after %u attempt(s)", m_recoveryAttempts);
+    Utils::LogInfo(msg);
+    m_recovery = Recovery::None;
+}
+
+// Pacer thread, nothing else running on the session
+bool VRSystem::Impl::RebuildSession()
+{
+    ThreadSafe::Lock sessionLock(m_sessionMutex);
+
+    if (m_instance == XR_NULL_HANDLE)
+    {
+        if (!CreateInstance())
+        {
+            return false;
+        }
+        if (!CreateActionSystem())
+        {
+            Utils::LogWarn("OpenXR: Action system creation failed - controllers may not work");
+        }
+    }
+
+    // Quiet probe: the headset is often still away for a few attempts
+    XrSystemGetInfo systemInfo = { XR_TYPE_SYSTEM_GET_INFO };
+    systemInfo.formFactor = XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY;
+    XrSystemId systemId = XR_NULL_SYSTEM_ID;
+    XrResult result = xrGetSystem(m_instance, &systemInfo, &systemId);
+    if (result == XR_ERROR_INSTANCE_LOST)
+    {
+        DestroyInstance();
+        return false;
+    }
+    if (XR_FAILED(result))
+    {
+        return false;
+    }
+
+    if (!OpenSession() || !CreateSwapchains())
+    {
+        DestroySession();
+        return false;
+    }
+
+    // Eye image UAVs and transitions point at the old swapchain images
+    if (m_resamplePipeline && !CreateDescriptors())
+    {
+        Utils::LogWarn("D3D12: Resample pass unavailable - falling back to cropped copy");
+        m_resamplePipeline.Reset();
+    }
+    if (m_copyQueue && !CreateCopyTransitions())
+    {
+        DestroyCopyQueue();
+    }
+
+    if (!AttachActionSet())
+    {
+        Utils::LogWarn("OpenXR: Failed to attach action sets - controllers may not work");
+    }
+    return true;
+}
+
+// Every session-owned handle, GPU idle first; swapchain-bound GPU work is dropped
+void VRSystem::Impl::DestroySession()
+{
+    WaitForGPU();
+    m_gameTimer.Drain(VRConfig::GetGPUWaitTimeout());
+    m_outputTimer.Drain(VRConfig::GetGPUWaitTimeout());
+    ResetCopyCache();
+    RetireImages(ImageFamily::Color);
+    m_copyTransitions[0].clear();
+    m_copyTransitions[1].clear();
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (m_swapchains[i].handle != XR_NULL_HANDLE)
+        {
+            xrDestroySwapchain(m_swapchains[i].handle);
+        }
+        m_swapchains[i] = SwapchainInfo();
+        m_eyeWrites[i] = EyeWrite();
+    }
+    m_swapchainCount = 0;
+    m_pendingReleaseCount = 0;
+    DestroyDepthSwapchains();
+    DestroyInsetSwapchains();
+    DestroyUiSwapchain();
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (m_handSpaces[i] != XR_NULL_HANDLE)
+        {
+            xrDestroySpace(m_handSpaces[i]);
+            m_handSpaces[i] = XR_NULL_HANDLE;
+        }
+    }
+
+    if (m_viewSpace != XR_NULL_HANDLE) xrDestroySpace(m_viewSpace);
+    if (m_appSpace != XR_NULL_HANDLE) xrDestroySpace(m_appSpace);
+    m_viewSpace = XR_NULL_HANDLE;
+    m_appSpace = XR_NULL_HANDLE;
+
+    if (m_session != XR_NULL_HANDLE)
+    {
+        if (IsSessionRunning())
+        {
+            xrEndSession(m_session);
+        }
+        xrDestroySession(m_session);
+        m_session = XR_NULL_HANDLE;
+    }
+    m_sessionState.store(SessionState::Unknown);
+
+    // Masks belong to the session's views
+    m_visibilityMaskDirty.store(true);
+}
+
+// The action set and its actions go with the instance
+void VRSystem::Impl::DestroyInstance()
+{
+    if (m_actionSet != XR_NULL_HANDLE)
+    {
+        xrDestroyActionSet(m_actionSet);
+        m_actionSet = XR_NULL_HANDLE;
+    }
+
+    if (m_instance != XR_NULL_HANDLE)
+    {
+        xrDestroyInstance(m_instance);
+        m_instance = XR_NULL_HANDLE;
+    }
+    m_systemId = XR_NULL_SYSTEM_ID;
+}
+
+void VRSystem::Impl::StartPacingThread()
+{
+    if (m_pacingThread.joinable()) return;
+
+    m_stopPacing.store(false);
+    m_pacingThread = std::thread([this] { PacingThreadMain(); });
+}
+
+void VRSystem::Impl::StopPacingThread()
+{
+    if (!m_pacingThread.joinable()) return;
+
+    {
+        ThreadSafe::Lock lock(m_frameMutex);
+        m_stopPacing.store(true);
+    }
+    m_frameEnded.notify_all();
+    m_pacingThread.join();
+}
+
+bool VRSystem::Impl::StartSubmissionThread()
+{
+    if (m_submissionThread.joinable()) return true;
+
+    m_submitEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!m_submitEvent)
+    {
+        Utils::LogError("OpenXR: Failed to create submission thread event");
+        return false;
+    }
+
+    m_stopSubmission.store(false);
+    m_submissionThread = std::thread([this] { SubmissionThreadMain(); });
+    return true;
+}
+
+void VRSystem::Impl::StopSubmissionThread()
+{
+    if (m_submissionThread.joinable())
+    {
+        m_stopSubmission.store(true);
+        SetEvent(m_submitEvent);
+        m_submissionThread.join();
+    }
+
+    if (m_submitEvent) CloseHandle(m_submitEvent);
+    m_submitEvent = nullptr;
+}
+
+// Render thread: publish a filled packet
+void VRSystem::Impl::PushPacket()
+{
+    m_submitQueue.CommitPush();
+    SetEvent(m_submitEvent);
+}
+
+// Render thread: the ring is full, so the GPU or the compositor is far behind
+void VRSystem::Impl::LogDroppedPacket()
+{
+    if ((m_droppedPackets++ % 100) == 0)
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: Submission queue full - eye skipped (%llu so far)",
+                 static_cast<unsigned long long>(m_droppedPackets));
+        Utils::LogWarn(msg);
+    }
+}
+
+void VRSystem::Impl::SubmissionThreadMain()
+{
+    Utils::LogInfo("OpenXR: Submission thread started");
+
+    while (!m_stopSubmission.load())
+    {
+        SubmitPacket* packet = m_submitQueue.Front();
+        if (!packet)
+        {
+            WaitForSingleObject(m_submitEvent, 10);
+            continue;
+        }
+
+        ProcessPacket(*packet);
+        m_submitQueue.Pop();
+    }
+
+    Utils::LogInfo("OpenXR: Submission thread stopped");
+}
+
+// Submission thread: restore and release the packet's images, wait for the
+// Present's GPU work, then end the frame with the layers the render thread built.
+// Packets that do not end a frame are not waited on: the fence is monotonic
+// on one queue, so the wait of the packet that ends the frame covers them
+void VRSystem::Impl::ProcessPacket(const SubmitPacket& packet)
+{
+    bool copyDone = packet.copyFenceValue != 0 && WaitForEyeCopy(packet);
+    ReleaseImages(packet, copyDone);
+
+    if (!packet.endFrame)
+    {
+        return;
+    }
+
+    if (packet.fenceValue != 0 &&
+        FenceWait::Wait(m_fenceEvents, { m_fence.Get(), packet.fenceValue }, VRConfig::GetGPUWaitTimeout(),
+                        FENCE_SPIN_TIME) != FenceWait::Result::Complete)
+    {
+        // The runtime waits on the queue itself; the frame still goes out
+        Utils::LogWarn("D3D12: GPU wait timed out");
+    }
+
+    bool stale = false;
+    {
+        // Only the frame the layers were built for: one the pacer already
+        // ended empty, or the one begun after it, is not ended with them
+        ThreadSafe::Lock frameLock(m_frameMutex);
+        if (m_frameInProgress.load() && packet.sessionEpoch == m_sessionEpoch.load() &&
+            packet.displayTime == m_frameState.predictedDisplayTime)
+        {
+            XrFrameEndInfo endInfo = { XR_TYPE_FRAME_END_INFO };
+            endInfo.displayTime = m_frameState.predictedDisplayTime;
+            endInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+            bool submitLayers = m_frameState.shouldRender && packet.submitLayers;
+            endInfo.layerCount = submitLayers ? packet.layerCount : 0;
+            endInfo.layers = submitLayers ? packet.layers : nullptr;
+
+            xrEndFrame(m_session, &endInfo);
+            m_frameInProgress.store(false);
+        }
+        else
+        {
+            stale = true;
+        }
+    }
+    m_frameEnded.notify_one();
+
+    if (stale && (m_stalePackets++ % 100) == 0)
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: Layers for an earlier frame dropped (%llu so far)",
+                 static_cast<unsigned long long>(m_stalePackets));
+        Utils::LogWarn(msg);
+    }
+}
+
+// Render thread: the layers of the frame in m_renderFrame, built in the packet
+void VRSystem::Impl::BuildLayers(SubmitPacket& packet)
+{
+    bool haveBothEyes = true;
+    bool haveDepth = m_hasDepthSwapchains;
+    bool haveMotion = m_hasMotionSwapchains;
+    for (int i = 0; i < 2; i++)
+    {
+        // Each eye is tagged with the pose its latest image was rendered with
+        const EyeWrite& eyeWrite = m_eyeWrites[i];
+        haveBothEyes = haveBothEyes && eyeWrite.frame != NO_FRAME;
+        haveDepth = haveDepth && eyeWrite.hasDepth;
+        haveMotion = haveMotion && eyeWrite.hasMotion;
+
+        RenderedViews rendered;
+        bool haveRendered = eyeWrite.frame != NO_FRAME && m_poseHistory.Read(eyeWrite.frame, rendered);
+
+        const SwapchainInfo& eyeSwapchain = GetEyeSwapchain(i);
+        XrCompositionLayerProjectionView& view = packet.projectionViews[i];
+        view.type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
+        view.pose = haveRendered ? rendered.pose[i] : m_renderFrame.views[i].pose;
+        view.fov = haveRendered ? rendered.fov[i] : m_renderFrame.views[i].fov;
+        view.subImage.swapchain = eyeSwapchain.handle;
+        view.subImage.imageRect.offset = { 0, 0 };
+        view.subImage.imageRect.extent = eyeWrite.extent;
+        view.subImage.imageArrayIndex = m_eyeTargets[i].arrayIndex;
+        view.next = nullptr;
+    }
+
+    // Depth lets the runtime reproject position, not only rotation
+    if (haveDepth)
+    {
+        float nearZ = VRConfig::GetDepthNear();
+        float farZ = VRConfig::GetDepthFar();
+        bool reversed = VRConfig::IsDepthReversed();
+
+        for (int i = 0; i < 2; i++)
+        {
+            const SwapchainInfo& depthSwapchain = GetEyeDepthSwapchain(i);
+            XrCompositionLayerDepthInfoKHR& depthInfo = packet.depthInfos[i];
+            depthInfo = { XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR };
+            depthInfo.subImage.swapchain = depthSwapchain.handle;
+            depthInfo.subImage.imageRect = m_eyeWrites[i].depthRect;
+            depthInfo.subImage.imageArrayIndex = m_eyeTargets[i].arrayIndex;
+            depthInfo.minDepth = 0.0f;
+            depthInfo.maxDepth = 1.0f;
+            // nearZ is the distance at minDepth: the far plane when depth is reversed
+            depthInfo.nearZ = reversed ? farZ : nearZ;
+            depthInfo.farZ = reversed ? nearZ : farZ;
+            packet.projectionViews[i].next = &depthInfo;
+
+            // Space warp synthesizes frames from the game's motion and the same depth
+            if (haveMotion)
+            {
+                const SwapchainInfo& motionSwapchain = GetEyeMotionSwapchain(i);
+                XrCompositionLayerSpaceWarpInfoFB& spaceWarpInfo = packet.spaceWarpInfos[i];
+                spaceWarpInfo = { XR_TYPE_COMPOSITION_LAYER_SPACE_WARP_INFO_FB };
+                spaceWarpInfo.next = &depthInfo;
+                spaceWarpInfo.motionVectorSubImage.swapchain = motionSwapchain.handle;
+                spaceWarpInfo.motionVectorSubImage.imageRect = m_eyeWrites[i].depthRect;
+                spaceWarpInfo.motionVectorSubImage.imageArrayIndex = m_eyeTargets[i].arrayIndex;
+                // The app space never moves; locomotion is already in the game's vectors
+                spaceWarpInfo.appSpaceDeltaPose.orientation.w = 1.0f;
+                spaceWarpInfo.depthSubImage = depthInfo.subImage;
+                spaceWarpInfo.minDepth = depthInfo.minDepth;
+                spaceWarpInfo.maxDepth = depthInfo.maxDepth;
+                spaceWarpInfo.nearZ = depthInfo.nearZ;
+                spaceWarpInfo.farZ = depthInfo.farZ;
+                packet.projectionViews[i].next = &spaceWarpInfo;
             }
         }
+    }
 
-        // Menu button (global, not per-hand)
-        XrActionStateBoolean menuState = { XR_TYPE_ACTION_STATE_BOOLEAN };
-        XrActionStateGetInfo menuGetInfo = { XR_TYPE_ACTION_STATE_GET_INFO };
-        menuGetInfo.action = m_menuButtonAction;
-        menuGetInfo.subactionPath = XR_NULL_PATH;
-        if (XR_SUCCEEDED(xrGetActionStateBoolean(m_session, &menuGetInfo, &menuState)) && menuState.isActive)
+    packet.projectionLayer = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
+    packet.projectionLayer.space = m_appSpace;
+    packet.projectionLayer.viewCount = 2;
+    packet.projectionLayer.views = packet.projectionViews;
+
+    // Full-density inset over the outer band, then UI on top of the scene
+    packet.layers[0] = reinterpret_cast<const XrCompositionLayerBaseHeader*>(&packet.projectionLayer);
+    packet.layerCount = 1;
+    if (const XrCompositionLayerBaseHeader* inset = BuildInsetLayer(packet))
+    {
+        packet.layers[packet.layerCount++] = inset;
+    }
+    if (const XrCompositionLayerBaseHeader* uiLayer = BuildUiLayer())
+    {
+        // BuildUiLayer fills a member; the packet needs its own copy
+        if (uiLayer->type == XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR)
+        {
+            packet.uiCylinder = m_uiCylinder;
+            packet.layers[packet.layerCount++] = reinterpret_cast<const XrCompositionLayerBaseHeader*>(&packet.uiCylinder);
+        }
+        else
         {
-            if (menuState.currentState)
-                m_controllerState.buttons |= VRControllerState::BUTTON_START;
+            packet.uiQuad = m_uiQuad;
+            packet.layers[packet.layerCount++] = reinterpret_cast<const XrCompositionLayerBaseHeader*>(&packet.uiQuad);
         }
+    }
 
-        // Grip buttons (based on grip value)
-        if (m_controllerState.leftGrip > 0.8f)
-            m_controllerState.buttons |= VRControllerState::BUTTON_LEFT_SHOULDER;
-        if (m_controllerState.rightGrip > 0.8f)
-            m_controllerState.buttons |= VRControllerState::BUTTON_RIGHT_SHOULDER;
+    packet.submitLayers = haveBothEyes;
+}
 
-        m_controllersAvailable.store(m_controllerState.leftHandValid || m_controllerState.rightHandValid);
-    }
+void VRSystem::Impl::PacingThreadMain()
+{
+    Utils::LogInfo("OpenXR: Frame pacing thread started");
 
-    bool CreateD3D12Resources()
+    while (!m_stopPacing.load())
     {
-        if (!m_device)
-        {
-            Utils::LogError("D3D12: No device available");
-            return false;
-        }
+        PollEvents();
 
-        if (FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-            IID_PPV_ARGS(&m_commandAllocator))))
+        // Same path as a lost instance: everything is rebuilt from the settings
+        if (VRConfig::TakeRestartRequest() && m_instance != XR_NULL_HANDLE)
         {
-            Utils::LogError("D3D12: Failed to create command allocator");
-            return false;
+            Utils::LogInfo("OpenXR: Restarting for new settings");
+            RequestRecovery(Recovery::Instance);
         }
 
-        if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
-            m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList))))
+        if (m_recovery != Recovery::None)
         {
-            Utils::LogError("D3D12: Failed to create command list");
-            return false;
+            RecoverSession();
+            continue;
         }
-        m_commandList->Close();
 
-        if (FAILED(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence))))
+        if (!IsSessionRunning())
         {
-            Utils::LogError("D3D12: Failed to create fence");
-            return false;
+            UpdateActivity(false);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
         }
 
-        m_fenceEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
-        if (!m_fenceEvent)
+        if (!WaitForFrameEnd())
         {
-            Utils::LogError("D3D12: Failed to create fence event");
-            return false;
+            break;
         }
 
-        Utils::LogInfo("D3D12: Copy resources created");
-        return true;
-    }
-
-    bool WaitForGPU()
-    {
-        if (!m_fence || !m_commandQueue) return false;
-
-        UINT64 fenceValue = m_fenceValue.fetch_add(1) + 1;
-        HRESULT hr = m_commandQueue->Signal(m_fence.Get(), fenceValue);
-        if (FAILED(hr)) return false;
+        // The gap after a submission: make the swapchains the render thread
+        // asked for, then get the next images before the game needs them
+        ServiceSwapchainRequests();
+        PreAcquireImages();
 
-        if (m_fence->GetCompletedValue() < fenceValue)
+        XrFrameState frameState = { XR_TYPE_FRAME_STATE };
+        XrFrameWaitInfo waitInfo = { XR_TYPE_FRAME_WAIT_INFO };
+        XrResult result = xrWaitFrame(m_session, &waitInfo, &frameState);
+        if (XR_FAILED(result))
         {
-            hr = m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
-            if (FAILED(hr)) return false;
-
-            DWORD timeout = VRConfig::GetGPUWaitTimeout();
-            DWORD result = WaitForSingleObject(m_fenceEvent, timeout);
-
-            if (result == WAIT_TIMEOUT)
+            if (result == XR_ERROR_SESSION_LOST || result == XR_ERROR_INSTANCE_LOST)
             {
-                Utils::LogWarn("D3D12: GPU wait timed out");
-                return false;
-            }
-            else if (result != WAIT_OBJECT_0)
-            {
-                Utils::LogError("D3D12: GPU wait failed");
-                return false;
+                RequestRecovery(result == XR_ERROR_INSTANCE_LOST ? Recovery::Instance : Recovery::Session);
+                continue;
             }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
         }
 
-        return true;
-    }
+        Activity activity = UpdateActivity(frameState.shouldRender);
 
-    void CopyTexture(ID3D12Resource* source, ID3D12Resource* dest)
-    {
-        if (!source || !dest || !m_commandList || !m_commandAllocator) return;
+        // Input only reaches the game while the session has focus
+        if (activity == Activity::Focused)
+        {
+            SyncActions(frameState.predictedDisplayTime);
+        }
+        else
+        {
+            m_controllersAvailable.store(false);
+        }
+
+        if (activity == Activity::Hidden)
+        {
+            EndIdleFrame(frameState);
+            std::this_thread::sleep_for(IDLE_FRAME_INTERVAL);
+            continue;
+        }
 
-        HRESULT hr = m_commandAllocator->Reset();
-        if (FAILED(hr)) return;
+        BeginFrame(frameState);
 
-        hr = m_commandList->Reset(m_commandAllocator.Get(), nullptr);
-        if (FAILED(hr)) return;
+        // Second chance for images the runtime was still reading before xrWaitFrame
+        PreAcquireImages();
+    }
 
-        D3D12_RESOURCE_BARRIER barriers[2] = {};
+    Utils::LogInfo("OpenXR: Frame pacing thread stopped");
+}
 
-        barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        barriers[0].Transition.pResource = source;
-        barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-        barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+// Block until the render thread has ended the current frame
+// If the game stops presenting (loading screen, alt-tab) the frame is ended
+// empty so the runtime keeps its frame loop alive
+// Returns false when the thread is asked to stop
+bool VRSystem::Impl::WaitForFrameEnd()
+{
+    ThreadSafe::UniqueLock lock(m_frameMutex);
+    bool ended = m_frameEnded.wait_for(lock, FRAME_END_TIMEOUT, [this] {
+        return !m_frameInProgress.load() || m_stopPacing.load();
+    });
 
-        barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        barriers[1].Transition.pResource = dest;
-        barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
-        barriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    if (m_stopPacing.load())
+    {
+        return false;
+    }
 
-        m_commandList->ResourceBarrier(2, barriers);
+    if (!ended)
+    {
+        XrFrameEndInfo endInfo = { XR_TYPE_FRAME_END_INFO };
+        endInfo.displayTime = m_frameState.predictedDisplayTime;
+        endInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+        xrEndFrame(m_session, &endInfo);
+        m_frameInProgress.store(false);
+    }
 
-        D3D12_RESOURCE_DESC srcDesc = source->GetDesc();
-        D3D12_RESOURCE_DESC dstDesc = dest->GetDesc();
+    return true;
+}
 
-        D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
-        srcLoc.pResource = source;
-        srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-        srcLoc.SubresourceIndex = 0;
+// Pacer thread, no frame in progress: (re)create the swapchains the render
+// thread asked for. Holding m_sessionMutex keeps Present out (it stays flat
+// meanwhile), and a destroy waits for the GPU here instead of on Present
+void VRSystem::Impl::ServiceSwapchainRequests()
+{
+    // The inset needs located views; the request stays until they are
+    bool insetRequested = m_insetRequested.load() && m_views[0].fov.angleRight > m_views[0].fov.angleLeft;
+    if (m_depthRequest.load() == 0 && m_uiRequest.load() == 0 && m_uiCaptureRequest.load() == 0 && !insetRequested)
+    {
+        return;
+    }
 
-        D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
-        dstLoc.pResource = dest;
-        dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-        dstLoc.SubresourceIndex = 0;
+    ThreadSafe::Lock sessionLock(m_sessionMutex);
 
-        D3D12_BOX srcBox = {};
-        srcBox.right = static_cast<UINT>(std::min(srcDesc.Width, dstDesc.Width));
-        srcBox.bottom = std::min(srcDesc.Height, dstDesc.Height);
-        srcBox.back = 1;
+    // Eye lists are recorded against the depth and inset images; the UI
+    // lists look after themselves
+    bool eyeListsStale = false;
+    uint64_t depthRequest = m_depthRequest.exchange(0);
+    if (depthRequest != 0 && m_depthFormatSupported &&
+        (!m_hasDepthSwapchains || PackExtent(m_depthSwapchains[0].width, m_depthSwapchains[0].height) != depthRequest))
+    {
+        CreateDepthSwapchains(static_cast<uint32_t>(depthRequest >> 32), static_cast<uint32_t>(depthRequest));
+        eyeListsStale = true;
+    }
 
-        m_commandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, &srcBox);
+    uint64_t uiRequest = m_uiRequest.exchange(0);
+    if (uiRequest != 0 && m_uiHashPipeline)
+    {
+        CreateUiSwapchain(static_cast<uint32_t>(uiRequest >> 32), static_cast<uint32_t>(uiRequest));
+    }
 
-        barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-        barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-        barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-        barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    uint64_t captureRequest = m_uiCaptureRequest.exchange(0);
+    if (captureRequest != 0 && m_uiHashPipeline)
+    {
+        CreateUiCapture(static_cast<uint32_t>(captureRequest >> 32), static_cast<uint32_t>(captureRequest),
+                        static_cast<DXGI_FORMAT>(m_uiCaptureFormat.load()));
+    }
 
-        m_commandList->ResourceBarrier(2, barriers);
-        m_commandList->Close();
+    if (insetRequested && m_insetRequested.exchange(false) && m_lensMatched)
+    {
+        CreateInsetSwapchains();
+        eyeListsStale = true;
+    }
 
-        ID3D12CommandList* lists[] = { m_commandList.Get() };
-        m_commandQueue->ExecuteCommandLists(1, lists);
+    // Never waits
+    if (eyeListsStale)
+    {
+        ResetCopyCache();
+    }
+}
 
-        WaitForGPU();
+// Pacer thread: derive the activity from the session state and the latest
+// shouldRender, log changes
+Activity VRSystem::Impl::UpdateActivity(bool shouldRender)
+{
+    SessionState state = m_sessionState.load();
+    Activity activity = Activity::Stopped;
+    if (IsSessionRunning())
+    {
+        activity = (!shouldRender || state == SessionState::Synchronized) ? Activity::Hidden :
+                   (state == SessionState::Focused) ? Activity::Focused : Activity::Visible;
     }
 
-    void HandleSessionStateChange(XrSessionState newState)
+    Activity previous = m_activity.exchange(activity);
+    if (activity != previous)
     {
-        switch (newState)
-        {
-        case XR_SESSION_STATE_IDLE:
-            m_sessionState.store(SessionState::Idle);
-            Utils::LogInfo("OpenXR: Session IDLE");
-            break;
+        static const char* NAMES[] = { "stopped", "hidden", "visible", "focused" };
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: Activity %s -> %s",
+                 NAMES[static_cast<int>(previous)], NAMES[static_cast<int>(activity)]);
+        Utils::LogInfo(msg);
 
-        case XR_SESSION_STATE_READY:
+        if (previous < Activity::Visible && activity >= Activity::Visible)
         {
-            m_sessionState.store(SessionState::Ready);
-            Utils::LogInfo("OpenXR: Session READY - Beginning session");
+            m_activityResumed.store(true);
+        }
+    }
+    return activity;
+}
 
-            XrSessionBeginInfo beginInfo = { XR_TYPE_SESSION_BEGIN_INFO };
-            beginInfo.primaryViewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+// Frames are shown (the render thread copies eyes and poses the camera)
+bool VRSystem::Impl::IsRendering() const
+{
+    return m_activity.load() >= Activity::Visible;
+}
 
-            XrResult result = xrBeginSession(m_session, &beginInfo);
-            if (XR_FAILED(result))
-            {
-                Utils::LogError("OpenXR: Failed to begin session");
-            }
-            break;
-        }
+// Pacer thread: keep the runtime's frame loop alive without any rendering
+void VRSystem::Impl::EndIdleFrame(const XrFrameState& frameState)
+{
+    ThreadSafe::Lock lock(m_frameMutex);
 
-        case XR_SESSION_STATE_SYNCHRONIZED:
-            m_sessionState.store(SessionState::Synchronized);
-            Utils::LogInfo("OpenXR: Session SYNCHRONIZED");
-            break;
+    XrFrameBeginInfo beginInfo = { XR_TYPE_FRAME_BEGIN_INFO };
+    if (XR_FAILED(xrBeginFrame(m_session, &beginInfo)))
+    {
+        return;
+    }
 
-        case XR_SESSION_STATE_VISIBLE:
-            m_sessionState.store(SessionState::Visible);
-            Utils::LogInfo("OpenXR: Session VISIBLE");
-            break;
+    XrFrameEndInfo endInfo = { XR_TYPE_FRAME_END_INFO };
+    endInfo.displayTime = frameState.predictedDisplayTime;
+    endInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+    xrEndFrame(m_session, &endInfo);
+}
 
-        case XR_SESSION_STATE_FOCUSED:
-            m_sessionState.store(SessionState::Focused);
-            Utils::LogInfo("OpenXR: Session FOCUSED");
-            break;
+void VRSystem::Impl::BeginFrame(const XrFrameState& frameState)
+{
+    FrameSlot slot;
+    {
+        ThreadSafe::Lock lock(m_frameMutex);
 
-        case XR_SESSION_STATE_STOPPING:
+        XrFrameBeginInfo beginInfo = { XR_TYPE_FRAME_BEGIN_INFO };
+        if (XR_FAILED(xrBeginFrame(m_session, &beginInfo)))
         {
-            m_sessionState.store(SessionState::Stopping);
-            Utils::LogInfo("OpenXR: Session STOPPING");
-
-            XrResult result = xrEndSession(m_session);
-            if (XR_FAILED(result))
-            {
-                Utils::LogWarn("OpenXR: Failed to end session gracefully");
-            }
-            break;
+            return;
         }
 
-        case XR_SESSION_STATE_LOSS_PENDING:
-            m_sessionState.store(SessionState::LossPending);
-            Utils::LogWarn("OpenXR: Session LOSS_PENDING - HMD may have disconnected");
-            break;
+        m_frameState = frameState;
 
-        case XR_SESSION_STATE_EXITING:
-            m_sessionState.store(SessionState::Exiting);
-            Utils::LogInfo("OpenXR: Session EXITING");
-            break;
+        // Locate views
+        XrViewLocateInfo locateInfo = { XR_TYPE_VIEW_LOCATE_INFO };
+        locateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        locateInfo.displayTime = frameState.predictedDisplayTime;
+        locateInfo.space = m_appSpace;
 
-        default:
-            break;
-        }
-    }
+        XrViewState viewState = { XR_TYPE_VIEW_STATE };
+        uint32_t viewCount = 2;
 
-    bool IsSessionRunning() const
-    {
-        SessionState state = m_sessionState.load();
-        return state == SessionState::Synchronized ||
-               state == SessionState::Visible ||
-               state == SessionState::Focused;
+        XrResult result = xrLocateViews(m_session, &locateInfo, &viewState, 2, &viewCount, m_views.data());
+
+        slot.displayTime = frameState.predictedDisplayTime;
+        slot.displayPeriod = frameState.predictedDisplayPeriod;
+        slot.views[0] = m_views[0];
+        slot.views[1] = m_views[1];
+        slot.valid = XR_SUCCEEDED(result);
+
+        // A render thread that sees the frame in progress reads this slot or a later one
+        m_renderSlot.Publish(slot);
+        m_frameInProgress.store(true);
     }
-};
+
+    m_frameSlot.Publish(slot);
+}
+
+bool VRSystem::Impl::IsSessionRunning() const
+{
+    SessionState state = m_sessionState.load();
+    return state == SessionState::Synchronized ||
+           state == SessionState::Visible ||
+           state == SessionState::Focused;
+}
 
 // Public Interface
 
@@ -819,54 +3417,24 @@ VRSystem::VRSystem() : m_impl(std::make_unique<Impl>())
 
 VRSystem::~VRSystem()
 {
-    ThreadSafe::Lock lock(m_impl->m_mutex);
-
-    if (m_impl->m_fence)
-    {
-        m_impl->WaitForGPU();
-    }
-
-    for (int i = 0; i < 2; i++)
-    {
-        if (m_impl->m_swapchains[i].handle != XR_NULL_HANDLE)
-        {
-            xrDestroySwapchain(m_impl->m_swapchains[i].handle);
-        }
-    }
-
-    // Clean up hand spaces
-    for (int i = 0; i < 2; i++)
-    {
-        if (m_impl->m_handSpaces[i] != XR_NULL_HANDLE)
-        {
-            xrDestroySpace(m_impl->m_handSpaces[i]);
-        }
-    }
-
-    if (m_impl->m_appSpace != XR_NULL_HANDLE) xrDestroySpace(m_impl->m_appSpace);
-
-    // End session before destroying
-    if (m_impl->m_session != XR_NULL_HANDLE)
+    // A background Initialize starts the frame threads itself
+    if (m_impl->m_initThread.joinable())
     {
-        if (m_impl->IsSessionRunning())
-        {
-            xrEndSession(m_impl->m_session);
-        }
-        xrDestroySession(m_impl->m_session);
+        m_impl->m_initThread.join();
     }
 
-    // Clean up action set (must be done after session destroy)
-    if (m_impl->m_actionSet != XR_NULL_HANDLE)
-    {
-        xrDestroyActionSet(m_impl->m_actionSet);
-    }
+    // Stop both frame threads before any handle they use goes away
+    m_impl->StopSubmissionThread();
+    m_impl->StopPacingThread();
 
-    if (m_impl->m_instance != XR_NULL_HANDLE) xrDestroyInstance(m_impl->m_instance);
+    ThreadSafe::Lock lock(m_impl->m_mutex);
 
-    if (m_impl->m_fenceEvent) CloseHandle(m_impl->m_fenceEvent);
+    // Action set must be destroyed after the session
+    m_impl->DestroySession();
+    m_impl->DestroyInstance();
 }
 
-bool VRSystem::Initialize(ID3D12CommandQueue* gameCommandQueue)
+bool VRSystem::Initialize(ID3D12CommandQueue* gameCommandQueue, uint32_t backBufferFormat)
 {
     ThreadSafe::Lock lock(m_impl->m_mutex);
 
@@ -907,6 +3475,7 @@ bool VRSystem::Initialize(ID3D12CommandQueue* gameCommandQueue)
         return false;
     }
 
+    m_impl->m_backBufferFormat = static_cast<DXGI_FORMAT>(backBufferFormat);
     if (!m_impl->CreateSwapchains())
     {
         Utils::LogError("Failed to create OpenXR Swapchains");
@@ -925,168 +3494,350 @@ bool VRSystem::Initialize(ID3D12CommandQueue* gameCommandQueue)
         Utils::LogWarn("OpenXR: Failed to attach action sets - controllers may not work");
     }
 
+    if (!m_impl->StartSubmissionThread())
+    {
+        return false;
+    }
+
     m_impl->m_sessionReady.store(true);
+    m_impl->StartPacingThread();
     Utils::LogInfo("OpenXR: Fully initialized!");
     return true;
 }
 
-bool VRSystem::Update(float& outX, float& outY, float& outZ,
-                      float& outQX, float& outQY, float& outQZ, float& outQW)
+void VRSystem::InitializeAsync(ID3D12CommandQueue* gameCommandQueue, uint32_t backBufferFormat)
 {
-    if (!m_impl->m_session || !m_impl->m_sessionReady.load())
+    if (m_impl->m_sessionReady.load())
     {
-        return false;
+        return;
     }
 
-    // Poll events
-    XrEventDataBuffer eventBuffer = { XR_TYPE_EVENT_DATA_BUFFER };
-    while (xrPollEvent(m_impl->m_instance, &eventBuffer) == XR_SUCCESS)
+    // Held until the worker is done with it
+    ComPtr<ID3D12CommandQueue> queue = gameCommandQueue;
+    std::thread previous = std::move(m_impl->m_initThread);
+
+    m_impl->m_initThread = std::thread([this, queue, backBufferFormat, previous = std::move(previous)]() mutable
     {
-        // Validate event type before casting
-        if (eventBuffer.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED)
+        // The instance started at plugin load is only waited for here, once
+        // the session actually needs it
+        if (previous.joinable())
         {
-            auto* stateEvent = reinterpret_cast<XrEventDataSessionStateChanged*>(&eventBuffer);
-            m_impl->HandleSessionStateChange(stateEvent->state);
+            previous.join();
         }
-        eventBuffer = { XR_TYPE_EVENT_DATA_BUFFER };
-    }
 
-    // Only proceed if session is running
-    if (!m_impl->IsSessionRunning())
+        auto start = std::chrono::steady_clock::now();
+        bool initialized = Initialize(queue.Get(), backBufferFormat);
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "OpenXR: Background initialization %s after %.0f ms",
+                 initialized ? "finished" : "failed", milliseconds);
+        initialized ? Utils::LogInfo(msg) : Utils::LogError(msg);
+    });
+}
+
+bool VRSystem::IsReady() const
+{
+    return m_impl->m_sessionReady.load();
+}
+
+bool VRSystem::GetFramePose(VRFramePose& outPose)
+{
+    if (!m_impl->m_session || !m_impl->m_sessionReady.load() || !m_impl->IsRendering())
     {
         return false;
     }
 
-    // Wait for frame
-    XrFrameWaitInfo waitInfo = { XR_TYPE_FRAME_WAIT_INFO };
-    XrResult result = xrWaitFrame(m_impl->m_session, &waitInfo, &m_impl->m_frameState);
-
-    // Sync controller input (reset buttons first)
-    m_impl->m_controllerState.buttons = 0;
-    m_impl->SyncActions(m_impl->m_frameState.predictedDisplayTime);
-    if (XR_FAILED(result))
+    // One snapshot per game frame: repeated camera updates are a plain copy
+    uint64_t presentCount = m_impl->m_presentCount.load();
+    VRFramePose& snapshot = m_impl->m_poseSnapshot;
+    if (!snapshot.valid || m_impl->m_poseSnapshotPresent != presentCount)
     {
-        return false;
+        // Latest views published by the pacing thread; never blocks
+        Impl::FrameSlot slot;
+        if (!m_impl->m_frameSlot.Read(slot) || !slot.valid)
+        {
+            return false;
+        }
+
+        // Frame being simulated now reaches Present after the pipelined frames
+        uint64_t frameIndex = presentCount + VRConfig::GetRenderLatency();
+
+        VRFramePose pose;
+        pose.frameIndex = frameIndex;
+        pose.isLeftEye = (frameIndex % 2) == 0;
+
+        const XrPosef& head = slot.views[0].pose;
+        CoordinateConversion::OpenXRToRED(head.position.x, head.position.y, head.position.z,
+                                          pose.x, pose.y, pose.z);
+        CoordinateConversion::OpenXRQuatToRED(head.orientation.x, head.orientation.y,
+                                              head.orientation.z, head.orientation.w,
+                                              pose.qx, pose.qy, pose.qz, pose.qw);
+        pose.valid = true;
+
+        Impl::RenderedViews rendered;
+        rendered.displayTime = slot.displayTime;
+        for (int i = 0; i < 2; i++)
+        {
+            rendered.pose[i] = slot.views[i].pose;
+            rendered.fov[i] = slot.views[i].fov;
+        }
+        m_impl->m_poseHistory.Write(frameIndex, rendered);
+
+        snapshot = pose;
+        m_impl->m_poseSnapshotPresent = presentCount;
     }
 
-    // Begin frame
-    XrFrameBeginInfo beginInfo = { XR_TYPE_FRAME_BEGIN_INFO };
-    result = xrBeginFrame(m_impl->m_session, &beginInfo);
-    if (XR_FAILED(result))
+    outPose = snapshot;
+    return true;
+}
+
+bool VRSystem::GetControllerState(VRControllerState& outState)
+{
+    if (!m_impl->m_controllersAvailable.load())
     {
         return false;
     }
 
-    m_impl->m_frameInProgress.store(true);
+    ThreadSafe::Lock lock(m_impl->m_controllerMutex);
+    outState = m_impl->m_publishedControllerState;
+    return true;
+}
+
+void VRSystem::SetVisibilityMaskCallback(VRVisibilityMaskCallback callback, void* userData)
+{
+    {
+        ThreadSafe::Lock lock(m_impl->m_visibilityCallbackMutex);
+        m_impl->m_visibilityMaskCallback = callback;
+        m_impl->m_visibilityMaskUserData = userData;
+    }
 
-    // Locate views
-    XrViewLocateInfo locateInfo = { XR_TYPE_VIEW_LOCATE_INFO };
-    locateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
-    locateInfo.displayTime = m_impl->m_frameState.predictedDisplayTime;
-    locateInfo.space = m_impl->m_appSpace;
+    // Deliver masks loaded before registration on the next submit
+    m_impl->m_visibilityMaskNotify.store(true);
+}
 
-    XrViewState viewState = { XR_TYPE_VIEW_STATE };
-    uint32_t viewCount = 2;
+void VRSystem::InvalidateBackBuffers()
+{
+    m_impl->m_copyCacheDirty.store(true);
+}
 
-    result = xrLocateViews(m_impl->m_session, &locateInfo, &viewState, 2, &viewCount, m_impl->m_views.data());
-    if (XR_SUCCEEDED(result))
+void VRSystem::SubmitUI(ID3D12Resource* uiTarget)
+{
+    if (!m_impl->m_sessionReady.load() || !m_impl->IsRendering() || !VRConfig::IsUILayer())
     {
-        float oxrX = m_impl->m_views[0].pose.position.x;
-        float oxrY = m_impl->m_views[0].pose.position.y;
-        float oxrZ = m_impl->m_views[0].pose.position.z;
+        m_impl->m_uiVisible = false;
+        return;
+    }
 
-        float oxrQX = m_impl->m_views[0].pose.orientation.x;
-        float oxrQY = m_impl->m_views[0].pose.orientation.y;
-        float oxrQZ = m_impl->m_views[0].pose.orientation.z;
-        float oxrQW = m_impl->m_views[0].pose.orientation.w;
+    ThreadSafe::UniqueLock sessionLock(m_impl->m_sessionMutex, std::try_to_lock);
+    if (!sessionLock.owns_lock())
+    {
+        m_impl->m_uiVisible = false;
+        return;
+    }
 
-        CoordinateConversion::OpenXRToRED(oxrX, oxrY, oxrZ, outX, outY, outZ);
-        CoordinateConversion::OpenXRQuatToRED(oxrQX, oxrQY, oxrQZ, oxrQW, outQX, outQY, outQZ, outQW);
+    m_impl->m_renderSlot.Read(m_impl->m_renderFrame);
+    m_impl->UpdateUi(uiTarget);
+}
 
-        return true;
+bool VRSystem::CaptureUi(ID3D12GraphicsCommandList* commandList, ID3D12Resource* uiTarget, uint32_t uiState)
+{
+    if (!commandList || !uiTarget || !VRConfig::IsVREnabled() || !VRConfig::IsUILayer() ||
+        !m_impl->m_sessionReady.load() || !m_impl->IsRendering())
+    {
+        return false;
     }
 
-    return false;
+    return m_impl->RecordUiCapture(commandList, uiTarget, static_cast<D3D12_RESOURCE_STATES>(uiState));
 }
 
-bool VRSystem::GetControllerState(VRControllerState& outState)
+void VRSystem::SetPresentQueue(ID3D12CommandQueue* queue)
 {
-    if (!m_impl->m_controllersAvailable.load())
+    if (!queue || queue == m_impl->m_commandQueue.Get())
     {
-        return false;
+        return;
     }
 
-    // Copy the cached state (thread-safe via atomic flag check)
-    outState = m_impl->m_controllerState;
-    return true;
+    {
+        ThreadSafe::Lock lock(m_impl->m_presentQueueMutex);
+        m_impl->m_presentQueue = queue;
+    }
+
+    if (!m_impl->m_gameTimer.IsTimed(queue))
+    {
+        m_impl->m_gameTimer.SetQueue(queue, VRConfig::GetGPUWaitTimeout());
+
+        char msg[128];
+        snprintf(msg, sizeof(msg), "D3D12: Timing the game's GPU work on its present queue 0x%p", queue);
+        Utils::LogInfo(msg);
+    }
 }
 
-void VRSystem::SubmitFrame(ID3D12Resource* gameTexture, bool isLeftEye)
+void VRSystem::OnQueueSubmit(ID3D12CommandQueue* queue)
 {
-    if (!m_impl->m_sessionReady.load() || !m_impl->IsSessionRunning())
+    if (!queue || !VRConfig::IsVREnabled() || !m_impl->m_sessionReady.load() || !m_impl->IsRendering())
     {
         return;
     }
 
-    int eyeIndex = isLeftEye ? 0 : 1;
+    m_impl->BeginGpuTime(queue);
+}
+
+void VRSystem::SubmitFrame(ID3D12Resource* gameTexture, uint32_t backBufferIndex, ID3D12Resource* depthTexture,
+                           ID3D12Resource* motionVectors)
+{
+    // Alternate eye rendering: the present count decides the eye, and the
+    // camera pose for the next game frame is keyed by the same count
+    uint64_t frame = m_impl->m_presentCount.fetch_add(1);
+    bool isLeftEye = (frame % 2) == 0;
 
-    if (m_impl->m_swapchains[eyeIndex].handle == XR_NULL_HANDLE || !gameTexture)
+    // The game's GPU work for this frame is all queued
+    m_impl->m_gameTimer.End();
+
+    // Nothing is shown: no copies, and the pacer ends empty frames by itself
+    if (!m_impl->m_sessionReady.load() || !m_impl->IsRendering())
     {
         return;
     }
 
-    uint32_t imageIndex;
-    XrSwapchainImageAcquireInfo acquireInfo = { XR_TYPE_SWAPCHAIN_IMAGE_ACQUIRE_INFO };
-    if (XR_FAILED(xrAcquireSwapchainImage(m_impl->m_swapchains[eyeIndex].handle, &acquireInfo, &imageIndex)))
+    // Being rebuilt on the pacer thread: this Present stays flat
+    ThreadSafe::UniqueLock sessionLock(m_impl->m_sessionMutex, std::try_to_lock);
+    if (!sessionLock.owns_lock())
     {
         return;
     }
 
-    XrSwapchainImageWaitInfo waitInfo = { XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO };
-    waitInfo.timeout = 100000000; // 100ms timeout instead of infinite
-    if (XR_FAILED(xrWaitSwapchainImage(m_impl->m_swapchains[eyeIndex].handle, &waitInfo)))
+    // Views of the latest begun frame, for anything recorded below
+    m_impl->m_renderSlot.Read(m_impl->m_renderFrame);
+
+    // The gap since the last shown frame is not a frame cost
+    if (m_impl->m_activityResumed.exchange(false))
+    {
+        m_impl->m_lastSubmitTime = {};
+        m_impl->m_pairCostSeconds = 0.0;
+    }
+
+    int eyeIndex = isLeftEye ? 0 : 1;
+    Impl::SwapchainInfo& swapchain = m_impl->GetEyeSwapchain(eyeIndex);
+
+    // Frame cost for the performance levels: submit-to-submit interval
+    // The same interval is the game's present rate for the refresh rate choice
+    auto now = std::chrono::steady_clock::now();
+    if (m_impl->m_lastSubmitTime != std::chrono::steady_clock::time_point{})
+    {
+        double interval = std::chrono::duration<double>(now - m_impl->m_lastSubmitTime).count();
+        m_impl->m_pairCostSeconds += interval;
+        m_impl->UpdateRefreshRate(interval);
+    }
+    m_impl->m_lastSubmitTime = now;
+
+    if (swapchain.handle == XR_NULL_HANDLE || !gameTexture)
     {
-        Utils::LogWarn("OpenXR: Swapchain wait timed out");
         return;
     }
 
-    ID3D12Resource* destTexture = m_impl->m_swapchains[eyeIndex].images[imageIndex].texture;
-    m_impl->CopyTexture(gameTexture, destTexture);
+    Impl::SubmitPacket* packet = m_impl->m_submitQueue.BeginPush();
+    if (!packet)
+    {
+        m_impl->LogDroppedPacket();
+        return;
+    }
 
-    XrSwapchainImageReleaseInfo releaseInfo = { XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO };
-    xrReleaseSwapchainImage(m_impl->m_swapchains[eyeIndex].handle, &releaseInfo);
+    // Without a ready image the eye keeps its previous image and the frame is
+    // still ended. A shared array swapchain's next image would miss this eye's
+    // slice, so the eye is dropped until it is written again
+    bool haveImage = m_impl->AcquireEyeImage(eyeIndex);
+    if (!haveImage && !m_impl->m_eyeTargets[eyeIndex].releaseAfterWrite)
+    {
+        m_impl->m_eyeWrites[eyeIndex].frame = Impl::NO_FRAME;
+    }
 
-    // End frame after right eye
-    if (!isLeftEye && m_impl->m_frameInProgress.load())
+    // Everything below only queues GPU work. Images are handed to the
+    // submission thread once their writes are queued: the runtime waits on
+    // m_commandQueue before reading
+    // A copy queue copy leaves the image in COMMON: the submission thread
+    // moves it back before releasing it
+    ID3D12GraphicsCommandList* copyList = nullptr;
+    packet->copyFenceValue = 0;
+    if (haveImage)
     {
-        for (int i = 0; i < 2; i++)
+        uint32_t imageIndex = static_cast<uint32_t>(swapchain.acquiredImage);
+        copyList = m_impl->GetCopyList(gameTexture, backBufferIndex, eyeIndex, imageIndex);
+        m_impl->BeginOutputTime();
+        packet->copyFenceValue = m_impl->ExecuteEyeCopy(copyList, eyeIndex, imageIndex);
+        packet->imageIndex = imageIndex;
+        if (copyList)
         {
-            m_impl->m_projectionViews[i].type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
-            m_impl->m_projectionViews[i].pose = m_impl->m_views[i].pose;
-            m_impl->m_projectionViews[i].fov = m_impl->m_views[i].fov;
-            m_impl->m_projectionViews[i].subImage.swapchain = m_impl->m_swapchains[i].handle;
-            m_impl->m_projectionViews[i].subImage.imageRect.offset = { 0, 0 };
-            m_impl->m_projectionViews[i].subImage.imageRect.extent = {
-                m_impl->m_swapchains[i].width,
-                m_impl->m_swapchains[i].height
-            };
-            m_impl->m_projectionViews[i].subImage.imageArrayIndex = 0;
+            m_impl->m_eyeWrites[eyeIndex] = { frame, m_impl->m_eyeExtents[eyeIndex], false, {}, false };
         }
 
-        XrCompositionLayerProjection projectionLayer = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
-        projectionLayer.space = m_impl->m_appSpace;
-        projectionLayer.viewCount = 2;
-        projectionLayer.views = m_impl->m_projectionViews.data();
+        if (copyList && m_impl->m_lensMatched)
+        {
+            m_impl->m_insetWritten[eyeIndex] = m_impl->SubmitInset(backBufferIndex, eyeIndex);
+        }
+        m_impl->EndOutputTime();
 
-        const XrCompositionLayerBaseHeader* layers[] = { (XrCompositionLayerBaseHeader*)&projectionLayer };
+        if (m_impl->m_eyeTargets[eyeIndex].releaseAfterWrite)
+        {
+            m_impl->ReleaseEyeImage(eyeIndex);
+        }
+    }
 
-        XrFrameEndInfo endInfo = { XR_TYPE_FRAME_END_INFO };
-        endInfo.displayTime = m_impl->m_frameState.predictedDisplayTime;
-        endInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
-        endInfo.layerCount = m_impl->m_frameState.shouldRender ? 1 : 0;
-        endInfo.layers = m_impl->m_frameState.shouldRender ? layers : nullptr;
+    if (copyList)
+    {
+        Impl::EyeWrite& eyeWrite = m_impl->m_eyeWrites[eyeIndex];
+        eyeWrite.hasDepth = m_impl->SubmitDepth(depthTexture, eyeIndex, eyeWrite.depthRect);
+    }
+
+    if (m_impl->m_eyeWrites[eyeIndex].hasDepth && m_impl->m_eyeWrites[eyeIndex].frame == frame)
+    {
+        m_impl->m_eyeWrites[eyeIndex].hasMotion = m_impl->SubmitMotion(motionVectors, eyeIndex);
+    }
+
+    packet->frame = frame;
+    packet->sessionEpoch = m_impl->m_sessionEpoch.load();
+    packet->eyeIndex = eyeIndex;
+    packet->backBufferIndex = backBufferIndex;
+    packet->fenceValue = m_impl->SignalFence();
+    packet->endFrame = false;
+    packet->releaseCount = m_impl->m_pendingReleaseCount;
+    std::copy_n(m_impl->m_pendingReleases, m_impl->m_pendingReleaseCount, packet->releases);
+    m_impl->m_pendingReleaseCount = 0;
+
+    // End frame after right eye, or after every eye when each game frame is
+    // submitted: the fresh eye goes out with the other eye's latest image.
+    // The submission thread calls xrEndFrame once the GPU work is done, and
+    // only for the frame stamped here
+    XrDuration displayPeriod = 0;
+    bool endFrame = false;
+    if (!isLeftEye || m_impl->IsEveryFrameSubmit())
+    {
+        // Otherwise the pacer has not begun a frame yet and this one is dropped.
+        // The slot is published before the flag is set, so it is this frame's or newer
+        if (m_impl->m_frameInProgress.load() && m_impl->m_renderSlot.Read(m_impl->m_renderFrame))
+        {
+            packet->displayTime = m_impl->m_renderFrame.displayTime;
+            m_impl->BuildLayers(*packet);
+            packet->endFrame = true;
+            endFrame = true;
+            displayPeriod = m_impl->m_renderFrame.displayPeriod;
+        }
+    }
+    m_impl->PushPacket();
+
+    if (isLeftEye)
+    {
+        return;
+    }
 
-        xrEndFrame(m_impl->m_session, &endInfo);
-        m_impl->m_frameInProgress.store(false);
+    if (!endFrame)
+    {
+        m_impl->m_pairCostSeconds = 0.0;
+        return;
     }
+
+    // Resize between frame pairs so both eyes of a pair share one extent
+    m_impl->UpdateOutputScale(gameTexture, displayPeriod);
+    m_impl->UpdatePerfLevels(m_impl->m_pairCostSeconds, m_impl->ReadGpuTime(), displayPeriod);
+    m_impl->m_pairCostSeconds = 0.0;
 }
@@ -0,0 +1,501 @@
+#include "VRSystemImpl.hpp"
+#include "MotionVectors.hpp"
+
+// Depth and motion vector layers: swapchains, copies and the conversion pass
+// chained onto the eye projection layers
+
+void VRSystem::Impl::CheckDepthSupport()
+{
+    if (!m_depthLayerSupported)
+    {
+        return;
+    }
+
+    std::vector<int64_t> formats = EnumerateSwapchainFormats();
+    m_depthFormatSupported =
+        std::find(formats.begin(), formats.end(), static_cast<int64_t>(DXGI_FORMAT_D32_FLOAT)) != formats.end();
+    if (!m_depthFormatSupported)
+    {
+        Utils::LogWarn("OpenXR: Runtime has no D32_FLOAT swapchains - depth layer disabled");
+    }
+    else if (!VRConfig::IsDepthRangeSet())
+    {
+        Utils::LogWarn("OpenXR: Depth layer waits for the camera's clip planes (CyberpunkVR_SetDepthRange)");
+    }
+
+    if (m_spaceWarpSupported &&
+        std::find(formats.begin(), formats.end(), static_cast<int64_t>(MOTION_FORMAT)) == formats.end())
+    {
+        Utils::LogWarn("OpenXR: Runtime has no R16G16B16A16_FLOAT swapchains - space warp disabled");
+        m_spaceWarpSupported = false;
+    }
+}
+
+void VRSystem::Impl::DestroyDepthSwapchains()
+{
+    WaitForGPU();
+    RetireImages(ImageFamily::Depth);
+    for (SwapchainInfo& depth : m_depthSwapchains)
+    {
+        if (depth.handle != XR_NULL_HANDLE)
+        {
+            xrDestroySwapchain(depth.handle);
+        }
+        depth = SwapchainInfo();
+    }
+    m_hasDepthSwapchains = false;
+    m_eyeWrites[0].hasDepth = false;
+    m_eyeWrites[1].hasDepth = false;
+
+    DestroyMotionSwapchains();
+}
+
+void VRSystem::Impl::DestroyMotionSwapchains()
+{
+    WaitForGPU();
+    RetireImages(ImageFamily::Motion);
+    for (SwapchainInfo& motion : m_motionSwapchains)
+    {
+        if (motion.handle != XR_NULL_HANDLE)
+        {
+            xrDestroySwapchain(motion.handle);
+        }
+        motion = SwapchainInfo();
+    }
+    m_hasMotionSwapchains = false;
+    m_motionHeap.Reset();
+    m_eyeWrites[0].hasMotion = false;
+    m_eyeWrites[1].hasMotion = false;
+}
+
+// Motion swapchains match the depth swapchains: space warp pairs each motion
+// image with the depth image of the same eye. Failure only disables space warp
+bool VRSystem::Impl::CreateMotionSwapchains(uint32_t width, uint32_t height)
+{
+    DestroyMotionSwapchains();
+
+    for (uint32_t i = 0; i < m_swapchainCount; i++)
+    {
+        if (!CreateSwapchain(m_motionSwapchains[i], MOTION_FORMAT,
+                             XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT,
+                             width, height, m_swapchains[i].arraySize))
+        {
+            Utils::LogWarn("OpenXR: Motion vector swapchain creation failed - space warp disabled");
+            DestroyMotionSwapchains();
+            m_spaceWarpSupported = false;
+            return false;
+        }
+    }
+
+    if (!CreateMotionDescriptors())
+    {
+        DestroyMotionSwapchains();
+        m_spaceWarpSupported = false;
+        return false;
+    }
+
+    m_hasMotionSwapchains = true;
+    return true;
+}
+
+// One depth swapchain per colour swapchain, sized to the game's depth buffer
+bool VRSystem::Impl::CreateDepthSwapchains(uint32_t width, uint32_t height)
+{
+    DestroyDepthSwapchains();
+
+    for (uint32_t i = 0; i < m_swapchainCount; i++)
+    {
+        if (!CreateSwapchain(m_depthSwapchains[i], DXGI_FORMAT_D32_FLOAT,
+                             XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT | XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                             width, height, m_swapchains[i].arraySize))
+        {
+            Utils::LogWarn("OpenXR: Depth swapchain creation failed - depth layer disabled");
+            DestroyDepthSwapchains();
+            m_depthFormatSupported = false;
+            return false;
+        }
+    }
+
+    m_hasDepthSwapchains = true;
+
+    if (m_spaceWarpSupported && m_motionPipeline)
+    {
+        CreateMotionSwapchains(width, height);
+    }
+    return true;
+}
+
+// Motion vector conversion kernel; bound with the resample root signature
+bool VRSystem::Impl::CreateMotionPipeline()
+{
+    ComPtr<ID3DBlob> shader;
+    ComPtr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(MotionVectors::SHADER_SOURCE, strlen(MotionVectors::SHADER_SOURCE), "MotionVectors",
+                            nullptr, nullptr, "main", "cs_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &shader, &errors);
+    if (FAILED(hr))
+    {
+        Utils::LogError("D3D12: Failed to compile motion vector shader");
+        if (errors)
+        {
+            Utils::LogError(static_cast<const char*>(errors->GetBufferPointer()));
+        }
+        return false;
+    }
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineDesc = {};
+    pipelineDesc.pRootSignature = m_resampleRootSignature.Get();
+    pipelineDesc.CS.pShaderBytecode = shader->GetBufferPointer();
+    pipelineDesc.CS.BytecodeLength = shader->GetBufferSize();
+
+    if (FAILED(m_device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(&m_motionPipeline))))
+    {
+        Utils::LogError("D3D12: Failed to create motion vector pipeline");
+        return false;
+    }
+
+    return true;
+}
+
+// Motion image UAVs are written once here, the source SRV when lists are recorded
+bool VRSystem::Impl::CreateMotionDescriptors()
+{
+    UINT imageCount = static_cast<UINT>(GetEyeMotionSwapchain(0).images.size() + GetEyeMotionSwapchain(1).images.size());
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = 1 + imageCount;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+    if (FAILED(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_motionHeap))))
+    {
+        Utils::LogError("D3D12: Failed to create motion vector descriptor heap");
+        return false;
+    }
+
+    for (int eye = 0; eye < 2; eye++)
+    {
+        const SwapchainInfo& swapchain = GetEyeMotionSwapchain(eye);
+        for (uint32_t image = 0; image < swapchain.images.size(); image++)
+        {
+            D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+            uavDesc.Format = MOTION_FORMAT;
+            uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
+            uavDesc.Texture2DArray.FirstArraySlice = m_eyeTargets[eye].arrayIndex;
+            uavDesc.Texture2DArray.ArraySize = 1;
+
+            m_device->CreateUnorderedAccessView(swapchain.images[image].texture, nullptr, &uavDesc,
+                                                GetDescriptor(m_motionHeap.Get(), GetMotionDescriptorIndex(eye, image)));
+        }
+    }
+
+    return true;
+}
+
+UINT VRSystem::Impl::GetMotionDescriptorIndex(int eyeIndex, uint32_t imageIndex) const
+{
+    UINT index = 1 + imageIndex;
+    if (eyeIndex == 1)
+    {
+        index += static_cast<UINT>(m_motionSwapchains[m_eyeTargets[0].swapchainIndex].images.size());
+    }
+    return index;
+}
+
+// Depth is copied whole (a partial copy of a depth resource is invalid), so
+// the layer points the runtime at the part of it the eye image shows: the
+// same centre crop the resample pass takes from the back buffer, which is the
+// eye extent itself when colour is a plain copy. Depth smaller than the eye
+// image would have to be upscaled by the runtime and is not submitted
+bool VRSystem::Impl::IsDepthUsable(ID3D12Resource* depthSource, int eyeIndex, XrRect2Di& outRect)
+{
+    if (!depthSource || !m_depthFormatSupported)
+    {
+        return false;
+    }
+
+    D3D12_RESOURCE_DESC desc = depthSource->GetDesc();
+    const XrExtent2Di& extent = m_eyeExtents[eyeIndex];
+    uint32_t width = static_cast<uint32_t>(desc.Width);
+    uint32_t height = desc.Height;
+
+    EyeResample::Params crop = EyeResample::ComputeParams(width, height, static_cast<uint32_t>(extent.width),
+                                                          static_cast<uint32_t>(extent.height));
+    XrRect2Di rect;
+    rect.offset.x = static_cast<int32_t>(std::lround(crop.srcOffsetU * width));
+    rect.offset.y = static_cast<int32_t>(std::lround(crop.srcOffsetV * height));
+    rect.extent.width = std::min(static_cast<int32_t>(std::lround(crop.srcScaleU * width)),
+                                 static_cast<int32_t>(width) - rect.offset.x);
+    rect.extent.height = std::min(static_cast<int32_t>(std::lround(crop.srcScaleV * height)),
+                                  static_cast<int32_t>(height) - rect.offset.y);
+
+    // One texel of slack for the rounding of the crop
+    if (rect.extent.width + 1 < extent.width || rect.extent.height + 1 < extent.height)
+    {
+        if (!m_depthMismatchLogged)
+        {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "OpenXR: Depth %ux%u does not cover eye image %dx%d - depth layer skipped",
+                     width, height, extent.width, extent.height);
+            Utils::LogWarn(msg);
+            m_depthMismatchLogged = true;
+        }
+        return false;
+    }
+
+    outRect = rect;
+    return true;
+}
+
+// Depth swapchains sized for this depth buffer exist
+// Otherwise the pacer is asked to (re)create them and depth is skipped until then
+bool VRSystem::Impl::PrepareDepthSwapchains(ID3D12Resource* depthSource)
+{
+    D3D12_RESOURCE_DESC desc = depthSource->GetDesc();
+    if (m_hasDepthSwapchains && m_depthSwapchains[0].width == static_cast<int32_t>(desc.Width) &&
+        m_depthSwapchains[0].height == static_cast<int32_t>(desc.Height))
+    {
+        return true;
+    }
+
+    m_depthRequest.store(PackExtent(desc.Width, desc.Height));
+    return false;
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordDepthCopyList(ID3D12Resource* source,
+                                                                      int eyeIndex, uint32_t imageIndex)
+{
+    ID3D12Resource* dest = GetEyeDepthSwapchain(eyeIndex).images[imageIndex].texture;
+    UINT destSubresource = D3D12CalcSubresource(0, m_eyeTargets[eyeIndex].arrayIndex, 0, 1,
+                                                GetEyeDepthSwapchain(eyeIndex).arraySize);
+
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create depth copy command list");
+        return nullptr;
+    }
+
+    D3D12_RESOURCE_BARRIER barriers[2] = {};
+
+    barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barriers[0].Transition.pResource = source;
+    barriers[0].Transition.StateBefore = DEPTH_SOURCE_STATE;
+    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+    barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+    // Depth swapchain images are handed out in DEPTH_WRITE
+    barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barriers[1].Transition.pResource = dest;
+    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+    barriers[1].Transition.Subresource = destSubresource;
+
+    commandList->ResourceBarrier(2, barriers);
+
+    // Plane 0 is depth for both D32 and D32S8 sources
+    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+    srcLoc.pResource = source;
+    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    srcLoc.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+    dstLoc.pResource = dest;
+    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLoc.SubresourceIndex = destSubresource;
+
+    commandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+
+    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+    barriers[0].Transition.StateAfter = DEPTH_SOURCE_STATE;
+    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_DEPTH_WRITE;
+
+    commandList->ResourceBarrier(2, barriers);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close depth copy command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+ID3D12GraphicsCommandList* VRSystem::Impl::GetDepthCopyList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex)
+{
+    if (m_depthCacheSource != source)
+    {
+        // Depth lists share the allocator with the colour lists
+        if (m_depthCacheSource)
+        {
+            ResetCopyCache();
+        }
+        m_depthCacheSource = source;
+    }
+
+    std::vector<ComPtr<ID3D12GraphicsCommandList>>& lists = m_depthCopyLists[eyeIndex];
+    if (lists.empty())
+    {
+        const SwapchainInfo& depth = GetEyeDepthSwapchain(eyeIndex);
+        for (uint32_t image = 0; image < depth.images.size(); image++)
+        {
+            lists.push_back(RecordDepthCopyList(source, eyeIndex, image));
+        }
+    }
+
+    if (imageIndex >= lists.size()) return nullptr;
+    return lists[imageIndex].Get();
+}
+
+// Copy the game's depth for one eye; returns true if the eye has depth this frame
+// outRect receives the region of the depth image that matches the eye image
+bool VRSystem::Impl::SubmitDepth(ID3D12Resource* depthSource, int eyeIndex, XrRect2Di& outRect)
+{
+    // Without the clip planes the runtime cannot turn depth into distance
+    if (!VRConfig::IsDepthRangeSet() || !IsDepthUsable(depthSource, eyeIndex, outRect) ||
+        !PrepareDepthSwapchains(depthSource))
+    {
+        return false;
+    }
+
+    uint32_t swapchainIndex = m_eyeTargets[eyeIndex].swapchainIndex;
+    if (!TakeImage(ImageFamily::Depth, swapchainIndex))
+    {
+        return false;
+    }
+
+    SwapchainInfo& depth = GetEyeDepthSwapchain(eyeIndex);
+    ID3D12GraphicsCommandList* copyList = GetDepthCopyList(depthSource, eyeIndex, static_cast<uint32_t>(depth.acquiredImage));
+    ExecuteCopy(copyList);
+
+    if (m_eyeTargets[eyeIndex].releaseAfterWrite)
+    {
+        QueueRelease(ImageFamily::Depth, swapchainIndex);
+    }
+
+    return copyList != nullptr;
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordMotionList(ID3D12Resource* source,
+                                                                   int eyeIndex, uint32_t imageIndex)
+{
+    const SwapchainInfo& motion = GetEyeMotionSwapchain(eyeIndex);
+    ID3D12Resource* dest = motion.images[imageIndex].texture;
+    UINT destSubresource = D3D12CalcSubresource(0, m_eyeTargets[eyeIndex].arrayIndex, 0, 1, motion.arraySize);
+
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_commandAllocator.Get(), m_motionPipeline.Get(), IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create motion vector command list");
+        return nullptr;
+    }
+
+    MotionVectors::Convention convention = VRConfig::AreMotionVectorsToPrevious()
+        ? MotionVectors::Convention::ToPrevious : MotionVectors::Convention::ToCurrent;
+    MotionVectors::Params params = MotionVectors::ComputeParams(
+        convention, static_cast<uint32_t>(motion.width), static_cast<uint32_t>(motion.height));
+
+    D3D12_RESOURCE_BARRIER barriers[2] = {};
+
+    barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barriers[0].Transition.pResource = source;
+    barriers[0].Transition.StateBefore = MOTION_SOURCE_STATE;
+    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+    // Colour-attachment swapchain images are handed out in RENDER_TARGET
+    barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barriers[1].Transition.pResource = dest;
+    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    barriers[1].Transition.Subresource = destSubresource;
+
+    commandList->ResourceBarrier(2, barriers);
+
+    ID3D12DescriptorHeap* heaps[] = { m_motionHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetComputeRootSignature(m_resampleRootSignature.Get());
+    commandList->SetComputeRoot32BitConstants(0, MotionVectors::ROOT_CONSTANT_COUNT, &params, 0);
+    commandList->SetComputeRootDescriptorTable(1, GetGPUDescriptor(m_motionHeap.Get(), 0));
+    commandList->SetComputeRootDescriptorTable(2, GetGPUDescriptor(m_motionHeap.Get(), GetMotionDescriptorIndex(eyeIndex, imageIndex)));
+    commandList->Dispatch(MotionVectors::GetDispatchCount(params.dstWidth),
+                          MotionVectors::GetDispatchCount(params.dstHeight), 1);
+
+    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    barriers[0].Transition.StateAfter = MOTION_SOURCE_STATE;
+    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+
+    commandList->ResourceBarrier(2, barriers);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close motion vector command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+ID3D12GraphicsCommandList* VRSystem::Impl::GetMotionList(ID3D12Resource* source, int eyeIndex, uint32_t imageIndex)
+{
+    if (m_motionCacheSource != source)
+    {
+        // Motion lists share the allocator with the colour lists
+        if (m_motionCacheSource)
+        {
+            ResetCopyCache();
+        }
+        m_motionCacheSource = source;
+
+        D3D12_RESOURCE_DESC desc = source->GetDesc();
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = FormatUtils::GetSrvFormat(desc.Format);
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srvDesc.Texture2D.MipLevels = 1;
+        m_device->CreateShaderResourceView(source, &srvDesc, GetDescriptor(m_motionHeap.Get(), 0));
+    }
+
+    std::vector<ComPtr<ID3D12GraphicsCommandList>>& lists = m_motionLists[eyeIndex];
+    if (lists.empty())
+    {
+        const SwapchainInfo& motion = GetEyeMotionSwapchain(eyeIndex);
+        for (uint32_t image = 0; image < motion.images.size(); image++)
+        {
+            lists.push_back(RecordMotionList(source, eyeIndex, image));
+        }
+    }
+
+    if (imageIndex >= lists.size()) return nullptr;
+    return lists[imageIndex].Get();
+}
+
+// Convert the game's motion vectors for one eye; only called once the eye has
+// depth, so the motion image pairs with a depth image of the same size
+bool VRSystem::Impl::SubmitMotion(ID3D12Resource* motionSource, int eyeIndex)
+{
+    if (!motionSource || !m_hasMotionSwapchains)
+    {
+        return false;
+    }
+
+    uint32_t swapchainIndex = m_eyeTargets[eyeIndex].swapchainIndex;
+    if (!TakeImage(ImageFamily::Motion, swapchainIndex))
+    {
+        return false;
+    }
+
+    SwapchainInfo& motion = GetEyeMotionSwapchain(eyeIndex);
+    ID3D12GraphicsCommandList* motionList = GetMotionList(motionSource, eyeIndex, static_cast<uint32_t>(motion.acquiredImage));
+    ExecuteCopy(motionList);
+
+    if (m_eyeTargets[eyeIndex].releaseAfterWrite)
+    {
+        QueueRelease(ImageFamily::Motion, swapchainIndex);
+    }
+
+    return motionList != nullptr;
+}
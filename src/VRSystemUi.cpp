@@ -0,0 +1,670 @@
+#include "VRSystemImpl.hpp"
+#include "UiLayer.hpp"
+
+// UI layer: capture of the game's UI target, change detection and the
+// quad/cylinder layer it is submitted as
+
+// Hash pipeline, counter and readback used to detect UI changes, plus the
+// UI lists' allocator and the view the capture clears the UI target through
+bool VRSystem::Impl::CreateUiHashResources()
+{
+    ComPtr<ID3DBlob> shader;
+    ComPtr<ID3DBlob> errors;
+    HRESULT hr = D3DCompile(UiLayer::HASH_SHADER_SOURCE, strlen(UiLayer::HASH_SHADER_SOURCE), "UiHash",
+                            nullptr, nullptr, "main", "cs_5_0", D3DCOMPILE_OPTIMIZATION_LEVEL3, 0, &shader, &errors);
+    if (FAILED(hr))
+    {
+        Utils::LogError("D3D12: Failed to compile UI hash shader");
+        if (errors)
+        {
+            Utils::LogError(static_cast<const char*>(errors->GetBufferPointer()));
+        }
+        return false;
+    }
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineDesc = {};
+    pipelineDesc.pRootSignature = m_resampleRootSignature.Get();
+    pipelineDesc.CS.pShaderBytecode = shader->GetBufferPointer();
+    pipelineDesc.CS.BytecodeLength = shader->GetBufferSize();
+
+    if (FAILED(m_device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(&m_uiHashPipeline))))
+    {
+        Utils::LogError("D3D12: Failed to create UI hash pipeline");
+        return false;
+    }
+
+    D3D12_HEAP_PROPERTIES defaultHeap = { D3D12_HEAP_TYPE_DEFAULT };
+    D3D12_RESOURCE_DESC counterDesc = {};
+    counterDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    counterDesc.Width = 2;
+    counterDesc.Height = 1;
+    counterDesc.DepthOrArraySize = 1;
+    counterDesc.MipLevels = 1;
+    counterDesc.Format = DXGI_FORMAT_R32_UINT;
+    counterDesc.SampleDesc.Count = 1;
+    counterDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    D3D12_HEAP_PROPERTIES readbackHeap = { D3D12_HEAP_TYPE_READBACK };
+    D3D12_RESOURCE_DESC readbackDesc = {};
+    readbackDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    readbackDesc.Width = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+    readbackDesc.Height = 1;
+    readbackDesc.DepthOrArraySize = 1;
+    readbackDesc.MipLevels = 1;
+    readbackDesc.SampleDesc.Count = 1;
+    readbackDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    if (FAILED(m_device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &counterDesc,
+                                                 D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
+                                                 IID_PPV_ARGS(&m_uiHashCounter))) ||
+        FAILED(m_device->CreateCommittedResource(&readbackHeap, D3D12_HEAP_FLAG_NONE, &readbackDesc,
+                                                 D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                 IID_PPV_ARGS(&m_uiHashReadback))))
+    {
+        Utils::LogError("D3D12: Failed to create UI hash resources");
+        return false;
+    }
+
+    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
+    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+    rtvHeapDesc.NumDescriptors = 1;
+
+    if (FAILED(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_uiAllocator))) ||
+        FAILED(m_device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&m_uiRtvHeap))) ||
+        FAILED(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_uiCaptureFence))))
+    {
+        Utils::LogError("D3D12: Failed to create UI capture resources");
+        return false;
+    }
+
+    return true;
+}
+
+void VRSystem::Impl::DestroyUiSwapchain()
+{
+    m_uiLayerReady.store(false);
+    WaitForGPU();
+    ResetUiLists();
+    RetireImages(ImageFamily::Ui);
+    if (m_uiSwapchain.handle != XR_NULL_HANDLE)
+    {
+        xrDestroySwapchain(m_uiSwapchain.handle);
+    }
+    m_uiSwapchain = SwapchainInfo();
+    m_uiHeap.Reset();
+    m_uiImageValid = false;
+}
+
+// Layer image sized for text: the display's pixel density across the
+// widest layer angle, never more than the source has
+// A swapchain of another size is asked of the pacer; no UI until it is made
+bool VRSystem::Impl::PrepareUiSwapchain(ID3D12Resource* source)
+{
+    D3D12_RESOURCE_DESC desc = source->GetDesc();
+    uint32_t sourceWidth = static_cast<uint32_t>(desc.Width);
+
+    float fovWidth = m_renderFrame.views[0].fov.angleRight - m_renderFrame.views[0].fov.angleLeft;
+    if (fovWidth <= 0.0f)
+    {
+        fovWidth = UiLayer::DegreesToRadians(100.0f);
+    }
+    float pixelsPerRadian = static_cast<float>(m_viewConfigs[0].recommendedImageRectWidth) / fovWidth;
+
+    uint32_t width = UiLayer::ComputeLayerWidth(pixelsPerRadian, UiLayer::DegreesToRadians(UiLayer::MENU_ANGLE_DEGREES),
+                                                sourceWidth);
+    uint32_t height = UiLayer::ComputeLayerHeight(width, sourceWidth, desc.Height);
+
+    if (m_uiSwapchain.handle != XR_NULL_HANDLE && m_uiSwapchain.width == static_cast<int32_t>(width) &&
+        m_uiSwapchain.height == static_cast<int32_t>(height))
+    {
+        return true;
+    }
+
+    m_uiRequest.store(PackExtent(width, height));
+    return false;
+}
+
+bool VRSystem::Impl::MatchesUiCapture(const D3D12_RESOURCE_DESC& desc) const
+{
+    return m_uiCapture && desc.Width == m_uiCaptureDesc.Width && desc.Height == m_uiCaptureDesc.Height &&
+           desc.Format == m_uiCaptureDesc.Format;
+}
+
+// The capture texture mirrors the UI target; another one is asked of the pacer
+bool VRSystem::Impl::PrepareUiCapture(ID3D12Resource* uiTarget)
+{
+    D3D12_RESOURCE_DESC desc = uiTarget->GetDesc();
+    if (MatchesUiCapture(desc))
+    {
+        return true;
+    }
+
+    m_uiCaptureFormat.store(static_cast<uint32_t>(desc.Format));
+    m_uiCaptureRequest.store(PackExtent(desc.Width, desc.Height));
+    return false;
+}
+
+// Pacer thread: replace the capture texture. The old one stays alive for a
+// while, as game command lists recorded before the swap may still copy into it
+bool VRSystem::Impl::CreateUiCapture(uint32_t width, uint32_t height, DXGI_FORMAT format)
+{
+    D3D12_HEAP_PROPERTIES defaultHeap = { D3D12_HEAP_TYPE_DEFAULT };
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Width = width;
+    desc.Height = height;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+
+    ComPtr<ID3D12Resource> capture;
+    if (FAILED(m_device->CreateCommittedResource(&defaultHeap, D3D12_HEAP_FLAG_NONE, &desc, UI_CAPTURE_STATE,
+                                                 nullptr, IID_PPV_ARGS(&capture))))
+    {
+        Utils::LogError("D3D12: Failed to create UI capture texture");
+        return false;
+    }
+
+    uint64_t present = m_presentCount.load();
+    ThreadSafe::Lock lock(m_uiCaptureMutex);
+    auto expired = [&](const RetiredCapture& retired) { return present - retired.present >= UI_CAPTURE_RETIRE_PRESENTS; };
+    m_retiredUiCaptures.erase(std::remove_if(m_retiredUiCaptures.begin(), m_retiredUiCaptures.end(), expired),
+                              m_retiredUiCaptures.end());
+    if (m_uiCapture)
+    {
+        m_retiredUiCaptures.push_back({ m_uiCapture, present });
+    }
+    m_uiCapture = capture;
+    m_uiCaptureDesc = desc;
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "D3D12: UI capture %ux%u (format %d)", width, height, static_cast<int>(format));
+    Utils::LogInfo(msg);
+    return true;
+}
+
+// Game recording thread, right after the barrier that ends the UI pass:
+// copy the UI target into the capture, clear it if the user allowed it
+// (VRConfig::IsUILayerClear) and hand it back in the state the game asked
+// for. Returns false (UI left in place) if the layer cannot show it
+bool VRSystem::Impl::RecordUiCapture(ID3D12GraphicsCommandList* commandList, ID3D12Resource* uiTarget,
+                                     D3D12_RESOURCE_STATES uiState)
+{
+    if (!m_uiLayerReady.load() || commandList->GetType() != D3D12_COMMAND_LIST_TYPE_DIRECT)
+    {
+        return false;
+    }
+
+    ThreadSafe::UniqueLock lock(m_uiCaptureMutex, std::try_to_lock);
+    D3D12_RESOURCE_DESC desc = uiTarget->GetDesc();
+    if (!lock.owns_lock() || !MatchesUiCapture(desc))
+    {
+        return false;
+    }
+
+    ResourceStates::Tracker states;
+    states.Track(uiTarget, ResourceStates::ALL_SUBRESOURCES, uiState);
+    states.Track(m_uiCapture.Get(), ResourceStates::ALL_SUBRESOURCES, UI_CAPTURE_STATE);
+
+    states.Transition(uiTarget, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::CopySource);
+    states.Transition(m_uiCapture.Get(), ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::CopyDest);
+    FlushBarriers(commandList, states);
+    commandList->CopyResource(m_uiCapture.Get(), uiTarget);
+
+    if (VRConfig::IsUILayerClear())
+    {
+        // RTV descriptors are read when the clear is recorded: one slot serves every capture
+        D3D12_RENDER_TARGET_VIEW_DESC rtvDesc = {};
+        rtvDesc.Format = FormatUtils::GetSrvFormat(desc.Format);
+        rtvDesc.ViewDimension = D3D12_RTV_DIMENSION_TEXTURE2D;
+        D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_uiRtvHeap->GetCPUDescriptorHandleForHeapStart();
+        m_device->CreateRenderTargetView(uiTarget, &rtvDesc, rtv);
+
+        const FLOAT transparent[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        states.Transition(uiTarget, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::RenderTarget);
+        FlushBarriers(commandList, states);
+        commandList->ClearRenderTargetView(rtv, transparent, 0, nullptr);
+    }
+
+    states.Restore();
+    FlushBarriers(commandList, states);
+    m_uiCaptures.fetch_add(1);
+    return true;
+}
+
+// Pacer thread: replace the UI swapchain; failure disables the UI layer
+bool VRSystem::Impl::CreateUiSwapchain(uint32_t width, uint32_t height)
+{
+    DestroyUiSwapchain();
+
+    // UI is authored in sRGB; an 8-bit sRGB layer keeps it exact whatever the eye format is
+    std::vector<int64_t> formats = EnumerateSwapchainFormats();
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    for (DXGI_FORMAT candidate : { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8A8_UNORM_SRGB })
+    {
+        if (std::find(formats.begin(), formats.end(), static_cast<int64_t>(candidate)) != formats.end())
+        {
+            format = candidate;
+            break;
+        }
+    }
+
+    XrSwapchainUsageFlags usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT |
+                                       XR_SWAPCHAIN_USAGE_MUTABLE_FORMAT_BIT;
+    if (format == DXGI_FORMAT_UNKNOWN || !CreateSwapchain(m_uiSwapchain, format, usageFlags, width, height, 1))
+    {
+        Utils::LogWarn("OpenXR: UI swapchain creation failed - UI layer disabled");
+        DestroyUiSwapchain();
+        m_uiHashPipeline.Reset();
+        return false;
+    }
+
+    if (!CreateUiDescriptors(format))
+    {
+        DestroyUiSwapchain();
+        m_uiHashPipeline.Reset();
+        return false;
+    }
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "OpenXR: UI layer %ux%u", width, height);
+    Utils::LogInfo(msg);
+    return true;
+}
+
+bool VRSystem::Impl::CreateUiDescriptors(DXGI_FORMAT format)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = 2 + static_cast<UINT>(m_uiSwapchain.images.size());
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+
+    if (FAILED(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_uiHeap))))
+    {
+        Utils::LogError("D3D12: Failed to create UI descriptor heap");
+        return false;
+    }
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC counterDesc = {};
+    counterDesc.Format = DXGI_FORMAT_R32_UINT;
+    counterDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
+    counterDesc.Texture2DArray.ArraySize = 1;
+    m_device->CreateUnorderedAccessView(m_uiHashCounter.Get(), nullptr, &counterDesc, GetDescriptor(m_uiHeap.Get(), 1));
+
+    for (uint32_t image = 0; image < m_uiSwapchain.images.size(); image++)
+    {
+        D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+        uavDesc.Format = FormatUtils::GetUavFormat(format);
+        uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2DARRAY;
+        uavDesc.Texture2DArray.ArraySize = 1;
+        m_device->CreateUnorderedAccessView(m_uiSwapchain.images[image].texture, nullptr, &uavDesc,
+                                            GetDescriptor(m_uiHeap.Get(), 2 + image));
+    }
+
+    return true;
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordUiHashList(ID3D12Resource* source)
+{
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_uiAllocator.Get(), m_uiHashPipeline.Get(), IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create UI hash command list");
+        return nullptr;
+    }
+
+    D3D12_RESOURCE_DESC desc = source->GetDesc();
+    UiLayer::HashParams params;
+    params.width = static_cast<uint32_t>(desc.Width);
+    params.height = desc.Height;
+
+    ResourceStates::Tracker states;
+    states.Track(source, ResourceStates::ALL_SUBRESOURCES, UI_CAPTURE_STATE);
+    states.Track(m_uiHashCounter.Get(), ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::UnorderedAccess);
+
+    states.Transition(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::NonPixelShaderResource);
+    FlushBarriers(commandList.Get(), states);
+
+    ID3D12DescriptorHeap* heaps[] = { m_uiHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetComputeRootSignature(m_resampleRootSignature.Get());
+    commandList->SetComputeRoot32BitConstants(0, UiLayer::ROOT_CONSTANT_COUNT, &params, 0);
+    commandList->SetComputeRootDescriptorTable(1, GetGPUDescriptor(m_uiHeap.Get(), 0));
+    commandList->SetComputeRootDescriptorTable(2, GetGPUDescriptor(m_uiHeap.Get(), 1));
+    commandList->Dispatch(UiLayer::GetDispatchCount(params.width), UiLayer::GetDispatchCount(params.height), 1);
+
+    // The capture goes back to its resting state while the counter is read back
+    states.BeginRestore(source, ResourceStates::ALL_SUBRESOURCES);
+    states.Transition(m_uiHashCounter.Get(), ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::CopySource);
+    FlushBarriers(commandList.Get(), states);
+
+    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+    srcLoc.pResource = m_uiHashCounter.Get();
+    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    srcLoc.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+    dstLoc.pResource = m_uiHashReadback.Get();
+    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    dstLoc.PlacedFootprint.Footprint = { DXGI_FORMAT_R32_UINT, 2, 1, 1, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT };
+
+    commandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+
+    states.Restore();
+    FlushBarriers(commandList.Get(), states);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close UI hash command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+ComPtr<ID3D12GraphicsCommandList> VRSystem::Impl::RecordUiList(ID3D12Resource* source, uint32_t imageIndex)
+{
+    ID3D12Resource* dest = m_uiSwapchain.images[imageIndex].texture;
+
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    if (FAILED(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+        m_uiAllocator.Get(), m_resamplePipeline.Get(), IID_PPV_ARGS(&commandList))))
+    {
+        Utils::LogError("D3D12: Failed to create UI command list");
+        return nullptr;
+    }
+
+    D3D12_RESOURCE_DESC srcDesc = source->GetDesc();
+    EyeResample::Params params = EyeResample::ComputeParams(
+        static_cast<uint32_t>(srcDesc.Width), srcDesc.Height,
+        static_cast<uint32_t>(m_uiSwapchain.width), static_cast<uint32_t>(m_uiSwapchain.height));
+
+    ResourceStates::Tracker states;
+    states.Track(source, ResourceStates::ALL_SUBRESOURCES, UI_CAPTURE_STATE);
+    states.Track(dest, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::RenderTarget);
+
+    states.Transition(source, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::NonPixelShaderResource);
+    states.Transition(dest, ResourceStates::ALL_SUBRESOURCES, ResourceStates::State::UnorderedAccess);
+    FlushBarriers(commandList.Get(), states);
+
+    ID3D12DescriptorHeap* heaps[] = { m_uiHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetComputeRootSignature(m_resampleRootSignature.Get());
+    commandList->SetComputeRoot32BitConstants(0, EyeResample::ROOT_CONSTANT_COUNT, &params, 0);
+    commandList->SetComputeRootDescriptorTable(1, GetGPUDescriptor(m_uiHeap.Get(), 0));
+    commandList->SetComputeRootDescriptorTable(2, GetGPUDescriptor(m_uiHeap.Get(), 2 + imageIndex));
+    commandList->Dispatch(EyeResample::GetDispatchCount(params.dstWidth),
+                          EyeResample::GetDispatchCount(params.dstHeight), 1);
+
+    states.Restore();
+    FlushBarriers(commandList.Get(), states);
+
+    if (FAILED(commandList->Close()))
+    {
+        Utils::LogError("D3D12: Failed to close UI command list");
+        return nullptr;
+    }
+
+    return commandList;
+}
+
+// Drop the UI lists without waiting for the GPU; the eye lists are untouched
+void VRSystem::Impl::ResetUiLists()
+{
+    m_uiSource = nullptr;
+    m_uiHashList.Reset();
+    m_uiLists.clear();
+    if (m_uiAllocator)
+    {
+        ReplaceAllocator(m_uiAllocator, D3D12_COMMAND_LIST_TYPE_DIRECT);
+    }
+}
+
+// Record the hash list and one resample list per UI image for a capture
+bool VRSystem::Impl::PrepareUiLists(ID3D12Resource* source)
+{
+    if (m_uiSource == source && m_uiHashList)
+    {
+        return true;
+    }
+
+    if (m_uiSource)
+    {
+        ResetUiLists();
+    }
+    if (!m_uiAllocator)
+    {
+        return false;
+    }
+    m_uiSource = source;
+
+    // Sampled through a non-sRGB view: the bytes go into the sRGB layer unchanged
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = FormatUtils::GetUavFormat(FormatUtils::GetSrvFormat(source->GetDesc().Format));
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+    m_device->CreateShaderResourceView(source, &srvDesc, GetDescriptor(m_uiHeap.Get(), 0));
+
+    m_uiHashList = RecordUiHashList(source);
+    for (uint32_t image = 0; image < m_uiSwapchain.images.size(); image++)
+    {
+        m_uiLists.push_back(RecordUiList(source, image));
+    }
+
+    // Force a copy: the shown image belongs to another source
+    m_uiImageValid = false;
+    return m_uiHashList.Get() != nullptr;
+}
+
+// Reads the previous hash pass and queues the next one; returns true if the
+// content differs from the shown image. Changes show up one check late, and
+// a check is skipped while the previous pass is still on the GPU
+bool VRSystem::Impl::HasUiChanged()
+{
+    if (m_fence->GetCompletedValue() < m_uiHashFenceValue)
+    {
+        return false;
+    }
+
+    uint32_t* counter = nullptr;
+    D3D12_RANGE readRange = { 0, 2 * sizeof(uint32_t) };
+    if (FAILED(m_uiHashReadback->Map(0, &readRange, reinterpret_cast<void**>(&counter))))
+    {
+        return true;
+    }
+    uint32_t after[2] = { counter[0], counter[1] };
+    D3D12_RANGE writeRange = { 0, 0 };
+    m_uiHashReadback->Unmap(0, &writeRange);
+
+    uint32_t hash[2];
+    UiLayer::HashDelta(m_uiHashCounterValue, after, hash);
+    m_uiHashCounterValue[0] = after[0];
+    m_uiHashCounterValue[1] = after[1];
+
+    bool changed = !m_uiImageValid || hash[0] != m_uiShownHash[0] || hash[1] != m_uiShownHash[1];
+    m_uiShownHash[0] = hash[0];
+    m_uiShownHash[1] = hash[1];
+
+    ExecuteCopy(m_uiHashList.Get());
+    m_uiHashFenceValue = SignalFence();
+    return changed;
+}
+
+// Present queue -> m_commandQueue: this frame's capture, queued on the
+// present queue before the Present, lands before the UI passes read it.
+// Assumes the game's UI pass runs on the queue it presents on
+bool VRSystem::Impl::WaitForUiCapture(ID3D12CommandQueue* presentQueue)
+{
+    UINT64 value = m_uiCaptureFenceValue + 1;
+    if (FAILED(presentQueue->Signal(m_uiCaptureFence.Get(), value)))
+    {
+        return false;
+    }
+    m_uiCaptureFenceValue = value;
+    return SUCCEEDED(m_commandQueue->Wait(m_uiCaptureFence.Get(), value));
+}
+
+// m_commandQueue -> present queue: the game's next capture waits for the
+// UI passes queued since WaitForUiCapture
+void VRSystem::Impl::ReleaseUiCapture(ID3D12CommandQueue* presentQueue)
+{
+    UINT64 passes = SignalFence();
+    if (passes != 0)
+    {
+        presentQueue->Wait(m_fence.Get(), passes);
+    }
+}
+
+// Rate-limited UI refresh (render thread)
+// uiTarget sizes the capture and the layer; the content comes from the capture
+void VRSystem::Impl::UpdateUi(ID3D12Resource* uiTarget)
+{
+    m_uiVisible = false;
+
+    // Without the present queue the capture cannot be ordered with its reads
+    ComPtr<ID3D12CommandQueue> presentQueue = GetPresentQueue();
+    if (!uiTarget || !m_uiHashPipeline || !presentQueue)
+    {
+        m_uiLayerReady.store(false);
+        return;
+    }
+
+    // Both are asked for at once; the UI stays in the game's frame until they exist
+    bool captureReady = PrepareUiCapture(uiTarget);
+    bool swapchainReady = PrepareUiSwapchain(uiTarget);
+    m_uiLayerReady.store(captureReady && swapchainReady);
+
+    // Only a frame whose UI was taken out shows the layer; otherwise the UI
+    // (if any) is still in the back buffer
+    uint64_t captures = m_uiCaptures.load();
+    bool captured = captures != m_uiCapturesSeen;
+    m_uiCapturesSeen = captures;
+    if (!captureReady || !swapchainReady || !captured)
+    {
+        return;
+    }
+    m_uiVisible = true;
+
+    ID3D12Resource* source = m_uiCapture.Get();
+    auto now = std::chrono::steady_clock::now();
+    float rate = std::max(VRConfig::GetUIUpdateRate(), 1.0f);
+    if (m_uiImageValid && m_uiSource == source &&
+        std::chrono::duration<float>(now - m_uiLastCheck).count() < 1.0f / rate)
+    {
+        return;
+    }
+    m_uiLastCheck = now;
+
+    // A change is only read once there is an image to write it into
+    if (!PrepareUiLists(source) || !IsImageReady(ImageFamily::Ui, 0) || !WaitForUiCapture(presentQueue.Get()))
+    {
+        m_uiVisible = m_uiImageValid;
+        return;
+    }
+
+    if (!HasUiChanged())
+    {
+        m_uiVisible = m_uiImageValid;
+    }
+    else if (TakeImage(ImageFamily::Ui, 0))
+    {
+        uint32_t imageIndex = static_cast<uint32_t>(m_uiSwapchain.acquiredImage);
+        ID3D12GraphicsCommandList* uiList = imageIndex < m_uiLists.size() ? m_uiLists[imageIndex].Get() : nullptr;
+        ExecuteCopy(uiList);
+        QueueRelease(ImageFamily::Ui, 0);
+        m_uiImageValid = uiList != nullptr;
+    }
+    ReleaseUiCapture(presentQueue.Get());
+}
+
+// HUD: head-locked quad. Menus: world-locked cylinder (or quad) placed
+// where the user faced when the menu opened. Render thread, from BuildLayers
+const XrCompositionLayerBaseHeader* VRSystem::Impl::BuildUiLayer()
+{
+    bool menu = VRConfig::IsMenuMode();
+    if (!menu)
+    {
+        m_menuAnchored = false;
+    }
+
+    if (!VRConfig::IsUILayer() || !m_uiVisible || !m_uiImageValid)
+    {
+        return nullptr;
+    }
+
+    float distance = std::max(VRConfig::GetUIDistance(), 0.1f);
+    float aspect = static_cast<float>(m_uiSwapchain.width) / static_cast<float>(m_uiSwapchain.height);
+
+    XrSwapchainSubImage subImage = {};
+    subImage.swapchain = m_uiSwapchain.handle;
+    subImage.imageRect.extent = { m_uiSwapchain.width, m_uiSwapchain.height };
+
+    if (!menu && m_viewSpace != XR_NULL_HANDLE)
+    {
+        float width = UiLayer::QuadWidth(distance, UiLayer::DegreesToRadians(UiLayer::HUD_ANGLE_DEGREES));
+        m_uiQuad = { XR_TYPE_COMPOSITION_LAYER_QUAD };
+        m_uiQuad.layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+        m_uiQuad.space = m_viewSpace;
+        m_uiQuad.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        m_uiQuad.subImage = subImage;
+        m_uiQuad.pose.orientation.w = 1.0f;
+        m_uiQuad.pose.position.z = -distance;
+        m_uiQuad.size = { width, width / aspect };
+        return reinterpret_cast<const XrCompositionLayerBaseHeader*>(&m_uiQuad);
+    }
+
+    if (!m_menuAnchored)
+    {
+        const XrPosef& left = m_renderFrame.views[0].pose;
+        const XrPosef& right = m_renderFrame.views[1].pose;
+        if (left.orientation.w == 0.0f && left.orientation.x == 0.0f &&
+            left.orientation.y == 0.0f && left.orientation.z == 0.0f)
+        {
+            return nullptr;
+        }
+
+        float yaw[4];
+        UiLayer::YawOnly(left.orientation.x, left.orientation.y, left.orientation.z, left.orientation.w, yaw);
+        m_menuAnchor.orientation = { yaw[0], yaw[1], yaw[2], yaw[3] };
+        m_menuAnchor.position = { (left.position.x + right.position.x) * 0.5f,
+                                  (left.position.y + right.position.y) * 0.5f,
+                                  (left.position.z + right.position.z) * 0.5f };
+        m_menuAnchored = true;
+    }
+
+    float angle = UiLayer::DegreesToRadians(UiLayer::MENU_ANGLE_DEGREES);
+    if (m_cylinderSupported)
+    {
+        // The cylinder is centred on the head, so the radius is the viewing distance
+        m_uiCylinder = { XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR };
+        m_uiCylinder.layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+        m_uiCylinder.space = m_appSpace;
+        m_uiCylinder.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        m_uiCylinder.subImage = subImage;
+        m_uiCylinder.pose = m_menuAnchor;
+        m_uiCylinder.radius = distance;
+        m_uiCylinder.centralAngle = angle;
+        m_uiCylinder.aspectRatio = aspect;
+        return reinterpret_cast<const XrCompositionLayerBaseHeader*>(&m_uiCylinder);
+    }
+
+    // Quad fallback: pushed out along the anchor's heading
+    float sinYaw = 2.0f * m_menuAnchor.orientation.y * m_menuAnchor.orientation.w;
+    float cosYaw = 1.0f - 2.0f * m_menuAnchor.orientation.y * m_menuAnchor.orientation.y;
+    float width = UiLayer::QuadWidth(distance, angle);
+
+    m_uiQuad = { XR_TYPE_COMPOSITION_LAYER_QUAD };
+    m_uiQuad.layerFlags = XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT;
+    m_uiQuad.space = m_appSpace;
+    m_uiQuad.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+    m_uiQuad.subImage = subImage;
+    m_uiQuad.pose.orientation = m_menuAnchor.orientation;
+    m_uiQuad.pose.position = { m_menuAnchor.position.x - sinYaw * distance,
+                               m_menuAnchor.position.y,
+                               m_menuAnchor.position.z - cosYaw * distance };
+    m_uiQuad.size = { width, width / aspect };
+    return reinterpret_cast<const XrCompositionLayerBaseHeader*>(&m_uiQuad);
+}
@@ -0,0 +1,128 @@
+// Eye resample CPU reference (crop, bilinear filter, sRGB encode) against
+// values worked out by hand
+
+#include "EyeResample.hpp"
+#include "TestUtils.hpp"
+
+#include <initializer_list>
+#include <vector>
+
+using namespace EyeResample;
+
+namespace
+{
+    constexpr double TOLERANCE = 1e-5;
+
+    // RGBA texels with the same value in R, G and B and alpha 1
+    std::vector<float> MakeGray(std::initializer_list<float> values)
+    {
+        std::vector<float> texels;
+        for (float value : values)
+        {
+            texels.insert(texels.end(), { value, value, value, 1.0f });
+        }
+        return texels;
+    }
+
+    void TestCrop()
+    {
+        // Same aspect: nothing cropped
+        Params same = ComputeParams(1920, 1080, 960, 540);
+        CHECK(same.srcOffsetU == 0.0f && same.srcOffsetV == 0.0f);
+        CHECK(same.srcScaleU == 1.0f && same.srcScaleV == 1.0f);
+
+        // 2:1 into 1:1 keeps the middle half of the width
+        Params wide = ComputeParams(200, 100, 100, 100);
+        CHECK_NEAR(wide.srcScaleU, 0.5, TOLERANCE);
+        CHECK_NEAR(wide.srcOffsetU, 0.25, TOLERANCE);
+        CHECK(wide.srcScaleV == 1.0f && wide.srcOffsetV == 0.0f);
+
+        // 1:1 into 2:1 keeps the middle half of the height
+        Params tall = ComputeParams(100, 100, 200, 100, Flags::EncodeSrgb);
+        CHECK_NEAR(tall.srcScaleV, 0.5, TOLERANCE);
+        CHECK_NEAR(tall.srcOffsetV, 0.25, TOLERANCE);
+        CHECK(tall.flags == Flags::EncodeSrgb);
+
+        // Degenerate sizes leave the identity mapping
+        Params empty = ComputeParams(0, 100, 100, 100);
+        CHECK(empty.srcScaleU == 1.0f && empty.srcOffsetU == 0.0f);
+
+        CHECK(GetDispatchCount(16) == 2);
+        CHECK(GetDispatchCount(17) == 3);
+        CHECK(PackDispatchOffset(3, 5) == (3u | (5u << 16)));
+    }
+
+    void TestIdentity()
+    {
+        // Same size: every output texel centre lands on a source texel centre
+        std::vector<float> src = MakeGray({ 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f });
+        std::vector<float> dst(src.size());
+        Reference(src.data(), 3, 2, ComputeParams(3, 2, 3, 2), dst.data());
+        for (size_t i = 0; i < src.size(); i++)
+        {
+            CHECK_NEAR(dst[i], src[i], TOLERANCE);
+        }
+    }
+
+    void TestBilinear()
+    {
+        // 2x2 -> 1x1: the single output centre is equidistant from all four texels
+        std::vector<float> quad = MakeGray({ 0.0f, 1.0f, 0.5f, 0.25f });
+        float out[4];
+        ReferencePixel(quad.data(), 2, 2, ComputeParams(2, 2, 1, 1), 0, 0, out);
+        CHECK_NEAR(out[0], (0.0 + 1.0 + 0.5 + 0.25) / 4.0, TOLERANCE);
+        CHECK_NEAR(out[3], 1.0, TOLERANCE);
+
+        // 2x1 -> 4x2 (same aspect), first row: centres at texel x = -0.25, 0.25,
+        // 0.75, 1.25; the outer two clamp to the edge texels
+        std::vector<float> ramp = MakeGray({ 0.0f, 1.0f });
+        std::vector<float> dst(4 * 2 * 4);
+        Reference(ramp.data(), 2, 1, ComputeParams(2, 1, 4, 2), dst.data());
+        const double expected[4] = { 0.0, 0.25, 0.75, 1.0 };
+        for (int x = 0; x < 4; x++)
+        {
+            CHECK_NEAR(dst[x * 4], expected[x], TOLERANCE);
+        }
+    }
+
+    void TestCroppedSample()
+    {
+        // 4x1 -> 2x1 crops the middle half (u 0.25..0.75); the output centres at
+        // u = 0.375 and 0.625 fall exactly on source texels 1 and 2
+        std::vector<float> src = MakeGray({ 0.0f, 0.25f, 0.5f, 0.75f });
+        std::vector<float> dst(2 * 4);
+        Params params = ComputeParams(4, 1, 2, 1);
+        CHECK_NEAR(params.srcOffsetU, 0.25, TOLERANCE);
+        Reference(src.data(), 4, 1, params, dst.data());
+        CHECK_NEAR(dst[0], 0.25, TOLERANCE);
+        CHECK_NEAR(dst[4], 0.5, TOLERANCE);
+    }
+
+    void TestSrgbEncode()
+    {
+        CHECK_NEAR(LinearToSrgb(0.0f), 0.0, TOLERANCE);
+        CHECK_NEAR(LinearToSrgb(1.0f), 1.0, TOLERANCE);
+        CHECK_NEAR(LinearToSrgb(0.002f), 0.02584, TOLERANCE);     // Linear segment, 12.92x
+        CHECK_NEAR(LinearToSrgb(0.5f), 0.735357, TOLERANCE);
+        CHECK_NEAR(LinearToSrgb(4.0f), 1.0, TOLERANCE);           // scRGB above 1 clamps
+
+        // Colour is encoded, alpha is not
+        const float linear[4] = { 0.5f, 0.25f, 0.0f, 0.5f };
+        float out[4];
+        ReferencePixel(linear, 1, 1, ComputeParams(1, 1, 1, 1, Flags::EncodeSrgb), 0, 0, out);
+        CHECK_NEAR(out[0], 0.735357, TOLERANCE);
+        CHECK_NEAR(out[1], 0.537099, TOLERANCE);
+        CHECK_NEAR(out[2], 0.0, TOLERANCE);
+        CHECK_NEAR(out[3], 0.5, TOLERANCE);
+    }
+}
+
+int main()
+{
+    TestCrop();
+    TestIdentity();
+    TestBilinear();
+    TestCroppedSample();
+    TestSrgbEncode();
+    return TestUtils::Result("EyeResampleTest");
+}
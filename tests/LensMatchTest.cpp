@@ -0,0 +1,152 @@
+// Lens-matched eye images: the outer band's scale, the inset FOV and its place
+// in the eye image for symmetric and asymmetric views, and the inset's size and
+// resample parameters
+
+#include "LensMatch.hpp"
+#include "TestUtils.hpp"
+
+#include <cmath>
+
+using namespace LensMatch;
+
+namespace
+{
+    constexpr double TOLERANCE = 1e-4;
+
+    // tan(30 degrees), the default inset
+    const float T30 = std::tan(DegreesToRadians(DEFAULT_INSET_HALF_ANGLE_DEGREES));
+
+    FovTangents Symmetric()
+    {
+        return FovTangents();   // 45 degrees to every side
+    }
+
+    // Wider towards the nose and down, as headset eye FOVs are
+    FovTangents Asymmetric()
+    {
+        FovTangents fov;
+        fov.left = -1.0f;
+        fov.right = 0.8f;
+        fov.up = 0.9f;
+        fov.down = -1.2f;
+        return fov;
+    }
+
+    void TestPeripheryScale()
+    {
+        CHECK_NEAR(PeripheryScale(DegreesToRadians(30.0f)), 0.75, TOLERANCE);
+        CHECK_NEAR(PeripheryScale(DegreesToRadians(30.0f), 0.7f), 0.525, TOLERANCE);
+        CHECK_NEAR(PeripheryScale(0.0f), 1.0, TOLERANCE);
+
+        // Clamped to [0.1, 1]
+        CHECK_NEAR(PeripheryScale(DegreesToRadians(80.0f)), 0.1, TOLERANCE);
+        CHECK_NEAR(PeripheryScale(DegreesToRadians(10.0f), 2.0f), 1.0, TOLERANCE);
+    }
+
+    void TestSymmetric()
+    {
+        FovTangents fov = Symmetric();
+        FovTangents inset = ComputeInset(fov, DegreesToRadians(30.0f));
+        CHECK_NEAR(inset.left, -T30, TOLERANCE);
+        CHECK_NEAR(inset.right, T30, TOLERANCE);
+        CHECK_NEAR(inset.up, T30, TOLERANCE);
+        CHECK_NEAR(inset.down, -T30, TOLERANCE);
+
+        // Centred in the eye image
+        UvRect uv = InsetUv(fov, inset);
+        CHECK_NEAR(uv.u0, (1.0 - T30) / 2.0, TOLERANCE);
+        CHECK_NEAR(uv.u1, (1.0 + T30) / 2.0, TOLERANCE);
+        CHECK_NEAR(uv.v0, (1.0 - T30) / 2.0, TOLERANCE);
+        CHECK_NEAR(uv.v1, (1.0 + T30) / 2.0, TOLERANCE);
+        CHECK_NEAR(PixelFraction(0.75f, uv), 0.75 * 0.75 + T30 * T30, TOLERANCE);
+
+        // An inset wider than the view is the view itself
+        inset = ComputeInset(fov, DegreesToRadians(50.0f));
+        uv = InsetUv(fov, inset);
+        CHECK_NEAR(uv.u0, 0.0, TOLERANCE);
+        CHECK_NEAR(uv.u1, 1.0, TOLERANCE);
+        CHECK_NEAR(uv.v0, 0.0, TOLERANCE);
+        CHECK_NEAR(uv.v1, 1.0, TOLERANCE);
+    }
+
+    void TestAsymmetric()
+    {
+        // The inset stays on the optical axis, so it sits off centre in the image
+        FovTangents fov = Asymmetric();
+        FovTangents inset = ComputeInset(fov, DegreesToRadians(30.0f));
+        CHECK_NEAR(inset.left, -T30, TOLERANCE);
+        CHECK_NEAR(inset.right, T30, TOLERANCE);
+        CHECK_NEAR(inset.up, T30, TOLERANCE);
+        CHECK_NEAR(inset.down, -T30, TOLERANCE);
+
+        UvRect uv = InsetUv(fov, inset);
+        CHECK_NEAR(uv.u0, (1.0 - T30) / 1.8, TOLERANCE);
+        CHECK_NEAR(uv.u1, (1.0 + T30) / 1.8, TOLERANCE);
+        CHECK_NEAR(uv.v0, (0.9 - T30) / 2.1, TOLERANCE);
+        CHECK_NEAR(uv.v1, (0.9 + T30) / 2.1, TOLERANCE);
+
+        // A side narrower than the inset angle limits that side only
+        fov.right = 0.4f;
+        inset = ComputeInset(fov, DegreesToRadians(30.0f));
+        CHECK_NEAR(inset.right, 0.4, TOLERANCE);
+        CHECK_NEAR(inset.left, -T30, TOLERANCE);
+        uv = InsetUv(fov, inset);
+        CHECK_NEAR(uv.u0, (1.0 - T30) / 1.4, TOLERANCE);
+        CHECK_NEAR(uv.u1, 1.0, TOLERANCE);
+    }
+
+    void TestInsetSize()
+    {
+        UvRect uv = InsetUv(Symmetric(), ComputeInset(Symmetric(), DegreesToRadians(30.0f)));
+
+        // Full density over the inset's share of the image, kept even
+        uint32_t width = 0, height = 0;
+        InsetSize(2000, 1800, uv, width, height);
+        CHECK(width == 1154);
+        CHECK(height == 1038);
+
+        // Never below 2 x 2
+        UvRect tiny;
+        tiny.u1 = 0.0001f;
+        tiny.v1 = 0.0001f;
+        InsetSize(2000, 1800, tiny, width, height);
+        CHECK(width == 2);
+        CHECK(height == 2);
+    }
+
+    void TestInsetParams()
+    {
+        EyeResample::Params eye;
+        eye.srcOffsetU = 0.1f;
+        eye.srcOffsetV = 0.2f;
+        eye.srcScaleU = 0.8f;
+        eye.srcScaleV = 0.6f;
+        eye.dstWidth = 2000;
+        eye.dstHeight = 1800;
+        eye.flags = 3;
+        eye.dispatchOffset = 5;
+
+        UvRect uv = InsetUv(Asymmetric(), ComputeInset(Asymmetric(), DegreesToRadians(30.0f)));
+        EyeResample::Params params = InsetParams(eye, uv, 1000, 900);
+
+        // The inset's part of the eye's source crop
+        CHECK_NEAR(params.srcOffsetU, 0.1 + uv.u0 * 0.8, TOLERANCE);
+        CHECK_NEAR(params.srcOffsetV, 0.2 + uv.v0 * 0.6, TOLERANCE);
+        CHECK_NEAR(params.srcScaleU, (uv.u1 - uv.u0) * 0.8, TOLERANCE);
+        CHECK_NEAR(params.srcScaleV, (uv.v1 - uv.v0) * 0.6, TOLERANCE);
+        CHECK(params.dstWidth == 1000);
+        CHECK(params.dstHeight == 900);
+        CHECK(params.flags == 3);
+        CHECK(params.dispatchOffset == 0);
+    }
+}
+
+int main()
+{
+    TestPeripheryScale();
+    TestSymmetric();
+    TestAsymmetric();
+    TestInsetSize();
+    TestInsetParams();
+    return TestUtils::Result("LensMatchTest");
+}
@@ -0,0 +1,129 @@
+// Motion vector conversion (CPU reference of the space warp kernel) against
+// motion worked out by hand from the UV -> NDC mapping:
+//   NDC.x = 2u - 1, NDC.y = 1 - 2v, so a UV delta (du, dv) is NDC (2du, -2dv)
+
+#include "MotionVectors.hpp"
+#include "TestUtils.hpp"
+
+using namespace MotionVectors;
+
+namespace
+{
+    constexpr double TOLERANCE = 1e-6;
+
+    void TestParams()
+    {
+        Params toPrevious = ComputeParams(Convention::ToPrevious, 64, 32);
+        CHECK(toPrevious.scaleX == -2.0f);
+        CHECK(toPrevious.scaleY == 2.0f);
+        CHECK(toPrevious.maxLength == DEFAULT_MAX_LENGTH);
+        CHECK(toPrevious.dstWidth == 64 && toPrevious.dstHeight == 32);
+
+        Params toCurrent = ComputeParams(Convention::ToCurrent, 64, 32);
+        CHECK(toCurrent.scaleX == 2.0f);
+        CHECK(toCurrent.scaleY == -2.0f);
+
+        CHECK(GetDispatchCount(1) == 1);
+        CHECK(GetDispatchCount(8) == 1);
+        CHECK(GetDispatchCount(9) == 2);
+    }
+
+    void TestConversion()
+    {
+        // One texel: the point was at UV (0.51, 0.48) last frame and is at
+        // (0.50, 0.50) now, i.e. it moved left and down on screen
+        //   ToPrevious stores previous - current = (+0.01, -0.02)
+        //   NDC previous = (0.02, 0.04), NDC current = (0.00, 0.00)
+        //   current - previous = (-0.02, -0.04)
+        const float toPrevious[2] = { 0.01f, -0.02f };
+        float out[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        ReferencePixel(toPrevious, 1, 1, ComputeParams(Convention::ToPrevious, 1, 1), 0, 0, out);
+        CHECK_NEAR(out[0], -0.02, TOLERANCE);
+        CHECK_NEAR(out[1], -0.04, TOLERANCE);
+        CHECK(out[2] == 0.0f && out[3] == 0.0f);
+
+        // The same motion stored the other way round: current - previous = (-0.01, +0.02)
+        const float toCurrent[2] = { -0.01f, 0.02f };
+        ReferencePixel(toCurrent, 1, 1, ComputeParams(Convention::ToCurrent, 1, 1), 0, 0, out);
+        CHECK_NEAR(out[0], -0.02, TOLERANCE);
+        CHECK_NEAR(out[1], -0.04, TOLERANCE);
+
+        // No motion stays no motion
+        const float still[2] = { 0.0f, 0.0f };
+        ReferencePixel(still, 1, 1, ComputeParams(Convention::ToPrevious, 1, 1), 0, 0, out);
+        CHECK(out[0] == 0.0f && out[1] == 0.0f);
+    }
+
+    void TestCutRejection()
+    {
+        // A UV delta of 0.3 is 0.6 in NDC: kept. 0.6 is 1.2 in NDC, longer than
+        // the default limit of 1: a camera cut, dropped
+        const float kept[2] = { 0.3f, 0.0f };
+        const float cut[2] = { 0.6f, 0.0f };
+        const float diagonal[2] = { 0.3f, 0.35f };   // NDC (0.6, -0.7), length 0.92: kept
+        float out[4];
+
+        Params params = ComputeParams(Convention::ToCurrent, 1, 1);
+        ReferencePixel(kept, 1, 1, params, 0, 0, out);
+        CHECK_NEAR(out[0], 0.6, TOLERANCE);
+
+        ReferencePixel(cut, 1, 1, params, 0, 0, out);
+        CHECK(out[0] == 0.0f && out[1] == 0.0f);
+
+        ReferencePixel(diagonal, 1, 1, params, 0, 0, out);
+        CHECK_NEAR(out[0], 0.6, TOLERANCE);
+        CHECK_NEAR(out[1], -0.7, TOLERANCE);
+
+        // maxLength 0 disables the limit
+        params.maxLength = 0.0f;
+        ReferencePixel(cut, 1, 1, params, 0, 0, out);
+        CHECK_NEAR(out[0], 1.2, TOLERANCE);
+    }
+
+    void TestSourceTexel()
+    {
+        // Downscale 8 -> 4: centres 0.5, 1.5, 2.5, 3.5 map to 1, 3, 5, 7
+        CHECK(SourceTexel(0, 4, 8) == 1);
+        CHECK(SourceTexel(1, 4, 8) == 3);
+        CHECK(SourceTexel(3, 4, 8) == 7);
+
+        // Upscale 4 -> 8: 7.5 * 4 / 8 = 3.75 -> 3
+        CHECK(SourceTexel(0, 8, 4) == 0);
+        CHECK(SourceTexel(7, 8, 4) == 3);
+
+        // Same size is the identity
+        for (uint32_t x = 0; x < 5; x++)
+        {
+            CHECK(SourceTexel(x, 5, 5) == x);
+        }
+    }
+
+    // Motion is point-sampled: an object edge in a 2x1 source must not blend
+    // into invented in-between motion when the destination is 4x1
+    void TestNoFiltering()
+    {
+        const float src[4] = {
+            0.1f, 0.0f,     // Background panning right (ToCurrent)
+            -0.1f, 0.0f,    // Object moving left
+        };
+        float dst[4 * 4];
+        Reference(src, 2, 1, ComputeParams(Convention::ToCurrent, 4, 1), dst);
+
+        const double expected[4] = { 0.2, 0.2, -0.2, -0.2 };
+        for (int x = 0; x < 4; x++)
+        {
+            CHECK_NEAR(dst[x * 4 + 0], expected[x], TOLERANCE);
+            CHECK(dst[x * 4 + 1] == 0.0f);
+        }
+    }
+}
+
+int main()
+{
+    TestParams();
+    TestConversion();
+    TestCutRejection();
+    TestSourceTexel();
+    TestNoFiltering();
+    return TestUtils::Result("MotionVectorsTest");
+}
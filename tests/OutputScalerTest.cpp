@@ -0,0 +1,200 @@
+// Dynamic output scale: quantized steps down and up around the budget, the
+// dead-band between the thresholds, the cooldown after a change and the upper
+// bounds (recommended size, source resolution, runtime ceiling)
+
+#include "OutputScaler.hpp"
+#include "TestUtils.hpp"
+
+#include <initializer_list>
+
+namespace
+{
+    constexpr double TOLERANCE = 1e-5;
+    constexpr double BUDGET = 0.001;
+
+    // No smoothing and no cooldown: every sample acts on its own
+    OutputScaler::Settings Immediate()
+    {
+        OutputScaler::Settings settings;
+        settings.smoothing = 1.0f;
+        settings.cooldownFrames = 0;
+        return settings;
+    }
+
+    void TestConfigure()
+    {
+        OutputScaler scaler;
+        OutputScaler::Settings settings = Immediate();
+        settings.maxScale = 1.3f;
+        scaler.Configure(settings);
+
+        // Never above the recommended size, and it starts there
+        CHECK_NEAR(scaler.GetMaxScale(), 1.0, TOLERANCE);
+        CHECK_NEAR(scaler.GetScale(), 1.0, TOLERANCE);
+
+        // A maximum below the minimum is raised to it
+        settings.minScale = 0.8f;
+        settings.maxScale = 0.5f;
+        scaler.Configure(settings);
+        CHECK_NEAR(scaler.GetMaxScale(), 0.8, TOLERANCE);
+        CHECK_NEAR(scaler.GetScale(), 0.8, TOLERANCE);
+    }
+
+    void TestStepDown()
+    {
+        OutputScaler scaler;
+        scaler.Configure(Immediate());
+
+        // Twice the budget: pixel cost goes with the square of the scale, so the
+        // target is 1 * sqrt(0.92 / 2) = 0.678, quantized to 0.70
+        CHECK(scaler.Update(2.0 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetScale(), 0.70, TOLERANCE);
+
+        // Just over the threshold still drops at least one step
+        scaler.Configure(Immediate());
+        CHECK(scaler.Update(0.93 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetScale(), 0.95, TOLERANCE);
+
+        // Never below the minimum
+        scaler.Configure(Immediate());
+        CHECK(scaler.Update(100.0 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetScale(), 0.6, TOLERANCE);
+        CHECK(!scaler.Update(100.0 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetScale(), 0.6, TOLERANCE);
+    }
+
+    void TestStepUp()
+    {
+        OutputScaler scaler;
+        scaler.Configure(Immediate());
+        scaler.Reset(0.6f);
+
+        // Well under budget: one step at a time, up to the maximum
+        CHECK(scaler.Update(0.1 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetScale(), 0.65, TOLERANCE);
+        CHECK(scaler.Update(0.1 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetScale(), 0.70, TOLERANCE);
+
+        for (int i = 0; i < 20; i++)
+        {
+            scaler.Update(0.1 * BUDGET, BUDGET);
+        }
+        CHECK_NEAR(scaler.GetScale(), 1.0, TOLERANCE);
+        CHECK(!scaler.Update(0.1 * BUDGET, BUDGET));
+    }
+
+    void TestDeadBand()
+    {
+        OutputScaler scaler;
+        scaler.Configure(Immediate());
+        scaler.Reset(0.8f);
+
+        // Between the thresholds nothing moves, however long it lasts
+        for (double load : { 0.75, 0.8, 0.85, 0.92 })
+        {
+            for (int i = 0; i < 10; i++)
+            {
+                CHECK(!scaler.Update(load * BUDGET, BUDGET));
+            }
+        }
+        CHECK_NEAR(scaler.GetScale(), 0.8, TOLERANCE);
+
+        // No sample, no budget: nothing happens
+        CHECK(!scaler.Update(0.0, BUDGET));
+        CHECK(!scaler.Update(10.0 * BUDGET, 0.0));
+        CHECK_NEAR(scaler.GetScale(), 0.8, TOLERANCE);
+    }
+
+    void TestCooldown()
+    {
+        OutputScaler::Settings settings = Immediate();
+        settings.cooldownFrames = 3;
+        OutputScaler scaler;
+        scaler.Configure(settings);
+
+        // Held after configuring, then after every change
+        for (int i = 0; i < 3; i++)
+        {
+            CHECK(!scaler.Update(2.0 * BUDGET, BUDGET));
+        }
+        CHECK(scaler.Update(2.0 * BUDGET, BUDGET));
+        float scale = scaler.GetScale();
+        for (int i = 0; i < 3; i++)
+        {
+            CHECK(!scaler.Update(2.0 * BUDGET, BUDGET));
+        }
+        CHECK_NEAR(scaler.GetScale(), scale, TOLERANCE);
+        CHECK(scaler.Update(2.0 * BUDGET, BUDGET));
+        CHECK(scaler.GetScale() < scale);
+    }
+
+    void TestSmoothing()
+    {
+        OutputScaler::Settings settings = Immediate();
+        settings.smoothing = 0.1f;
+        OutputScaler scaler;
+        scaler.Configure(settings);
+
+        // The first sample seeds the average; one spike barely moves it
+        CHECK(!scaler.Update(0.8 * BUDGET, BUDGET));
+        CHECK(!scaler.Update(1.5 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetAverageCost(), 0.87 * BUDGET, TOLERANCE * BUDGET);
+        CHECK_NEAR(scaler.GetScale(), 1.0, TOLERANCE);
+    }
+
+    void TestLimits()
+    {
+        OutputScaler scaler;
+        scaler.Configure(Immediate());
+
+        // A source smaller than the recommended size caps the scale, rounded down
+        CHECK(scaler.SetSourceLimit(0.83f));
+        CHECK_NEAR(scaler.GetMaxScale(), 0.83, TOLERANCE);
+        CHECK_NEAR(scaler.GetScale(), 0.80, TOLERANCE);
+
+        // Growing stops at the limit itself
+        scaler.Update(0.1 * BUDGET, BUDGET);
+        CHECK(scaler.GetScale() <= 0.83f + TOLERANCE);
+
+        // The tighter of ceiling and source limit wins; lifting one leaves the other
+        CHECK(scaler.SetCeiling(0.7f));
+        CHECK_NEAR(scaler.GetScale(), 0.70, TOLERANCE);
+        CHECK(!scaler.SetCeiling(0.0f));
+        CHECK_NEAR(scaler.GetMaxScale(), 0.83, TOLERANCE);
+        CHECK(!scaler.SetSourceLimit(0.0f));
+        CHECK_NEAR(scaler.GetMaxScale(), 1.0, TOLERANCE);
+
+        // A source larger than the recommended size does not raise the maximum
+        CHECK(!scaler.SetSourceLimit(1.5f));
+        CHECK_NEAR(scaler.GetMaxScale(), 1.0, TOLERANCE);
+
+        // Limits never go below the minimum, and hold it there
+        CHECK(scaler.SetSourceLimit(0.2f));
+        CHECK_NEAR(scaler.GetScale(), 0.6, TOLERANCE);
+        CHECK(!scaler.Update(0.1 * BUDGET, BUDGET));
+        CHECK_NEAR(scaler.GetScale(), 0.6, TOLERANCE);
+    }
+
+    void TestScaleExtent()
+    {
+        // Rounded, kept even, within [1, allocated]
+        CHECK(OutputScaler::ScaleExtent(2000, 0.75f, 2000) == 1500);
+        CHECK(OutputScaler::ScaleExtent(2001, 1.0f, 2002) == 2000);
+        CHECK(OutputScaler::ScaleExtent(2000, 1.0f, 1800) == 1800);
+        CHECK(OutputScaler::ScaleExtent(1, 0.5f, 100) == 1);
+        CHECK(OutputScaler::ScaleExtent(100, 0.5f, 0) == 1);
+    }
+}
+
+int main()
+{
+    TestConfigure();
+    TestStepDown();
+    TestStepUp();
+    TestDeadBand();
+    TestCooldown();
+    TestSmoothing();
+    TestLimits();
+    TestScaleExtent();
+    return TestUtils::Result("OutputScalerTest");
+}
@@ -0,0 +1,151 @@
+// Performance level hints: stepping up after sustained load, down only after
+// much longer idle, the cooldown after every change, no flip-flop when the load
+// swings, and the ceilings the runtime's notifications impose
+
+#include "PerfLevels.hpp"
+#include "TestUtils.hpp"
+
+using namespace PerfLevels;
+
+namespace
+{
+    constexpr double HIGH = 0.95;
+    constexpr double MIDDLE = 0.75;
+    constexpr double LOW = 0.3;
+
+    // Short windows so the tests stay readable; the ratios match the defaults
+    Controller::Settings Quick()
+    {
+        Controller::Settings settings;
+        settings.raiseFrames = 3;
+        settings.lowerFrames = 10;
+        settings.cooldownFrames = 5;
+        return settings;
+    }
+
+    // Returns how many times the level changed
+    int Run(Controller& controller, double load, int frames)
+    {
+        int changes = 0;
+        for (int i = 0; i < frames; i++)
+        {
+            changes += controller.Update(load) ? 1 : 0;
+        }
+        return changes;
+    }
+
+    void TestConfigure()
+    {
+        Controller::Settings settings = Quick();
+        settings.maxLevel = Level::SustainedHigh;
+        Controller controller;
+
+        // The initial level is kept within the bounds
+        controller.Configure(settings, Level::Boost);
+        CHECK(controller.GetLevel() == Level::SustainedHigh);
+        controller.Configure(settings, Level::PowerSavings);
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+        CHECK(controller.GetNotification() == Notification::Normal);
+    }
+
+    void TestRaise()
+    {
+        Controller controller;
+        controller.Configure(Quick());
+
+        // Held for the cooldown after configuring, then one step up
+        CHECK(Run(controller, HIGH, 5) == 0);
+        CHECK(controller.Update(HIGH));
+        CHECK(controller.GetLevel() == Level::Boost);
+
+        // Nothing above the maximum
+        CHECK(Run(controller, HIGH, 50) == 0);
+        CHECK(controller.GetLevel() == Level::Boost);
+
+        // No sample is no load, not low load
+        CHECK(!controller.Update(0.0));
+        CHECK(!controller.Update(-1.0));
+    }
+
+    void TestLower()
+    {
+        Controller controller;
+        controller.Configure(Quick());
+        Run(controller, MIDDLE, 5);
+
+        // Low load must last lowerFrames, far longer than raising takes
+        CHECK(Run(controller, LOW, 9) == 0);
+        CHECK(controller.Update(LOW));
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+
+        // Nothing below the minimum
+        CHECK(Run(controller, LOW, 50) == 0);
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+    }
+
+    void TestNoFlipFlop()
+    {
+        Controller controller;
+        controller.Configure(Quick());
+        Run(controller, MIDDLE, 5);
+
+        // Load swinging across both thresholds every frame never settles either way
+        for (int i = 0; i < 200; i++)
+        {
+            CHECK(!controller.Update((i % 2) ? HIGH : LOW));
+        }
+        // Nor do bursts shorter than the windows
+        controller.Update(MIDDLE);
+        for (int i = 0; i < 20; i++)
+        {
+            CHECK(Run(controller, HIGH, 2) == 0);
+            CHECK(Run(controller, LOW, 9) == 0);
+        }
+        // Nor does anything between the thresholds
+        CHECK(Run(controller, MIDDLE, 500) == 0);
+        CHECK(controller.GetLevel() == Level::SustainedHigh);
+
+        // A drop is not undone straight away: high load waits out the cooldown
+        Run(controller, LOW, 10);
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+        CHECK(Run(controller, HIGH, 5) == 0);
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+        CHECK(controller.Update(HIGH));
+        CHECK(controller.GetLevel() == Level::SustainedHigh);
+    }
+
+    void TestNotify()
+    {
+        Controller controller;
+        controller.Configure(Quick(), Level::Boost);
+
+        // A warning caps at sustained high, and holds there however high the load
+        CHECK(controller.Notify(Notification::Warning));
+        CHECK(controller.GetLevel() == Level::SustainedHigh);
+        CHECK(Run(controller, HIGH, 50) == 0);
+        CHECK(controller.GetLevel() == Level::SustainedHigh);
+
+        // Impaired caps at sustained low
+        CHECK(controller.Notify(Notification::Impaired));
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+        CHECK(!controller.Notify(Notification::Warning));
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+
+        // Back to normal lifts the cap but does not raise by itself
+        CHECK(!controller.Notify(Notification::Normal));
+        CHECK(controller.GetLevel() == Level::SustainedLow);
+        CHECK(Run(controller, HIGH, 5) == 0);
+        CHECK(controller.Update(HIGH));
+        CHECK(controller.GetLevel() == Level::SustainedHigh);
+    }
+}
+
+int main()
+{
+    TestConfigure();
+    TestRaise();
+    TestLower();
+    TestNoFlipFlop();
+    TestNotify();
+    return TestUtils::Result("PerfLevelsTest");
+}
@@ -0,0 +1,159 @@
+// Refresh rate selection: the cost of a frame rate at a refresh rate, the
+// rate chosen for a given present interval, and the startup, hold and spacing
+// rules that keep the selector from switching on every hitch
+
+#include "RefreshRate.hpp"
+#include "TestUtils.hpp"
+
+#include <vector>
+
+using namespace RefreshRate;
+
+namespace
+{
+    constexpr double TOLERANCE = 1e-3;
+    const std::vector<float> RATES = { 72.0f, 80.0f, 90.0f, 120.0f };
+
+    // Presents at a fixed interval, keeping the clock across calls
+    struct Run
+    {
+        Selector& selector;
+        double clock = 0.0;
+        double requestedAt = -1.0;
+        int requests = 0;
+
+        // Returns the last rate requested, or 0 if none was
+        float For(double seconds, double interval, uint32_t presentsPerFrame, float currentRate)
+        {
+            float requested = 0.0f;
+            for (double end = clock + seconds; clock < end; clock += interval)
+            {
+                float rate = selector.Update(interval, presentsPerFrame, currentRate);
+                if (rate > 0.0f)
+                {
+                    requested = rate;
+                    requestedAt = clock;
+                    requests++;
+                }
+            }
+            return requested;
+        }
+    };
+
+    void TestScore()
+    {
+        // Every frame on screen for the same number of refreshes: only reprojection costs
+        CHECK_NEAR(Score(72.0f, 72.0f), 0.0, TOLERANCE);
+        CHECK_NEAR(Score(45.0f, 90.0f), REPROJECTION_WEIGHT * 0.5, TOLERANCE);
+        CHECK_NEAR(Score(60.0f, 120.0f), REPROJECTION_WEIGHT * 0.5, TOLERANCE);
+
+        // Uneven cadence: 45 fps at 120 Hz alternates 2 and 3 refreshes
+        CHECK_NEAR(Score(45.0f, 120.0f), JUDDER_WEIGHT / 3.0 + REPROJECTION_WEIGHT * 0.625, TOLERANCE);
+
+        // Faster than the display: judged by the dropped frames, nothing reprojected
+        CHECK_NEAR(Score(90.0f, 72.0f), JUDDER_WEIGHT * 0.25, TOLERANCE);
+
+        CHECK_NEAR(Score(0.0f, 90.0f), 0.0, TOLERANCE);
+        CHECK_NEAR(Score(45.0f, 0.0f), 0.0, TOLERANCE);
+    }
+
+    void TestSelectBest()
+    {
+        Selector selector;
+        selector.Configure(Selector::Settings(), RATES);
+
+        // The rate the content divides evenly, the least reprojected of those
+        CHECK(selector.SelectBest(45.0f) == 90.0f);
+        CHECK(selector.SelectBest(60.0f) == 120.0f);
+        CHECK(selector.SelectBest(72.0f) == 72.0f);
+        CHECK(selector.SelectBest(40.0f) == 80.0f);
+        CHECK(selector.SelectBest(36.0f) == 72.0f);
+
+        // Ties go to the higher rate
+        CHECK(selector.SelectBest(200.0f) == 90.0f);
+    }
+
+    void TestContentRate()
+    {
+        Selector selector;
+        selector.Configure(Selector::Settings(), RATES);
+        CHECK_NEAR(selector.GetContentRate(1), 0.0, TOLERANCE);
+
+        // Alternate eyes present twice per submitted frame
+        selector.Update(1.0 / 90.0, 2, 90.0f);
+        CHECK_NEAR(selector.GetContentRate(2), 45.0, TOLERANCE);
+        CHECK_NEAR(selector.GetContentRate(1), 90.0, TOLERANCE);
+        CHECK_NEAR(selector.GetContentRate(0), 90.0, TOLERANCE);
+    }
+
+    void TestSwitch()
+    {
+        Selector selector;
+        selector.Configure(Selector::Settings(), RATES);
+        Run run{selector};
+
+        // 45 fps on a 120 Hz display: nothing during startup, then 90 Hz once it
+        // has won for the hold time
+        CHECK(run.For(10.0, 1.0 / 90.0, 2, 120.0f) == 0.0f);
+        CHECK(run.For(5.0, 1.0 / 90.0, 2, 120.0f) == 90.0f);
+        CHECK(run.requests == 1);
+        CHECK(run.requestedAt > 12.9 && run.requestedAt < 13.1);
+
+        // Settled: nothing more while the content rate holds
+        CHECK(run.For(60.0, 1.0 / 90.0, 2, 90.0f) == 0.0f);
+        CHECK(run.requests == 1);
+    }
+
+    void TestSpacing()
+    {
+        Selector selector;
+        selector.Configure(Selector::Settings(), RATES);
+        Run run{selector};
+
+        CHECK(run.For(15.0, 1.0 / 90.0, 2, 120.0f) == 90.0f);
+        double first = run.requestedAt;
+
+        // The game moves to 60 fps straight away: 120 Hz wins again, but not
+        // before the minimum time between switches
+        CHECK(run.For(40.0, 1.0 / 120.0, 2, 90.0f) == 120.0f);
+        CHECK(run.requests == 2);
+        CHECK(run.requestedAt - first >= Selector::Settings().minSwitchSeconds);
+    }
+
+    void TestNoSwitch()
+    {
+        Selector selector;
+        selector.Configure(Selector::Settings(), RATES);
+        Run run{selector};
+
+        // Not better by enough: 200 fps scores the same at 72 Hz and 90 Hz
+        CHECK(run.For(60.0, 1.0 / 200.0, 1, 72.0f) == 0.0f);
+
+        // Loading hitches restart the hold and are not frame rate
+        selector.Configure(Selector::Settings(), RATES);
+        for (int i = 0; i < 20; i++)
+        {
+            CHECK(run.For(2.0, 1.0 / 90.0, 2, 120.0f) == 0.0f);
+            CHECK(selector.Update(1.0, 2, 120.0f) == 0.0f);
+        }
+        CHECK_NEAR(selector.GetContentRate(2), 45.0, TOLERANCE);
+
+        // Without a current rate or supported rates there is nothing to switch from or to
+        selector.Configure(Selector::Settings(), RATES);
+        CHECK(run.For(20.0, 1.0 / 90.0, 2, 0.0f) == 0.0f);
+        selector.Configure(Selector::Settings(), {});
+        CHECK(run.For(20.0, 1.0 / 90.0, 2, 120.0f) == 0.0f);
+        CHECK(run.requests == 0);
+    }
+}
+
+int main()
+{
+    TestScore();
+    TestSelectBest();
+    TestContentRate();
+    TestSwitch();
+    TestSpacing();
+    TestNoSwitch();
+    return TestUtils::Result("RefreshRateTest");
+}
@@ -0,0 +1,190 @@
+// ResourceStates::Tracker driven through Flush into a mock command list,
+// checking the barriers a recorded eye copy would get
+
+#include "ResourceStates.hpp"
+#include "TestUtils.hpp"
+
+#include <vector>
+
+using namespace ResourceStates;
+
+namespace
+{
+    // Stands in for ID3D12GraphicsCommandList::ResourceBarrier
+    struct MockCommandList
+    {
+        std::vector<Barrier> barriers;
+        uint32_t calls = 0;
+
+        void Record(Tracker& states)
+        {
+            states.Flush([this](const Barrier* batch, size_t count)
+            {
+                barriers.insert(barriers.end(), batch, batch + count);
+                calls++;
+            });
+        }
+    };
+
+    // Distinct addresses stand in for ID3D12Resource pointers
+    int g_source;
+    int g_dest;
+
+    bool IsBarrier(const std::vector<Barrier>& barriers, size_t index, const void* resource, uint32_t before,
+                   uint32_t after, Split split)
+    {
+        if (index >= barriers.size())
+        {
+            return false;
+        }
+        const Barrier& barrier = barriers[index];
+        return barrier.resource == resource && barrier.before == before && barrier.after == after &&
+               barrier.split == split;
+    }
+
+    void TestNoOp()
+    {
+        Tracker states;
+        states.Track(&g_dest, 0, State::RenderTarget);
+        CHECK(states.Transition(&g_dest, 0, State::RenderTarget));
+        states.Restore();
+
+        MockCommandList list;
+        list.Record(states);
+        CHECK(list.calls == 0);
+        CHECK(list.barriers.empty());
+        CHECK(states.GetEmittedCount() == 0);
+        CHECK(states.GetSkippedCount() == 1);
+
+        // Untracked resources are refused and record nothing
+        CHECK(!states.Transition(&g_source, 0, State::CopySource));
+        CHECK(!states.BeginRestore(&g_source, 0));
+    }
+
+    // The plain eye copy: a PRESENT back buffer read by the copy and a
+    // RENDER_TARGET swapchain image written by it
+    void TestCommonPromotionAndDecay()
+    {
+        Tracker states;
+        states.Track(&g_source, ALL_SUBRESOURCES, State::Present, true);
+        states.Track(&g_dest, 0, State::RenderTarget);
+
+        states.Transition(&g_source, ALL_SUBRESOURCES, State::CopySource);
+        states.Transition(&g_dest, 0, State::CopyDest);
+        CHECK(states.GetState(&g_source, ALL_SUBRESOURCES) == State::CopySource);
+
+        MockCommandList list;
+        list.Record(states);
+        CHECK(list.barriers.size() == 1);
+        CHECK(IsBarrier(list.barriers, 0, &g_dest, State::RenderTarget, State::CopyDest, Split::None));
+
+        // A second read state joins the promotion instead of needing a barrier
+        states.Transition(&g_source, ALL_SUBRESOURCES, State::PixelShaderResource);
+        CHECK(states.GetState(&g_source, ALL_SUBRESOURCES) == (State::CopySource | State::PixelShaderResource));
+
+        // The source decays back to COMMON by itself; only the image goes home
+        states.Restore();
+        list.Record(states);
+        CHECK(list.calls == 2);
+        CHECK(list.barriers.size() == 2);
+        CHECK(IsBarrier(list.barriers, 1, &g_dest, State::CopyDest, State::RenderTarget, Split::None));
+        CHECK(states.GetState(&g_source, ALL_SUBRESOURCES) == State::Common);
+        CHECK(states.GetEmittedCount() == 2);
+        CHECK(states.GetSkippedCount() == 3);
+
+        // A write is not promoted to from a promoted read state
+        states.Transition(&g_source, ALL_SUBRESOURCES, State::CopySource);
+        states.Transition(&g_source, ALL_SUBRESOURCES, State::RenderTarget);
+        states.Restore();
+        list.barriers.clear();
+        list.Record(states);
+        CHECK(list.barriers.size() == 2);
+        CHECK(IsBarrier(list.barriers, 0, &g_source, State::CopySource, State::RenderTarget, Split::None));
+        CHECK(IsBarrier(list.barriers, 1, &g_source, State::RenderTarget, State::Common, Split::None));
+    }
+
+    void TestSplitBeginEnd()
+    {
+        Tracker states;
+        states.Track(&g_dest, 0, State::RenderTarget);
+
+        CHECK(states.BeginTransition(&g_dest, 0, State::UnorderedAccess));
+        MockCommandList list;
+        list.Record(states);
+        CHECK(list.barriers.size() == 1);
+        CHECK(IsBarrier(list.barriers, 0, &g_dest, State::RenderTarget, State::UnorderedAccess, Split::Begin));
+
+        // The END half lands when the state is needed
+        states.Transition(&g_dest, 0, State::UnorderedAccess);
+        CHECK(states.GetState(&g_dest, 0) == State::UnorderedAccess);
+        list.Record(states);
+        CHECK(list.barriers.size() == 2);
+        CHECK(IsBarrier(list.barriers, 1, &g_dest, State::RenderTarget, State::UnorderedAccess, Split::End));
+
+        // A split towards a state promotion reaches needs no barrier at all
+        Tracker promoted;
+        promoted.Track(&g_source, ALL_SUBRESOURCES, State::Common, true);
+        promoted.BeginTransition(&g_source, ALL_SUBRESOURCES, State::NonPixelShaderResource);
+        MockCommandList quiet;
+        quiet.Record(promoted);
+        CHECK(quiet.barriers.empty());
+        CHECK(promoted.GetState(&g_source, ALL_SUBRESOURCES) == State::NonPixelShaderResource);
+    }
+
+    void TestRestore()
+    {
+        Tracker states;
+        states.Track(&g_dest, 0, State::RenderTarget);
+        states.Transition(&g_dest, 0, State::UnorderedAccess);
+
+        // BeginRestore splits the way home; Restore only closes it
+        CHECK(states.BeginRestore(&g_dest, 0));
+        states.Restore();
+        MockCommandList list;
+        list.Record(states);
+        CHECK(list.barriers.size() == 3);
+        CHECK(IsBarrier(list.barriers, 0, &g_dest, State::RenderTarget, State::UnorderedAccess, Split::None));
+        CHECK(IsBarrier(list.barriers, 1, &g_dest, State::UnorderedAccess, State::RenderTarget, Split::Begin));
+        CHECK(IsBarrier(list.barriers, 2, &g_dest, State::UnorderedAccess, State::RenderTarget, Split::End));
+        CHECK(states.GetState(&g_dest, 0) == State::RenderTarget);
+
+        // Restoring again has nothing left to do
+        states.Restore();
+        list.Record(states);
+        CHECK(list.barriers.size() == 3);
+    }
+
+    // A promoted read with a split still open towards a write: BeginRestore has
+    // to land the split before deciding the resource decays on its own
+    void TestBeginRestoreClosesSplit()
+    {
+        Tracker states;
+        states.Track(&g_source, ALL_SUBRESOURCES, State::Common, true);
+        states.Transition(&g_source, ALL_SUBRESOURCES, State::CopySource);
+        states.BeginTransition(&g_source, ALL_SUBRESOURCES, State::RenderTarget);
+        CHECK(states.BeginRestore(&g_source, ALL_SUBRESOURCES));
+
+        MockCommandList list;
+        list.Record(states);
+        CHECK(list.barriers.size() == 3);
+        CHECK(IsBarrier(list.barriers, 0, &g_source, State::CopySource, State::RenderTarget, Split::Begin));
+        CHECK(IsBarrier(list.barriers, 1, &g_source, State::CopySource, State::RenderTarget, Split::End));
+        CHECK(IsBarrier(list.barriers, 2, &g_source, State::RenderTarget, State::Common, Split::Begin));
+
+        states.Restore();
+        list.Record(states);
+        CHECK(list.barriers.size() == 4);
+        CHECK(IsBarrier(list.barriers, 3, &g_source, State::RenderTarget, State::Common, Split::End));
+        CHECK(states.GetState(&g_source, ALL_SUBRESOURCES) == State::Common);
+    }
+}
+
+int main()
+{
+    TestNoOp();
+    TestCommonPromotionAndDecay();
+    TestSplitBeginEnd();
+    TestRestore();
+    TestBeginRestoreClosesSplit();
+    return TestUtils::Result("ResourceStatesTest");
+}
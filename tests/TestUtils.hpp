@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal checks for the header tests: report every failure, fail the run at the end
+namespace TestUtils
+{
+    inline int g_failures = 0;
+
+    inline void Check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (!condition)
+        {
+            std::printf("%s:%d: check failed: %s\n", file, line, expression);
+            g_failures++;
+        }
+    }
+
+    inline void CheckNear(double actual, double expected, double tolerance, const char* expression,
+                          const char* file, int line)
+    {
+        if (std::fabs(actual - expected) > tolerance)
+        {
+            std::printf("%s:%d: %s is %.6f, expected %.6f\n", file, line, expression, actual, expected);
+            g_failures++;
+        }
+    }
+
+    inline int Result(const char* name)
+    {
+        if (g_failures == 0)
+        {
+            std::printf("%s: passed\n", name);
+            return 0;
+        }
+        std::printf("%s: %d check(s) failed\n", name, g_failures);
+        return 1;
+    }
+}
+
+#define CHECK(expression) TestUtils::Check((expression), #expression, __FILE__, __LINE__)
+#define CHECK_NEAR(actual, expected, tolerance) \
+    TestUtils::CheckNear((actual), (expected), (tolerance), #actual, __FILE__, __LINE__)
@@ -0,0 +1,184 @@
+// UI layer helpers: layer sizing, menu anchoring and the CPU reference of the
+// change hash kernel, including how the GPU's never-cleared counter is read
+
+#include "UiLayer.hpp"
+#include "TestUtils.hpp"
+
+#include <cmath>
+#include <initializer_list>
+#include <vector>
+
+using namespace UiLayer;
+
+namespace
+{
+    constexpr double TOLERANCE = 1e-5;
+
+    // RGBA texels, all with the same alpha
+    std::vector<float> MakeImage(std::initializer_list<float> grays, float alpha)
+    {
+        std::vector<float> texels;
+        for (float gray : grays)
+        {
+            texels.insert(texels.end(), { gray, gray, gray, alpha });
+        }
+        return texels;
+    }
+
+    bool SameHash(const uint32_t a[2], const uint32_t b[2])
+    {
+        return a[0] == b[0] && a[1] == b[1];
+    }
+
+    // Hamilton product a * b (x, y, z, w)
+    void Multiply(const float a[4], const float b[4], float out[4])
+    {
+        out[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+        out[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+        out[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+        out[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+    }
+
+    void TestLayerSize()
+    {
+        // 1000 px/rad across 1 rad, plenty of source
+        CHECK(ComputeLayerWidth(1000.0f, 1.0f, 4000) == 1000);
+
+        // Never more than the source has, nor MAX_WIDTH
+        CHECK(ComputeLayerWidth(1000.0f, 1.0f, 800) == 800);
+        CHECK(ComputeLayerWidth(10000.0f, 1.0f, 8000) == MAX_WIDTH);
+
+        // At least MIN_WIDTH when the source allows it, and always even
+        CHECK(ComputeLayerWidth(100.0f, 1.0f, 4000) == MIN_WIDTH);
+        CHECK(ComputeLayerWidth(1001.0f, 1.0f, 4000) == 1000);
+        CHECK(ComputeLayerWidth(0.0f, 1.0f, 100) == 100);
+
+        // 1000 wide at 16:9: 562.5 rounds to 563, kept even
+        CHECK(ComputeLayerHeight(1000, 1920, 1080) == 562);
+        CHECK(ComputeLayerHeight(1000, 1000, 500) == 500);
+        CHECK(ComputeLayerHeight(64, 0, 100) == 64);
+
+        CHECK_NEAR(QuadWidth(2.0f, DegreesToRadians(90.0f)), 4.0, TOLERANCE);
+    }
+
+    void TestYawOnly()
+    {
+        float out[4];
+        YawOnly(0.0f, 0.0f, 0.0f, 1.0f, out);
+        CHECK_NEAR(out[1], 0.0, TOLERANCE);
+        CHECK_NEAR(out[3], 1.0, TOLERANCE);
+
+        // Yaw 30 degrees then pitch 20 and roll 10: only the yaw is kept
+        const float half = DegreesToRadians(1.0f) * 0.5f;
+        const float yaw[4] = { 0.0f, std::sin(30.0f * half), 0.0f, std::cos(30.0f * half) };
+        const float pitch[4] = { std::sin(20.0f * half), 0.0f, 0.0f, std::cos(20.0f * half) };
+        const float roll[4] = { 0.0f, 0.0f, std::sin(10.0f * half), std::cos(10.0f * half) };
+        float yawPitch[4];
+        float head[4];
+        Multiply(yaw, pitch, yawPitch);
+        Multiply(yawPitch, roll, head);
+
+        YawOnly(head[0], head[1], head[2], head[3], out);
+        CHECK(out[0] == 0.0f && out[2] == 0.0f);
+        CHECK_NEAR(out[1], yaw[1], TOLERANCE);
+        CHECK_NEAR(out[3], yaw[3], TOLERANCE);
+    }
+
+    void TestPackTexel()
+    {
+        const float rgba[4] = { 1.0f, 0.0f, 0.5f, 1.0f };
+        CHECK(PackTexel(rgba) == 0xFF8000FFu);
+
+        // Out of range values are clamped like saturate()
+        const float outside[4] = { 2.0f, -1.0f, 0.0f, 0.0f };
+        CHECK(PackTexel(outside) == 0x000000FFu);
+
+        CHECK(Mix(0) == 0);
+        CHECK(Mix(1) != Mix(2));
+    }
+
+    void TestHashReference()
+    {
+        // The reference is the wrapping sum / xor of the per-texel hashes
+        std::vector<float> image = MakeImage({ 0.25f, 0.5f, 0.75f, 1.0f }, 1.0f);
+        uint32_t hash[2];
+        HashReference(image.data(), 2, 2, hash);
+
+        uint32_t sum = 0;
+        uint32_t bits = 0;
+        for (uint32_t y = 0; y < 2; y++)
+        {
+            for (uint32_t x = 0; x < 2; x++)
+            {
+                uint32_t texelSum, texelBits;
+                TexelHash(PackTexel(&image[(y * 2 + x) * 4]), x, y, 2, texelSum, texelBits);
+                sum += texelSum;
+                bits ^= texelBits;
+            }
+        }
+        CHECK(hash[0] == sum);
+        CHECK(hash[1] == bits);
+
+        // Same content, same hash
+        uint32_t again[2];
+        HashReference(image.data(), 2, 2, again);
+        CHECK(SameHash(hash, again));
+
+        // One byte of one texel changes it
+        std::vector<float> changed = image;
+        changed[3 * 4 + 3] = 254.0f / 255.0f;
+        uint32_t changedHash[2];
+        HashReference(changed.data(), 2, 2, changedHash);
+        CHECK(!SameHash(hash, changedHash));
+
+        // Texels are hashed with their position: moving content is a change
+        std::vector<float> swapped = MakeImage({ 0.5f, 0.25f, 0.75f, 1.0f }, 1.0f);
+        uint32_t swappedHash[2];
+        HashReference(swapped.data(), 2, 2, swappedHash);
+        CHECK(!SameHash(hash, swappedHash));
+
+        // A fully transparent image still hashes to something
+        std::vector<float> empty = MakeImage({ 0.0f, 0.0f, 0.0f, 0.0f }, 0.0f);
+        uint32_t emptyHash[2];
+        HashReference(empty.data(), 2, 2, emptyHash);
+        CHECK(!SameHash(hash, emptyHash));
+    }
+
+    // The kernel adds each pass into a counter that is never cleared; the
+    // hash of the latest pass comes back out of two consecutive reads
+    void TestHashDelta()
+    {
+        std::vector<float> first = MakeImage({ 0.1f, 0.2f, 0.3f }, 0.5f);
+        std::vector<float> second = MakeImage({ 0.1f, 0.2f, 0.4f }, 0.5f);
+        uint32_t firstHash[2];
+        uint32_t secondHash[2];
+        HashReference(first.data(), 3, 1, firstHash);
+        HashReference(second.data(), 3, 1, secondHash);
+
+        // Counter as left by earlier passes, then as read after each new one
+        uint32_t counter[2] = { 0xFFFFFFF0u, 0x12345678u };
+        uint32_t afterFirst[2] = { counter[0] + firstHash[0], counter[1] ^ firstHash[1] };
+        uint32_t afterSecond[2] = { afterFirst[0] + secondHash[0], afterFirst[1] ^ secondHash[1] };
+
+        uint32_t delta[2];
+        HashDelta(counter, afterFirst, delta);
+        CHECK(SameHash(delta, firstHash));
+        HashDelta(afterFirst, afterSecond, delta);
+        CHECK(SameHash(delta, secondHash));
+
+        // The same content read twice gives the same delta, wrap-around included
+        uint32_t afterRepeat[2] = { afterSecond[0] + secondHash[0], afterSecond[1] ^ secondHash[1] };
+        HashDelta(afterSecond, afterRepeat, delta);
+        CHECK(SameHash(delta, secondHash));
+    }
+}
+
+int main()
+{
+    TestLayerSize();
+    TestYawOnly();
+    TestPackTexel();
+    TestHashReference();
+    TestHashDelta();
+    return TestUtils::Result("UiLayerTest");
+}
@@ -0,0 +1,127 @@
+// Lens visibility mask: mapping the view plane to pixels, the triangle/box
+// overlap test, and the tiles and rectangles a known mask rasterizes to
+
+#include "VisibilityMask.hpp"
+#include "TestUtils.hpp"
+
+#include <vector>
+
+using namespace VisibilityMask;
+
+namespace
+{
+    constexpr double TOLERANCE = 1e-4;
+
+    bool SameRect(const Rect& rect, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1)
+    {
+        return rect.x0 == x0 && rect.y0 == y0 && rect.x1 == x1 && rect.y1 == y1;
+    }
+
+    // Diamond around the view axis reaching 3/4 of the way to each edge: four
+    // triangles fanned around the centre
+    const std::vector<float> DIAMOND_VERTICES = { 0.0f, 0.0f, 0.0f, 0.75f, 0.75f, 0.0f, 0.0f, -0.75f, -0.75f, 0.0f };
+    const std::vector<uint32_t> DIAMOND_INDICES = { 0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 1 };
+
+    void TestToPixels()
+    {
+        FovTangents fov;
+        float x = 0.0f, y = 0.0f;
+
+        // Top left, bottom right and centre of a symmetric view
+        ToPixels(-1.0f, 1.0f, fov, 200, 100, x, y);
+        CHECK_NEAR(x, 0.0, TOLERANCE);
+        CHECK_NEAR(y, 0.0, TOLERANCE);
+        ToPixels(1.0f, -1.0f, fov, 200, 100, x, y);
+        CHECK_NEAR(x, 200.0, TOLERANCE);
+        CHECK_NEAR(y, 100.0, TOLERANCE);
+        ToPixels(0.0f, 0.0f, fov, 200, 100, x, y);
+        CHECK_NEAR(x, 100.0, TOLERANCE);
+        CHECK_NEAR(y, 50.0, TOLERANCE);
+
+        // An asymmetric view puts the axis off centre
+        fov.left = -1.5f;
+        fov.right = 0.5f;
+        fov.up = 0.5f;
+        fov.down = -1.5f;
+        ToPixels(0.0f, 0.0f, fov, 200, 100, x, y);
+        CHECK_NEAR(x, 150.0, TOLERANCE);
+        CHECK_NEAR(y, 25.0, TOLERANCE);
+    }
+
+    void TestTriangleOverlapsBox()
+    {
+        const float tri[6] = { 0.0f, 0.0f, 10.0f, 0.0f, 0.0f, 10.0f };
+
+        CHECK(TriangleOverlapsBox(tri, 1.0f, 1.0f, 2.0f, 2.0f));         // Inside
+        CHECK(TriangleOverlapsBox(tri, -5.0f, -5.0f, 20.0f, 20.0f));     // Around
+        CHECK(TriangleOverlapsBox(tri, 4.0f, 4.0f, 8.0f, 8.0f));         // Across the long edge
+        CHECK(!TriangleOverlapsBox(tri, 11.0f, 0.0f, 12.0f, 1.0f));      // Outside the bounds
+        CHECK(!TriangleOverlapsBox(tri, 8.0f, 8.0f, 10.0f, 10.0f));      // Inside the bounds, past the long edge
+
+        // Touching counts: rasterization is conservative
+        CHECK(TriangleOverlapsBox(tri, 5.0f, 5.0f, 6.0f, 6.0f));
+        CHECK(TriangleOverlapsBox(tri, 10.0f, -1.0f, 11.0f, 0.0f));
+    }
+
+    void TestRasterize()
+    {
+        // 4 x 4 tiles of 32 pixels; the corner tiles are outside the diamond
+        TileMask mask;
+        mask.Rasterize(DIAMOND_VERTICES.data(), 5, DIAMOND_INDICES.data(), 12, FovTangents(), 128, 128, 32);
+        CHECK(mask.GetTilesX() == 4);
+        CHECK(mask.GetTilesY() == 4);
+        CHECK(!mask.IsTileVisible(0, 0));
+        CHECK(!mask.IsTileVisible(3, 0));
+        CHECK(!mask.IsTileVisible(0, 3));
+        CHECK(!mask.IsTileVisible(3, 3));
+        CHECK(mask.IsTileVisible(1, 0));
+        CHECK(mask.IsTileVisible(0, 1));
+        CHECK(mask.IsTileVisible(3, 2));
+        CHECK_NEAR(mask.GetVisibleFraction(), 0.75, TOLERANCE);
+
+        // The top and bottom rows narrow, the middle two merge into one
+        std::vector<Rect> rects = mask.GetVisibleRects();
+        CHECK(rects.size() == 3);
+        if (rects.size() == 3)
+        {
+            CHECK(SameRect(rects[0], 32, 0, 96, 32));
+            CHECK(SameRect(rects[1], 0, 32, 128, 96));
+            CHECK(SameRect(rects[2], 32, 96, 96, 128));
+        }
+    }
+
+    void TestEdgeCases()
+    {
+        TileMask mask;
+
+        // Before any mask, and with everything visible: one rectangle clipped to the image
+        CHECK_NEAR(mask.GetVisibleFraction(), 1.0, TOLERANCE);
+        mask.SetAllVisible(100, 70, 32);
+        CHECK(mask.GetTilesX() == 4);
+        CHECK(mask.GetTilesY() == 3);
+        std::vector<Rect> rects = mask.GetVisibleRects();
+        CHECK(rects.size() == 1);
+        CHECK(!rects.empty() && SameRect(rects[0], 0, 0, 100, 70));
+
+        // Out of range indices are skipped, not read
+        const uint32_t badIndices[] = { 0, 1, 9 };
+        mask.Rasterize(DIAMOND_VERTICES.data(), 5, badIndices, 3, FovTangents(), 128, 128, 32);
+        CHECK_NEAR(mask.GetVisibleFraction(), 0.0, TOLERANCE);
+        CHECK(mask.GetVisibleRects().empty());
+
+        // A zero tile size is taken as one pixel
+        mask.SetAllVisible(4, 2, 0);
+        CHECK(mask.GetTileSize() == 1);
+        CHECK(mask.GetTilesX() == 4);
+        CHECK(mask.GetTilesY() == 2);
+    }
+}
+
+int main()
+{
+    TestToPixels();
+    TestTriangleOverlapsBox();
+    TestRasterize();
+    TestEdgeCases();
+    return TestUtils::Result("VisibilityMaskTest");
+}